@@ -3791,7 +3791,8 @@ void ApiWrap::sendVoiceMessage(
 		QByteArray result,
 		VoiceWaveform waveform,
 		int duration,
-		const SendAction &action) {
+		const SendAction &action,
+		uint64 streamedFileId) {
 	const auto caption = TextWithTags();
 	const auto to = fileLoadTaskOptions(action);
 	_fileLoader->addTask(std::make_unique<FileLoadTask>(
@@ -3800,7 +3801,8 @@ void ApiWrap::sendVoiceMessage(
 		duration,
 		waveform,
 		to,
-		caption));
+		caption,
+		streamedFileId));
 }
 
 void ApiWrap::editMedia(
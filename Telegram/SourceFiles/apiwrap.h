@@ -295,7 +295,8 @@ public:
 		QByteArray result,
 		VoiceWaveform waveform,
 		int duration,
-		const SendAction &action);
+		const SendAction &action,
+		uint64 streamedFileId = 0);
 	void sendFiles(
 		Ui::PreparedList &&list,
 		SendMediaType type,
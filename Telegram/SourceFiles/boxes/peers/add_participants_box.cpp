@@ -1123,53 +1123,11 @@ void AddSpecialBoxSearchController::addChatsContacts() {
 	if (wordList.empty()) {
 		return;
 	}
-	const auto allWordsAreFound = [&](
-			const base::flat_set<QString> &nameWords) {
-		const auto hasNamePartStartingWith = [&](const QString &word) {
-			for (const auto &nameWord : nameWords) {
-				if (nameWord.startsWith(word)) {
-					return true;
-				}
-			}
-			return false;
-		};
-
-		for (const auto &word : wordList) {
-			if (!hasNamePartStartingWith(word)) {
-				return false;
-			}
-		}
-		return true;
-	};
-	const auto getSmallestIndex = [&](not_null<Dialogs::IndexedList*> list)
-	-> const Dialogs::List* {
-		if (list->empty()) {
-			return nullptr;
-		}
-
-		auto result = (const Dialogs::List*)nullptr;
-		for (const auto &word : wordList) {
-			const auto found = list->filtered(word[0]);
-			if (!found || found->empty()) {
-				return nullptr;
-			}
-			if (!result || result->size() > found->size()) {
-				result = found;
-			}
-		}
-		return result;
-	};
 	const auto filterAndAppend = [&](not_null<Dialogs::IndexedList*> list) {
-		const auto index = getSmallestIndex(list);
-		if (!index) {
-			return;
-		}
-		for (const auto &row : *index) {
+		for (const auto &row : list->filtered(wordList)) {
 			if (const auto history = row->history()) {
 				if (const auto user = history->peer->asUser()) {
-					if (allWordsAreFound(user->nameWords())) {
-						delegate()->peerListSearchAddRow(user);
-					}
+					delegate()->peerListSearchAddRow(user);
 				}
 			}
 		}
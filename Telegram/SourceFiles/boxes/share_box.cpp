@@ -940,9 +940,7 @@ ShareBox::Inner::Inner(QWidget *parent, const Descriptor &descriptor)
 
 	_descriptor.session->changes().realtimeNameUpdates(
 	) | rpl::start_with_next([=](const Data::NameUpdate &update) {
-		_chatsIndexed->peerNameChanged(
-			update.peer,
-			update.oldFirstLetters);
+		_chatsIndexed->peerNameChanged(update.peer);
 	}, lifetime());
 
 	_descriptor.session->downloaderTaskFinished(
@@ -1337,7 +1335,7 @@ void ShareBox::Inner::changeCheckState(Chat *chat) {
 		const auto history = chat->peer->owner().history(chat->peer);
 		auto row = _chatsIndexed->getRow(history);
 		if (!row) {
-			row = _chatsIndexed->addToEnd(history).main;
+			row = _chatsIndexed->addToEnd(history);
 		}
 		chat = getChat(row);
 		if (!chat->checkbox.checked()) {
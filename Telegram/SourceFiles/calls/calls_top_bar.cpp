@@ -251,7 +251,7 @@ TopBar::TopBar(
 		st::groupCallTopBarUserpics,
 		rpl::single(true),
 		[=] { updateUserpics(); },
-		::Kotato::JsonSettings::GetInt("userpic_corner_type")))
+		::Kotato::JsonSettings::GetInt(::Kotato::JsonSettings::Key::UserpicCornerType)))
 , _durationLabel(_call
 	? object_ptr<Ui::LabelSimple>(this, st::callBarLabel)
 	: object_ptr<Ui::LabelSimple>(nullptr))
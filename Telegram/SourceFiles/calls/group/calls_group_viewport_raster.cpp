@@ -12,6 +12,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "calls/group/calls_group_members_row.h"
 #include "data/data_peer.h"
 #include "media/view/media_view_pip.h"
+#include "media/streaming/media_streaming_yuv420.h"
 #include "webrtc/webrtc_video_track.h"
 #include "ui/image/image_prepare.h"
 #include "lang/lang_keys.h"
@@ -23,6 +24,58 @@ namespace {
 
 constexpr auto kBlurRadius = 15;
 
+[[nodiscard]] Media::Streaming::FrameYUV420 WrapYUV420(
+		const Webrtc::FrameYUV420 &data) {
+	auto result = Media::Streaming::FrameYUV420();
+	result.size = data.size;
+	result.chromaSize = data.chromaSize;
+	result.y = { data.y.data, data.y.stride };
+	result.u = { data.u.data, data.u.stride };
+	result.v = { data.v.data, data.v.stride };
+	return result;
+}
+
+struct CopiedYUV420 {
+	Media::Streaming::FrameYUV420 frame;
+	QByteArray y;
+	QByteArray u;
+	QByteArray v;
+};
+
+[[nodiscard]] CopiedYUV420 CopyYUV420(const Webrtc::FrameYUV420 &data) {
+	const auto copy = [](const auto &channel, int height) {
+		return QByteArray(
+			static_cast<const char*>(channel.data),
+			channel.stride * height);
+	};
+	auto result = CopiedYUV420();
+	result.y = copy(data.y, data.size.height());
+	result.u = copy(data.u, data.chromaSize.height());
+	result.v = copy(data.v, data.chromaSize.height());
+	result.frame.size = data.size;
+	result.frame.chromaSize = data.chromaSize;
+	result.frame.y = { result.y.constData(), data.y.stride };
+	result.frame.u = { result.u.constData(), data.u.stride };
+	result.frame.v = { result.v.constData(), data.v.stride };
+	return result;
+}
+
+[[nodiscard]] QImage PausedFrameImage(const Webrtc::FrameWithInfo &data) {
+	if (data.format != Webrtc::FrameFormat::YUV420) {
+		return data.original.scaled(
+			VideoTile::PausedVideoSize(),
+			Qt::KeepAspectRatio);
+	}
+	const auto size = data.yuv420->size.scaled(
+		VideoTile::PausedVideoSize(),
+		Qt::KeepAspectRatio);
+	return size.isEmpty()
+		? QImage()
+		: Media::Streaming::ConvertYUV420ToARGB32(
+			WrapYUV420(*data.yuv420),
+			size);
+}
+
 } // namespace
 
 Viewport::RendererSW::RendererSW(not_null<Viewport*> owner)
@@ -81,6 +134,57 @@ void Viewport::RendererSW::validateUserpicFrame(
 		kBlurRadius);
 }
 
+void Viewport::RendererSW::validateConvertedFrame(
+		not_null<VideoTile*> tile,
+		TileData &data,
+		const Webrtc::FrameWithInfo &frame,
+		int rotation,
+		QSize size) {
+	if (data.converting
+		|| size.isEmpty()
+		|| (data.frameIndex == frame.index
+			&& data.frameRotation == rotation
+			&& data.frame.size() == size)) {
+		return;
+	}
+	// The track reuses its buffers, so the planes are copied for the
+	// conversion that scales the frame right to the tile size.
+	const auto id = ++_conversionId;
+	data.conversionId = id;
+	data.frameIndex = frame.index;
+	data.frameRotation = rotation;
+	data.converting = true;
+	crl::async([
+		=,
+		weak = base::make_weak(this),
+		copied = CopyYUV420(*frame.yuv420),
+		storage = base::take(data.frameStorage)
+	]() mutable {
+		auto image = Media::Streaming::ConvertYUV420ToARGB32(
+			copied.frame,
+			size,
+			rotation,
+			std::move(storage));
+		crl::on_main(weak, [=, image = std::move(image)]() mutable {
+			applyConvertedFrame(tile, id, std::move(image));
+		});
+	});
+}
+
+void Viewport::RendererSW::applyConvertedFrame(
+		not_null<VideoTile*> tile,
+		uint64 conversionId,
+		QImage frame) {
+	const auto i = _tileData.find(tile);
+	if (i == end(_tileData) || i->second.conversionId != conversionId) {
+		return;
+	}
+	auto &data = i->second;
+	data.converting = false;
+	data.frameStorage = std::exchange(data.frame, std::move(frame));
+	_owner->widget()->update();
+}
+
 void Viewport::RendererSW::paintTile(
 		Painter &p,
 		not_null<VideoTile*> tile,
@@ -90,7 +194,7 @@ void Viewport::RendererSW::paintTile(
 	const auto markGuard = gsl::finally([&] {
 		tile->track()->markFrameShown();
 	});
-	const auto data = track->frameWithInfo(true);
+	const auto data = track->frameWithInfo(false);
 	auto &tileData = _tileData[tile];
 	tileData.stale = false;
 	_userpicFrame = (data.format == Webrtc::FrameFormat::None);
@@ -100,18 +204,24 @@ void Viewport::RendererSW::paintTile(
 		tileData.blurredFrame = QImage();
 	} else if (tileData.blurredFrame.isNull()) {
 		tileData.blurredFrame = Images::BlurLargeImage(
-			data.original.scaled(
-				VideoTile::PausedVideoSize(),
-				Qt::KeepAspectRatio),
+			PausedFrameImage(data),
 			kBlurRadius);
 	}
+	const auto convert = !_userpicFrame
+		&& !_pausedFrame
+		&& (data.format == Webrtc::FrameFormat::YUV420);
+	if (!convert) {
+		tileData.frame = tileData.frameStorage = QImage();
+		tileData.frameIndex = -1;
+	}
 	const auto &image = _userpicFrame
 		? tileData.userpicFrame
 		: _pausedFrame
 		? tileData.blurredFrame
 		: data.original;
 	const auto frameRotation = _userpicFrame ? 0 : data.rotation;
-	Assert(!image.isNull());
+	const auto frameSize = convert ? data.yuv420->size : image.size();
+	Assert(!frameSize.isEmpty());
 
 	const auto fill = [&](QRect rect) {
 		const auto intersected = rect.intersected(clip);
@@ -128,13 +238,25 @@ void Viewport::RendererSW::paintTile(
 	const auto width = geometry.width();
 	const auto height = geometry.height();
 	const auto scaled = FlipSizeByRotation(
-		image.size(),
+		frameSize,
 		frameRotation
 	).scaled(QSize(width, height), Qt::KeepAspectRatio);
 	const auto left = (width - scaled.width()) / 2;
 	const auto top = (height - scaled.height()) / 2;
 	const auto target = QRect(QPoint(x + left, y + top), scaled);
-	if (UsePainterRotation(frameRotation)) {
+	if (convert) {
+		validateConvertedFrame(
+			tile,
+			tileData,
+			data,
+			frameRotation,
+			scaled * cIntRetinaFactor());
+		if (tileData.frame.isNull()) {
+			fill(target);
+		} else {
+			p.drawImage(target, tileData.frame);
+		}
+	} else if (UsePainterRotation(frameRotation)) {
 		if (frameRotation) {
 			p.save();
 			p.rotate(frameRotation);
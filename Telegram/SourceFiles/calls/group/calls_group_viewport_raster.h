@@ -12,10 +12,17 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/effects/cross_line.h"
 #include "ui/gl/gl_surface.h"
 #include "ui/text/text.h"
+#include "base/weak_ptr.h"
+
+namespace Webrtc {
+struct FrameWithInfo;
+} // namespace Webrtc
 
 namespace Calls::Group {
 
-class Viewport::RendererSW final : public Ui::GL::Renderer {
+class Viewport::RendererSW final
+	: public Ui::GL::Renderer
+	, public base::has_weak_ptr {
 public:
 	explicit RendererSW(not_null<Viewport*> owner);
 
@@ -28,6 +35,12 @@ private:
 	struct TileData {
 		QImage userpicFrame;
 		QImage blurredFrame;
+		QImage frame;
+		QImage frameStorage;
+		uint64 conversionId = 0;
+		int frameIndex = -1;
+		int frameRotation = 0;
+		bool converting = false;
 		bool stale = false;
 	};
 	void paintTile(
@@ -52,12 +65,23 @@ private:
 	void validateUserpicFrame(
 		not_null<VideoTile*> tile,
 		TileData &data);
+	void validateConvertedFrame(
+		not_null<VideoTile*> tile,
+		TileData &data,
+		const Webrtc::FrameWithInfo &frame,
+		int rotation,
+		QSize size);
+	void applyConvertedFrame(
+		not_null<VideoTile*> tile,
+		uint64 conversionId,
+		QImage frame);
 
 	const not_null<Viewport*> _owner;
 
 	QImage _shadow;
 	bool _userpicFrame = false;
 	bool _pausedFrame = false;
+	uint64 _conversionId = 0;
 	base::flat_map<not_null<VideoTile*>, TileData> _tileData;
 	Ui::CrossLineAnimation _pinIcon;
 	Ui::RoundRect _pinBackground;
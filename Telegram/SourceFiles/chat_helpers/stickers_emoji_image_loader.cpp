@@ -34,7 +34,7 @@ QImage EmojiImageLoader::prepare(EmojiPtr emoji) const {
 	auto tinted = QImage(
 		QSize(st::largeEmojiSize, st::largeEmojiSize) * factor,
 		QImage::Format_ARGB32_Premultiplied);
-	tinted.fill(::Kotato::JsonSettings::GetBool("big_emoji_outline")
+	tinted.fill(::Kotato::JsonSettings::GetBool(::Kotato::JsonSettings::Key::BigEmojiOutline)
 		? Qt::white
 		: QColor(0, 0, 0, 0));
 	if (loaded) {
@@ -24,6 +24,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/sandbox.h"
 #include "core/local_url_handlers.h"
 #include "core/launcher.h"
+#include "core/startup_tasks.h"
 #include "core/ui_integration.h"
 #include "chat_helpers/emoji_keywords.h"
 #include "chat_helpers/stickers_emoji_image_loader.h"
@@ -215,17 +216,35 @@ Application::~Application() {
 }
 
 void Application::run() {
+	auto startup = StartupTasks();
+	const auto mimeDatabase = startup.async("mime_database", [] {
+		// Create mime database, so it won't be slow later.
+		QMimeDatabase().mimeTypeForName(qsl("text/plain"));
+	});
+
+	startup.phase("fonts");
 	style::internal::StartFonts();
 
+	startup.phase("third_party");
 	ThirdParty::start();
 
 	// Depends on OpenSSL on macOS, so on ThirdParty::start().
 	// Depends on notifications settings.
 	_notifications = std::make_unique<Window::Notifications::System>();
 
+	startup.phase("local_storage");
 	startLocalStorage();
-	Kotato::Lang::Load(Lang::GetInstance().baseId(), Lang::GetInstance().id());
 
+	const auto kotatoLang = std::make_shared<Kotato::Lang::LoadedValues>();
+	const auto kotatoLangParsed = startup.async("kotato_lang", [
+		kotatoLang,
+		baseId = Lang::GetInstance().baseId(),
+		id = Lang::GetInstance().id()
+	] {
+		*kotatoLang = Kotato::Lang::Parse(baseId, id);
+	});
+
+	startup.phase("settings");
 #if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
 	if (!::Kotato::JsonSettings::GetBool("qt_scale")) {
 #endif
@@ -254,14 +273,24 @@ void Application::run() {
 	_translator = std::make_unique<Lang::Translator>();
 	QCoreApplication::instance()->installTranslator(_translator.get());
 
+	startup.phase("style");
 	style::startManager(cScale());
 	Ui::InitTextOptions();
 	Ui::StartCachedCorners();
+
+	startup.phase("emoji");
 	Ui::Emoji::Init();
 	startEmojiImageLoader();
+
+	startup.phase("theme");
 	startSystemDarkModeViewer();
+
+	startup.phase("media_player");
 	Media::Player::start(_audio.get());
 
+	startup.phase("audio_devices");
+	Media::Audio::LogDevices();
+
 	style::ShortAnimationPlaying(
 	) | rpl::start_with_next([=](bool playing) {
 		if (playing) {
@@ -278,8 +307,10 @@ void Application::run() {
 
 	DEBUG_LOG(("Application Info: starting app..."));
 
-	// Create mime database, so it won't be slow later.
-	QMimeDatabase().mimeTypeForName(qsl("text/plain"));
+	startup.phase("window");
+	startup.wait(kotatoLangParsed);
+	Kotato::Lang::Apply(std::move(*kotatoLang));
+	startup.wait(mimeDatabase);
 
 	_primaryWindow = std::make_unique<Window::Controller>();
 	_lastActiveWindow = _primaryWindow.get();
@@ -303,9 +334,11 @@ void Application::run() {
 	DEBUG_LOG(("Application Info: window created..."));
 
 	// Depend on activeWindow() for now :(
+	startup.phase("domain");
 	startShortcuts();
 	startDomain();
 
+	startup.phase("show");
 	_primaryWindow->widget()->show();
 
 	const auto currentGeometry = _primaryWindow->widget()->geometry();
@@ -320,6 +353,7 @@ void Application::run() {
 	}
 
 	_primaryWindow->updateIsActiveFocus();
+	startup.finish();
 
 	for (const auto &error : Shortcuts::Errors()) {
 		LOG(("Shortcuts Error: %1").arg(error));
@@ -0,0 +1,112 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "core/startup_tasks.h"
+
+#include <crl/crl_semaphore.h>
+
+namespace Core {
+
+struct StartupTasks::Task {
+	const char *name = nullptr;
+	bool async = false;
+	bool joined = false;
+	crl::time started = 0;
+	crl::time finished = 0;
+	crl::time waited = 0;
+	crl::semaphore done;
+};
+
+StartupTasks::StartupTasks()
+: _started(crl::now()) {
+}
+
+StartupTasks::~StartupTasks() {
+	finish();
+}
+
+void StartupTasks::phase(const char *name) {
+	Expects(!_finished);
+
+	finishPhase();
+
+	_tasks.push_back(std::make_unique<Task>());
+	_phase = _tasks.back().get();
+	_phase->name = name;
+	_phase->started = crl::now();
+}
+
+StartupTasks::TaskId StartupTasks::async(
+		const char *name,
+		FnMut<void()> method) {
+	Expects(!_finished);
+
+	_tasks.push_back(std::make_unique<Task>());
+	const auto task = _tasks.back().get();
+	task->name = name;
+	task->async = true;
+
+	// The task is owned by _tasks and waited for in finish().
+	crl::async([task, method = std::move(method)]() mutable {
+		task->started = crl::now();
+		method();
+		task->finished = crl::now();
+		task->done.release();
+	});
+	return int(_tasks.size()) - 1;
+}
+
+void StartupTasks::wait(TaskId id) {
+	Expects(id >= 0 && id < int(_tasks.size()));
+
+	const auto task = _tasks[id].get();
+	Assert(task->async);
+	if (task->joined) {
+		return;
+	}
+	const auto waitStarted = crl::now();
+	task->done.acquire();
+	task->joined = true;
+
+	const auto waited = crl::now() - waitStarted;
+	task->waited = waited;
+	if (_phase) {
+		_phase->waited += waited;
+	}
+}
+
+void StartupTasks::finishPhase() {
+	if (_phase) {
+		_phase->finished = crl::now();
+		_phase = nullptr;
+	}
+}
+
+void StartupTasks::finish() {
+	if (_finished) {
+		return;
+	}
+	finishPhase();
+	for (auto i = 0; i != int(_tasks.size()); ++i) {
+		if (_tasks[i]->async) {
+			wait(i);
+		}
+	}
+	_finished = true;
+
+	for (const auto &task : _tasks) {
+		LOG(("Startup: %1%2 took %3 ms, started at %4 ms, waited %5 ms."
+			).arg(task->name
+			).arg(task->async ? " (async)" : ""
+			).arg(task->finished - task->started
+			).arg(task->started - _started
+			).arg(task->waited));
+	}
+	LOG(("Startup: finished in %1 ms.").arg(crl::now() - _started));
+}
+
+} // namespace Core
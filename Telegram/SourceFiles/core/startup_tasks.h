@@ -0,0 +1,45 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Core {
+
+// Splits application startup into traced phases.
+//
+// Main thread phases follow each other, every phase() call finishes the
+// previous one. Independent work is started with async() on crl workers
+// and joined with wait() by the first phase that needs its result.
+// finish() writes the per-phase timings to the log.
+class StartupTasks final {
+public:
+	using TaskId = int;
+
+	StartupTasks();
+	StartupTasks(const StartupTasks &other) = delete;
+	StartupTasks &operator=(const StartupTasks &other) = delete;
+	~StartupTasks();
+
+	void phase(const char *name);
+	TaskId async(const char *name, FnMut<void()> method);
+	void wait(TaskId id);
+
+	void finish();
+
+private:
+	struct Task;
+
+	void finishPhase();
+
+	std::vector<std::unique_ptr<Task>> _tasks;
+	Task *_phase = nullptr;
+	crl::time _started = 0;
+	bool _finished = false;
+
+};
+
+} // namespace Core
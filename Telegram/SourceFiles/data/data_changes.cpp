@@ -90,10 +90,8 @@ Main::Session &Changes::session() const {
 	return *_session;
 }
 
-void Changes::nameUpdated(
-		not_null<PeerData*> peer,
-		base::flat_set<QChar> oldFirstLetters) {
-	_nameStream.fire({ peer, std::move(oldFirstLetters) });
+void Changes::nameUpdated(not_null<PeerData*> peer) {
+	_nameStream.fire({ peer });
 }
 
 rpl::producer<NameUpdate> Changes::realtimeNameUpdates() const {
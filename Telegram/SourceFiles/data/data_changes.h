@@ -38,15 +38,7 @@ inline constexpr int CountBit(Flag Last = Flag::LastUsedBit) {
 } // namespace details
 
 struct NameUpdate {
-	NameUpdate(
-		not_null<PeerData*> peer,
-		base::flat_set<QChar> oldFirstLetters)
-	: peer(peer)
-	, oldFirstLetters(std::move(oldFirstLetters)) {
-	}
-
 	not_null<PeerData*> peer;
-	base::flat_set<QChar> oldFirstLetters;
 };
 
 struct PeerUpdate {
@@ -185,9 +177,7 @@ public:
 
 	[[nodiscard]] Main::Session &session() const;
 
-	void nameUpdated(
-		not_null<PeerData*> peer,
-		base::flat_set<QChar> oldFirstLetters);
+	void nameUpdated(not_null<PeerData*> peer);
 	[[nodiscard]] rpl::producer<NameUpdate> realtimeNameUpdates() const;
 	[[nodiscard]] rpl::producer<NameUpdate> realtimeNameUpdates(
 		not_null<PeerData*> peer) const;
@@ -88,7 +88,6 @@ FolderId Folder::id() const {
 void Folder::indexNameParts() {
 	// We don't want archive to be filtered in the chats list.
 	//_nameWords.clear();
-	//_nameFirstLetters.clear();
 	//auto toIndexList = QStringList();
 	//auto appendToIndex = [&](const QString &value) {
 	//	if (!value.isEmpty()) {
@@ -108,7 +107,6 @@ void Folder::indexNameParts() {
 	//const auto namesList = TextUtilities::PrepareSearchWords(toIndex);
 	//for (const auto &name : namesList) {
 	//	_nameWords.insert(name);
-	//	_nameFirstLetters.insert(name[0]);
 	//}
 }
 
@@ -381,10 +379,6 @@ const base::flat_set<QString> &Folder::chatListNameWords() const {
 	return _nameWords;
 }
 
-const base::flat_set<QChar> &Folder::chatListFirstLetters() const {
-	return _nameFirstLetters;
-}
-
 const QString &Folder::chatListNameSortKey() const {
 	return _chatListNameSortKey;
 }
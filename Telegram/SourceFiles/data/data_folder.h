@@ -55,7 +55,6 @@ public:
 	const QString &chatListName() const override;
 	const QString &chatListNameSortKey() const override;
 	const base::flat_set<QString> &chatListNameWords() const override;
-	const base::flat_set<QChar> &chatListFirstLetters() const override;
 
 	void loadUserpic() override;
 	void paintUserpic(
@@ -97,7 +96,6 @@ private:
 
 	QString _name;
 	base::flat_set<QString> _nameWords;
-	base::flat_set<QChar> _nameFirstLetters;
 	QString _chatListNameSortKey;
 
 	std::vector<not_null<History*>> _lastHistories;
@@ -0,0 +1,103 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "data/data_messages_cache.h"
+
+#include "data/data_session.h"
+#include "main/main_session.h"
+#include "storage/storage_account.h"
+#include "storage/cache/storage_cache_database.h"
+#include "core/application.h"
+
+namespace Data {
+namespace {
+
+constexpr auto kMaxSerializedSlice = 1024 * 1024;
+
+[[nodiscard]] Storage::Cache::Key CacheKey(PeerId peerId) {
+	return { peerId.value, 0 };
+}
+
+[[nodiscard]] QByteArray Serialize(const MTPmessages_Messages &slice) {
+	auto buffer = mtpBuffer();
+	buffer.reserve(slice.innerLength() / sizeof(mtpPrime));
+	slice.write(buffer);
+	return QByteArray(
+		reinterpret_cast<const char*>(buffer.data()),
+		buffer.size() * sizeof(mtpPrime));
+}
+
+[[nodiscard]] std::optional<MTPmessages_Messages> Deserialize(
+		const QByteArray &serialized) {
+	if (serialized.isEmpty() || (serialized.size() % sizeof(mtpPrime))) {
+		return std::nullopt;
+	}
+	auto from = reinterpret_cast<const mtpPrime*>(serialized.constData());
+	const auto end = from + (serialized.size() / sizeof(mtpPrime));
+	auto result = MTPmessages_Messages();
+	if (!result.read(from, end) || from != end) {
+		return std::nullopt;
+	}
+	return result;
+}
+
+} // namespace
+
+MessagesCache::MessagesCache(not_null<Session*> owner)
+: _owner(owner)
+, _database(Core::App().databases().get(
+	owner->session().local().messagesCachePath(),
+	owner->session().local().messagesCacheSettings())) {
+	_database->open(owner->session().local().messagesCacheKey());
+}
+
+MessagesCache::~MessagesCache() = default;
+
+void MessagesCache::put(PeerId peerId, const MTPmessages_Messages &slice) {
+	const auto skip = slice.match([](
+			const MTPDmessages_messagesNotModified &) {
+		return true;
+	}, [](const auto &data) {
+		return data.vmessages().v.isEmpty();
+	});
+	if (skip) {
+		remove(peerId);
+		return;
+	}
+	auto serialized = Serialize(slice);
+	if (serialized.size() > kMaxSerializedSlice) {
+		remove(peerId);
+		return;
+	}
+	_database->put(CacheKey(peerId), std::move(serialized));
+}
+
+void MessagesCache::get(
+		PeerId peerId,
+		Fn<void(const MTPmessages_Messages &slice)> done) {
+	_database->get(CacheKey(peerId), [=, weak = base::make_weak(this)](
+			QByteArray &&value) {
+		auto slice = Deserialize(value);
+		if (!slice) {
+			return;
+		}
+		crl::on_main(weak, [=, slice = std::move(*slice)] {
+			done(slice);
+		});
+	});
+}
+
+void MessagesCache::remove(PeerId peerId) {
+	_database->remove(CacheKey(peerId));
+}
+
+void MessagesCache::clear() {
+	_database->close();
+	_database->clear();
+}
+
+} // namespace Data
@@ -0,0 +1,39 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "storage/storage_databases.h"
+#include "base/weak_ptr.h"
+
+namespace Data {
+
+class Session;
+
+// Keeps the last received newest slice of each chat in an encrypted
+// on-disk database, so that a chat can be shown right after the launch
+// while the same slice is being requested from the server.
+class MessagesCache final : public base::has_weak_ptr {
+public:
+	explicit MessagesCache(not_null<Session*> owner);
+	~MessagesCache();
+
+	void put(PeerId peerId, const MTPmessages_Messages &slice);
+	void get(
+		PeerId peerId,
+		Fn<void(const MTPmessages_Messages &slice)> done);
+	void remove(PeerId peerId);
+
+	void clear();
+
+private:
+	const not_null<Session*> _owner;
+	Storage::DatabasePointer _database;
+
+};
+
+} // namespace Data
@@ -0,0 +1,206 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "data/data_messages_search_index.h"
+
+#include "history/history.h"
+#include "history/history_item.h"
+#include "ui/text/text_entity.h"
+
+namespace Data {
+namespace {
+
+// A short prefix can match lots of words, the local results are only
+// shown before the server ones, so they're collected from the first
+// words of the prefix range until this many items are found.
+constexpr auto kCollectItemsLimit = 16 * 1024;
+
+} // namespace
+
+void MessagesSearchIndex::update(
+		not_null<HistoryItem*> item,
+		const QString &text) {
+	auto words = TextUtilities::PrepareSearchWords(text);
+	words.removeDuplicates();
+
+	const auto i = _words.find(item);
+	if (i != end(_words)) {
+		if (i->second == words) {
+			return;
+		}
+		remove(item);
+	}
+	if (words.isEmpty()) {
+		return;
+	}
+	for (const auto &word : words) {
+		auto &postings = _byWord[word];
+		if (!postings.items.empty() && item < postings.items.back()) {
+			postings.sorted = false;
+		}
+		postings.items.push_back(item);
+	}
+	_words.emplace(item, std::move(words));
+}
+
+void MessagesSearchIndex::remove(not_null<HistoryItem*> item) {
+	const auto i = _words.find(item);
+	if (i == end(_words)) {
+		return;
+	}
+	const auto words = std::move(i->second);
+	_words.erase(i);
+	for (const auto &word : words) {
+		const auto j = _byWord.find(word);
+		if (j == end(_byWord)) {
+			continue;
+		}
+		auto &postings = j->second;
+		if (++postings.removed * 2 < int(postings.items.size())) {
+			continue;
+		}
+		compact(word, postings);
+		if (postings.items.empty()) {
+			_byWord.erase(j);
+		}
+	}
+}
+
+void MessagesSearchIndex::compact(
+		const QString &word,
+		Postings &postings) const {
+	auto &items = postings.items;
+	if (!postings.sorted) {
+		ranges::sort(items);
+		postings.sorted = true;
+	}
+	if (!postings.removed) {
+		return;
+	}
+	postings.removed = 0;
+
+	// A removed item could be added back or its address could be reused
+	// by another item, so keep only the ones that still have this word.
+	items.erase(ranges::unique(items), end(items));
+	items.erase(ranges::remove_if(items, [&](not_null<HistoryItem*> item) {
+		const auto i = _words.find(item);
+		return (i == end(_words)) || !i->second.contains(word);
+	}), end(items));
+}
+
+auto MessagesSearchIndex::collect(const QString &prefix) const -> Items {
+	auto lists = std::vector<not_null<const Items*>>();
+	auto collected = 0;
+	for (auto i = _byWord.lower_bound(prefix); i != end(_byWord);) {
+		if (!i->first.startsWith(prefix)
+			|| collected >= kCollectItemsLimit) {
+			break;
+		}
+		auto &postings = i->second;
+		compact(i->first, postings);
+		if (postings.items.empty()) {
+			i = _byWord.erase(i);
+			continue;
+		}
+		lists.push_back(&postings.items);
+		collected += int(postings.items.size());
+		++i;
+	}
+	if (lists.empty()) {
+		return {};
+	} else if (lists.size() == 1) {
+		return *lists.front();
+	}
+
+	// The lists are sorted, so they're merged through a heap of cursors.
+	using Cursor = std::pair<Items::const_iterator, Items::const_iterator>;
+	const auto later = [](const Cursor &a, const Cursor &b) {
+		return (*b.first < *a.first);
+	};
+	auto cursors = std::vector<Cursor>();
+	cursors.reserve(lists.size());
+	for (const auto list : lists) {
+		cursors.emplace_back(begin(*list), end(*list));
+	}
+	std::make_heap(begin(cursors), end(cursors), later);
+
+	auto result = Items();
+	result.reserve(collected);
+	while (!cursors.empty()) {
+		std::pop_heap(begin(cursors), end(cursors), later);
+		auto &cursor = cursors.back();
+		const auto item = *cursor.first;
+		if (result.empty() || result.back() != item) {
+			result.push_back(item);
+		}
+		if (++cursor.first == cursor.second) {
+			cursors.pop_back();
+		} else {
+			std::push_heap(begin(cursors), end(cursors), later);
+		}
+	}
+	return result;
+}
+
+std::vector<not_null<HistoryItem*>> MessagesSearchIndex::search(
+		const QString &query,
+		History *inHistory,
+		History *inMigrated,
+		PeerData *from,
+		int limit) const {
+	const auto words = TextUtilities::PrepareSearchWords(query);
+	if (words.isEmpty() || limit <= 0) {
+		return {};
+	}
+
+	// All the lists are sorted, so they're intersected in linear time.
+	auto found = collect(words.front());
+	for (auto i = words.begin() + 1; i != words.end(); ++i) {
+		if (found.empty()) {
+			break;
+		}
+		const auto matching = collect(*i);
+		auto both = Items();
+		std::set_intersection(
+			begin(found),
+			end(found),
+			begin(matching),
+			end(matching),
+			std::back_inserter(both));
+		found = std::move(both);
+	}
+
+	auto result = std::vector<not_null<HistoryItem*>>();
+	result.reserve(found.size());
+	for (const auto item : found) {
+		if (!item->isRegular()) {
+			continue;
+		} else if (inHistory
+			&& item->history() != inHistory
+			&& item->history() != inMigrated) {
+			continue;
+		} else if (from && item->from() != from) {
+			continue;
+		}
+		result.push_back(item);
+	}
+	const auto newer = [](
+			not_null<HistoryItem*> a,
+			not_null<HistoryItem*> b) {
+		return (a->date() > b->date())
+			|| (a->date() == b->date() && a->id > b->id);
+	};
+	if (result.size() > limit) {
+		ranges::partial_sort(result, result.begin() + limit, newer);
+		result.erase(result.begin() + limit, result.end());
+	} else {
+		ranges::sort(result, newer);
+	}
+	return result;
+}
+
+} // namespace Data
@@ -0,0 +1,52 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+class History;
+class HistoryItem;
+class PeerData;
+
+namespace Data {
+
+// Inverted index of the words of the messages loaded in memory, so that
+// the dialogs search can show local results without waiting for the server.
+// It is not persisted, so only the server finds messages of the chats that
+// were not opened yet or were unloaded since.
+class MessagesSearchIndex final {
+public:
+	void update(not_null<HistoryItem*> item, const QString &text);
+	void remove(not_null<HistoryItem*> item);
+
+	// Newest first, every query word must be a prefix of some item word.
+	[[nodiscard]] std::vector<not_null<HistoryItem*>> search(
+		const QString &query,
+		History *inHistory,
+		History *inMigrated,
+		PeerData *from,
+		int limit) const;
+
+private:
+	using Items = std::vector<not_null<HistoryItem*>>;
+
+	// Items are appended unsorted and removed lazily,
+	// the list is sorted and cleaned up before it is searched.
+	struct Postings {
+		Items items;
+		int removed = 0;
+		bool sorted = true;
+	};
+
+	void compact(const QString &word, Postings &postings) const;
+	[[nodiscard]] Items collect(const QString &prefix) const;
+
+	mutable std::map<QString, Postings> _byWord;
+	std::unordered_map<HistoryItem*, QStringList> _words;
+
+};
+
+} // namespace Data
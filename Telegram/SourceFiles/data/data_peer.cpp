@@ -230,10 +230,8 @@ void PeerData::updateNameDelayed(
 	_userpicEmpty = nullptr;
 
 	auto flags = UpdateFlag::None | UpdateFlag::None;
-	auto oldFirstLetters = base::flat_set<QChar>();
 	const auto nameUpdated = (nameVersion++ > 1);
 	if (nameUpdated) {
-		oldFirstLetters = nameFirstLetters();
 		flags |= UpdateFlag::Name;
 	}
 	if (isUser()) {
@@ -255,7 +253,7 @@ void PeerData::updateNameDelayed(
 	}
 	fillNames();
 	if (nameUpdated) {
-		session().changes().nameUpdated(this, std::move(oldFirstLetters));
+		session().changes().nameUpdated(this);
 	}
 	if (flags) {
 		session().changes().peerUpdated(this, flags);
@@ -58,6 +58,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_cloud_themes.h"
 #include "data/data_streaming.h"
 #include "data/data_media_rotation.h"
+#include "data/data_messages_cache.h"
+#include "data/data_messages_search_index.h"
 #include "data/data_histories.h"
 #include "base/platform/base_platform_info.h"
 #include "base/unixtime.h"
@@ -239,6 +241,8 @@ Session::Session(not_null<Main::Session*> session)
 , _sendActionManager(std::make_unique<SendActionManager>())
 , _streaming(std::make_unique<Streaming>(this))
 , _mediaRotation(std::make_unique<MediaRotation>())
+, _messagesCache(std::make_unique<MessagesCache>(this))
+, _messagesSearchIndex(std::make_unique<MessagesSearchIndex>())
 , _histories(std::make_unique<Histories>(this))
 , _stickers(std::make_unique<Stickers>(this))
 , _sponsoredMessages(std::make_unique<SponsoredMessages>(this))
@@ -968,6 +972,7 @@ History *Session::historyLoaded(const PeerData *peer) {
 }
 
 void Session::deleteConversationLocally(not_null<PeerData*> peer) {
+	_messagesCache->remove(peer->id);
 	const auto history = historyLoaded(peer);
 	if (history) {
 		if (history->folderKnown()) {
@@ -1153,9 +1158,8 @@ void Session::setupPeerNameViewer() {
 		if (const auto history = historyLoaded(peer)) {
 			history->refreshChatListNameSortKey();
 		}
-		const auto &oldLetters = update.oldFirstLetters;
-		_contactsNoChatsList.peerNameChanged(peer, oldLetters);
-		_contactsList.peerNameChanged(peer, oldLetters);
+		_contactsNoChatsList.peerNameChanged(peer);
+		_contactsList.peerNameChanged(peer);
 
 	}, _lifetime);
 }
@@ -2077,6 +2081,7 @@ void Session::unregisterMessage(not_null<HistoryItem*> item) {
 	const auto peerId = item->history()->peer->id;
 	const auto itemId = item->id;
 	_shownSpoilers.remove(item);
+	_messagesSearchIndex->remove(item);
 	_itemRemoved.fire_copy(item);
 	session().changes().messageUpdated(
 		item,
@@ -4208,6 +4213,7 @@ void Session::clearLocalStorage() {
 	_cache->clear();
 	_bigFileCache->close();
 	_bigFileCache->clear();
+	_messagesCache->clear();
 }
 
 } // namespace Data
@@ -57,6 +57,8 @@ class ChatFilters;
 class CloudThemes;
 class Streaming;
 class MediaRotation;
+class MessagesCache;
+class MessagesSearchIndex;
 class Histories;
 class DocumentMedia;
 class PhotoMedia;
@@ -105,6 +107,12 @@ public:
 	[[nodiscard]] MediaRotation &mediaRotation() const {
 		return *_mediaRotation;
 	}
+	[[nodiscard]] MessagesCache &messagesCache() const {
+		return *_messagesCache;
+	}
+	[[nodiscard]] MessagesSearchIndex &messagesSearchIndex() const {
+		return *_messagesSearchIndex;
+	}
 	[[nodiscard]] Histories &histories() const {
 		return *_histories;
 	}
@@ -980,6 +988,8 @@ private:
 	const std::unique_ptr<SendActionManager> _sendActionManager;
 	const std::unique_ptr<Streaming> _streaming;
 	const std::unique_ptr<MediaRotation> _mediaRotation;
+	const std::unique_ptr<MessagesCache> _messagesCache;
+	const std::unique_ptr<MessagesSearchIndex> _messagesSearchIndex;
 	const std::unique_ptr<Histories> _histories;
 	const std::unique_ptr<Stickers> _stickers;
 	std::unique_ptr<SponsoredMessages> _sponsoredMessages;
@@ -32,6 +32,16 @@ namespace {
 
 using SetFlag = StickersSetFlag;
 
+constexpr auto kEmojiSortSlice = 65536;
+
+[[nodiscard]] bool IsAnimatedSticker(not_null<DocumentData*> document) {
+	return document->sticker() && document->sticker()->isAnimated();
+}
+
+[[nodiscard]] int SeededSortBase(not_null<DocumentData*> document, int base) {
+	return IsAnimatedSticker(document) ? (base + kEmojiSortSlice) : base;
+}
+
 void RemoveFromSet(
 		StickersSets &sets,
 		not_null<DocumentData*> document,
@@ -79,6 +89,7 @@ Main::Session &Stickers::session() const {
 }
 
 void Stickers::notifyUpdated() {
+	invalidateEmojiIndex();
 	_updated.fire({});
 }
 
@@ -87,6 +98,9 @@ rpl::producer<> Stickers::updated() const {
 }
 
 void Stickers::notifyRecentUpdated(Recent recent) {
+	if (recent == Recent::Regular) {
+		invalidateEmojiIndex();
+	}
 	_recentUpdated.fire(std::move(recent));
 }
 
@@ -969,163 +983,168 @@ void Stickers::gifsReceived(const QVector<MTPDocument> &items, uint64 hash) {
 	notifySavedGifsUpdated();
 }
 
-std::vector<not_null<DocumentData*>> Stickers::getListByEmoji(
-		not_null<EmojiPtr> emoji,
-		uint64 seed) {
-	const auto original = emoji->original();
-
-	struct StickerWithDate {
-		not_null<DocumentData*> document;
-		TimeId date = 0;
-	};
-	auto result = std::vector<StickerWithDate>();
-	auto &sets = setsRef();
-	auto setsToRequest = base::flat_map<uint64, uint64>();
-
-	const auto add = [&](not_null<DocumentData*> document, TimeId date) {
-		if (ranges::find(result, document, [](const StickerWithDate &data) {
-			return data.document;
-		}) == result.end()) {
-			result.push_back({ document, date });
-		}
-	};
+void Stickers::invalidateEmojiIndex() {
+	_emojiIndex = std::nullopt;
+}
 
-	constexpr auto kSlice = 65536;
-	const auto CreateSortKey = [&](
-			not_null<DocumentData*> document,
-			int base) {
-		if (document->sticker() && document->sticker()->isAnimated()) {
-			base += kSlice;
-		}
-		return TimeId(base + int((document->id ^ seed) % kSlice));
-	};
-	const auto CreateRecentSortKey = [&](not_null<DocumentData*> document) {
-		return CreateSortKey(document, kSlice * 6);
-	};
-	auto myCounter = 0;
-	const auto CreateMySortKey = [&](not_null<DocumentData*> document) {
-		auto base = kSlice * 6;
-		if (!document->sticker() || !document->sticker()->isAnimated()) {
-			base -= kSlice;
-		}
-		return (base - (++myCounter));
-	};
-	const auto CreateFeaturedSortKey = [&](not_null<DocumentData*> document) {
-		return CreateSortKey(document, kSlice * 2);
-	};
-	const auto CreateOtherSortKey = [&](not_null<DocumentData*> document) {
-		return CreateSortKey(document, 0);
-	};
+Stickers::EmojiIndex &Stickers::emojiIndex() {
+	if (_emojiIndex) {
+		return *_emojiIndex;
+	}
+	auto &result = _emojiIndex.emplace();
 	const auto InstallDateAdjusted = [&](
 			TimeId date,
 			not_null<DocumentData*> document) {
-		return (document->sticker() && document->sticker()->isAnimated())
-			? date
-			: date / 2;
+		return IsAnimatedSticker(document) ? date : (date / 2);
 	};
 	const auto InstallDate = [&](not_null<DocumentData*> document) {
 		Expects(document->sticker() != nullptr);
 
 		const auto sticker = document->sticker();
 		if (sticker->set.id) {
-			const auto setIt = sets.find(sticker->set.id);
-			if (setIt != sets.end()) {
+			const auto setIt = _sets.find(sticker->set.id);
+			if (setIt != _sets.end()) {
 				return InstallDateAdjusted(setIt->second->installDate, document);
 			}
 		}
 		return TimeId(0);
 	};
 
-	auto recentIt = sets.find(Stickers::CloudRecentSetId);
-	if (recentIt != sets.cend()) {
+	const auto recentIt = _sets.find(Stickers::CloudRecentSetId);
+	if (recentIt != _sets.cend()) {
 		const auto recent = recentIt->second.get();
-		auto i = recent->emoji.constFind(original);
-		if (i != recent->emoji.cend()) {
-			result.reserve(i->size());
+		auto usageDates = base::flat_map<not_null<DocumentData*>, TimeId>();
+		if (!recent->dates.empty()) {
+			Assert(recent->dates.size() == recent->stickers.size());
+			usageDates.reserve(recent->stickers.size());
+			for (auto i = 0, count = int(recent->stickers.size()); i != count; ++i) {
+				usageDates.emplace(recent->stickers[i], recent->dates[i]);
+			}
+		}
+		for (auto i = recent->emoji.cbegin(); i != recent->emoji.cend(); ++i) {
+			auto &entry = result.map[i.key()];
+			entry.list.reserve(i->size());
 			for (const auto document : *i) {
-				const auto usageDate = [&] {
-					if (recent->dates.empty()) {
-						return TimeId(0);
-					}
-					const auto index = recent->stickers.indexOf(document);
-					if (index < 0) {
-						return TimeId(0);
-					}
-					Assert(index < recent->dates.size());
-					return recent->dates[index];
-				}();
+				const auto usage = usageDates.find(document);
+				const auto usageDate = (usage != end(usageDates))
+					? usage->second
+					: TimeId(0);
 				const auto date = usageDate
 					? usageDate
 					: InstallDate(document);
-				result.push_back({
-					document,
-					date ? date : CreateRecentSortKey(document) });
+				entry.known.emplace(document);
+				entry.list.push_back(date
+					? EmojiSticker{ document, date }
+					: EmojiSticker{
+						document,
+						0,
+						SeededSortBase(document, kEmojiSortSlice * 6) });
 			}
 		}
 	}
-	const auto addList = [&](
-			const StickersSetsOrder &order,
-			SetFlag skip) {
-		for (const auto setId : order) {
-			auto it = sets.find(setId);
-			if (it == sets.cend() || (it->second->flags & skip)) {
-				continue;
-			}
-			const auto set = it->second.get();
-			if (set->emoji.isEmpty()) {
-				setsToRequest.emplace(set->id, set->accessHash);
-				set->flags |= SetFlag::NotLoaded;
-				continue;
-			}
-			auto i = set->emoji.constFind(original);
-			if (i == set->emoji.cend()) {
-				continue;
-			}
-			const auto my = (set->flags & SetFlag::Installed);
-			result.reserve(result.size() + i->size());
+
+	auto myCounters = base::flat_map<EmojiPtr, int>();
+	for (const auto setId : _setsOrder) {
+		const auto it = _sets.find(setId);
+		if (it == _sets.cend() || (it->second->flags & SetFlag::Archived)) {
+			continue;
+		}
+		const auto set = it->second.get();
+		if (set->emoji.isEmpty()) {
+			result.setsToRequest.emplace(set->id, set->accessHash);
+			set->flags |= SetFlag::NotLoaded;
+			continue;
+		}
+		const auto my = (set->flags & SetFlag::Installed);
+		const auto installDate = my ? set->installDate : TimeId(0);
+		for (auto i = set->emoji.cbegin(); i != set->emoji.cend(); ++i) {
+			auto &entry = result.map[i.key()];
+			entry.list.reserve(entry.list.size() + i->size());
 			for (const auto document : *i) {
-				const auto installDate = my ? set->installDate : TimeId(0);
-				const auto date = (installDate > 1)
-					? InstallDateAdjusted(installDate, document)
-					: my
-					? CreateMySortKey(document)
-					: CreateFeaturedSortKey(document);
-				add(document, date);
+				if (!entry.known.emplace(document).second) {
+					continue;
+				}
+				if (installDate > 1) {
+					entry.list.push_back({
+						document,
+						InstallDateAdjusted(installDate, document) });
+				} else if (my) {
+					const auto base = IsAnimatedSticker(document)
+						? (kEmojiSortSlice * 6)
+						: (kEmojiSortSlice * 5);
+					const auto counter = ++myCounters[i.key()];
+					entry.list.push_back({ document, TimeId(base - counter) });
+				} else {
+					entry.list.push_back({
+						document,
+						0,
+						SeededSortBase(document, kEmojiSortSlice * 2) });
+				}
 			}
 		}
-	};
+	}
+	return result;
+}
 
-	addList(setsOrder(), SetFlag::Archived);
-	//addList(featuredSetsOrder(), SetFlag::Installed);
+std::vector<not_null<DocumentData*>> Stickers::getListByEmoji(
+		not_null<EmojiPtr> emoji,
+		uint64 seed) {
+	const auto original = emoji->original();
+	auto &index = emojiIndex();
 
-	if (!setsToRequest.empty()) {
-		for (const auto &[setId, accessHash] : setsToRequest) {
+	if (!index.setsToRequest.empty()) {
+		for (const auto &[setId, accessHash] : index.setsToRequest) {
 			session().api().scheduleStickerSetRequest(setId, accessHash);
 		}
 		session().api().requestStickerSets();
 	}
 
+	const auto SortKey = [&](const EmojiSticker &sticker) {
+		return sticker.date
+			? sticker.date
+			: TimeId(sticker.sortBase
+				+ int((sticker.document->id ^ seed) % kEmojiSortSlice));
+	};
+
+	const auto i = index.map.find(original);
+	const auto local = (i != end(index.map)) ? &i->second : nullptr;
+	if (local && local->rankedSeed != seed) {
+		auto ranked = local->list;
+		ranges::stable_sort(ranked, std::greater<>(), SortKey);
+		local->ranked = ranked | ranges::views::transform(
+			&EmojiSticker::document
+		) | ranges::to_vector;
+		local->rankedSeed = seed;
+	}
+	auto result = local ? local->ranked : std::vector<not_null<DocumentData*>>();
+
 	if (Core::App().settings().suggestStickersByEmoji()) {
 		const auto others = session().api().stickersByEmoji(original);
 		if (!others) {
 			return {};
 		}
-		result.reserve(result.size() + others->size());
+
+		// Stickers from not installed sets have the smallest sort keys,
+		// so they always go after all the stickers from the index.
+		auto added = base::flat_set<not_null<DocumentData*>>();
+		auto rest = std::vector<EmojiSticker>();
+		rest.reserve(others->size());
 		for (const auto document : *others) {
-			add(document, CreateOtherSortKey(document));
+			if ((!local || !local->known.contains(document))
+				&& added.emplace(document).second) {
+				rest.push_back({
+					document,
+					0,
+					SeededSortBase(document, 0) });
+			}
+		}
+		ranges::stable_sort(rest, std::greater<>(), SortKey);
+		result.reserve(result.size() + rest.size());
+		for (const auto &sticker : rest) {
+			result.push_back(sticker.document);
 		}
 	}
-
-	ranges::actions::sort(
-		result,
-		std::greater<>(),
-		&StickerWithDate::date);
-
-	return ranges::views::all(
-		result
-	) | ranges::views::transform([](const StickerWithDate &data) {
-		return data.document;
-	}) | ranges::to_vector;
+	return result;
 }
 
 std::optional<std::vector<not_null<EmojiPtr>>> Stickers::getEmojiListFromSet(
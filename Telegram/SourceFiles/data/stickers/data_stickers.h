@@ -126,12 +126,14 @@ public:
 		return _sets;
 	}
 	StickersSets &setsRef() {
+		invalidateEmojiIndex();
 		return _sets;
 	}
 	const StickersSetsOrder &setsOrder() const {
 		return _setsOrder;
 	}
 	StickersSetsOrder &setsOrderRef() {
+		invalidateEmojiIndex();
 		return _setsOrder;
 	}
 	const StickersSetsOrder &maskSetsOrder() const {
@@ -206,6 +208,22 @@ public:
 	RecentStickerPack &getRecentPack() const;
 
 private:
+	struct EmojiSticker {
+		not_null<DocumentData*> document;
+		TimeId date = 0; // Zero if the order depends on the seed.
+		int sortBase = 0;
+	};
+	struct EmojiStickers {
+		std::vector<EmojiSticker> list;
+		base::flat_set<not_null<DocumentData*>> known;
+		std::vector<not_null<DocumentData*>> ranked;
+		std::optional<uint64> rankedSeed;
+	};
+	struct EmojiIndex {
+		std::unordered_map<EmojiPtr, EmojiStickers> map;
+		base::flat_map<uint64, uint64> setsToRequest;
+	};
+
 	bool updateNeeded(crl::time lastUpdate, crl::time now) const {
 		constexpr auto kUpdateTimeout = crl::time(3600'000);
 		return (lastUpdate == 0)
@@ -228,6 +246,8 @@ private:
 		StickersPack &&pack,
 		const std::vector<TimeId> &&dates,
 		const QVector<MTPStickerPack> &packs);
+	void invalidateEmojiIndex();
+	[[nodiscard]] EmojiIndex &emojiIndex();
 	void setsOrMasksReceived(
 		const QVector<MTPStickerSet> &data,
 		uint64 hash,
@@ -254,6 +274,9 @@ private:
 	StickersSetsOrder _archivedMaskSetsOrder;
 	SavedGifs _savedGifs;
 
+	// Installed and recent stickers by emoji, rebuilt after any change.
+	std::optional<EmojiIndex> _emojiIndex;
+
 };
 
 } // namespace Data
@@ -179,35 +179,24 @@ TimeId Entry::adjustedChatListTimeId() const {
 void Entry::changedChatListPinHook() {
 }
 
-RowsByLetter *Entry::chatListLinks(FilterId filterId) {
-	const auto i = _chatListLinks.find(filterId);
-	return (i != end(_chatListLinks)) ? &i->second : nullptr;
-}
-
-const RowsByLetter *Entry::chatListLinks(FilterId filterId) const {
-	const auto i = _chatListLinks.find(filterId);
-	return (i != end(_chatListLinks)) ? &i->second : nullptr;
-}
-
 not_null<Row*> Entry::mainChatListLink(FilterId filterId) const {
-	const auto links = chatListLinks(filterId);
-	Assert(links != nullptr);
-	return links->main;
+	const auto row = maybeMainChatListLink(filterId);
+	Assert(row != nullptr);
+	return row;
 }
 
 Row *Entry::maybeMainChatListLink(FilterId filterId) const {
-	const auto links = chatListLinks(filterId);
-	return links ? links->main.get() : nullptr;
+	const auto i = _chatListLinks.find(filterId);
+	return (i != end(_chatListLinks)) ? i->second.get() : nullptr;
 }
 
 PositionChange Entry::adjustByPosInChatList(
 		FilterId filterId,
 		not_null<MainList*> list) {
-	const auto links = chatListLinks(filterId);
-	Assert(links != nullptr);
-	const auto from = links->main->pos();
-	list->indexed()->adjustByDate(*links);
-	const auto to = links->main->pos();
+	const auto row = mainChatListLink(filterId);
+	const auto from = row->pos();
+	list->indexed()->adjustByDate(row);
+	const auto to = row->pos();
 	return { from, to };
 }
 
@@ -232,7 +221,7 @@ not_null<Row*> Entry::addToChatList(
 	return _chatListLinks.emplace(
 		filterId,
 		list->addEntry(this)
-	).first->second.main;
+	).first->second;
 }
 
 void Entry::removeFromChatList(
@@ -250,23 +239,6 @@ void Entry::removeFromChatList(
 	list->removeEntry(this);
 }
 
-void Entry::removeChatListEntryByLetter(FilterId filterId, QChar letter) {
-	const auto i = _chatListLinks.find(filterId);
-	if (i != end(_chatListLinks)) {
-		i->second.letters.remove(letter);
-	}
-}
-
-void Entry::addChatListEntryByLetter(
-		FilterId filterId,
-		QChar letter,
-		not_null<Row*> row) {
-	const auto i = _chatListLinks.find(filterId);
-	if (i != end(_chatListLinks)) {
-		i->second.letters.emplace(letter, row);
-	}
-}
-
 void Entry::updateChatListEntry() {
 	session().changes().entryUpdated(this, Data::EntryUpdate::Flag::Repaint);
 }
@@ -27,11 +27,6 @@ class Row;
 class IndexedList;
 class MainList;
 
-struct RowsByLetter {
-	not_null<Row*> main;
-	base::flat_map<QChar, not_null<Row*>> letters;
-};
-
 enum class SortMode {
 	Date    = 0x00,
 	Name    = 0x01,
@@ -111,8 +106,7 @@ public:
 	[[nodiscard]] bool inChatList(FilterId filterId = 0) const {
 		return _chatListLinks.contains(filterId);
 	}
-	RowsByLetter *chatListLinks(FilterId filterId);
-	const RowsByLetter *chatListLinks(FilterId filterId) const;
+	Row *maybeMainChatListLink(FilterId filterId) const;
 	[[nodiscard]] int posInChatList(FilterId filterId) const;
 	not_null<Row*> addToChatList(
 		FilterId filterId,
@@ -120,11 +114,6 @@ public:
 	void removeFromChatList(
 		FilterId filterId,
 		not_null<MainList*> list);
-	void removeChatListEntryByLetter(FilterId filterId, QChar letter);
-	void addChatListEntryByLetter(
-		FilterId filterId,
-		QChar letter,
-		not_null<Row*> row);
 	void updateChatListEntry();
 	[[nodiscard]] bool isPinnedDialog(FilterId filterId) const {
 		return lookupPinnedIndex(filterId) != 0;
@@ -157,7 +146,6 @@ public:
 	virtual const QString &chatListName() const = 0;
 	virtual const QString &chatListNameSortKey() const = 0;
 	virtual const base::flat_set<QString> &chatListNameWords() const = 0;
-	virtual const base::flat_set<QChar> &chatListFirstLetters() const = 0;
 
 	virtual bool folderKnown() const {
 		return true;
@@ -210,10 +198,9 @@ private:
 
 	void setChatListExistence(bool exists);
 	not_null<Row*> mainChatListLink(FilterId filterId) const;
-	Row *maybeMainChatListLink(FilterId filterId) const;
 
 	const not_null<Data::Session*> _owner;
-	base::flat_map<FilterId, RowsByLetter> _chatListLinks;
+	base::flat_map<FilterId, not_null<Row*>> _chatListLinks;
 	uint64 _sortKeyInChatList = 0;
 	uint64 _sortKeyByDate = 0;
 	base::flat_map<FilterId, int> _pinnedIndex;
@@ -20,19 +20,12 @@ IndexedList::IndexedList(SortMode sortMode, FilterId filterId)
 , _empty(sortMode, filterId) {
 }
 
-RowsByLetter IndexedList::addToEnd(Key key) {
+not_null<Row*> IndexedList::addToEnd(Key key) {
 	if (const auto row = _list.getRow(key)) {
-		return { row };
-	}
-
-	auto result = RowsByLetter{ _list.addToEnd(key) };
-	for (const auto &ch : key.entry()->chatListFirstLetters()) {
-		auto j = _index.find(ch);
-		if (j == _index.cend()) {
-			j = _index.emplace(ch, _sortMode, _filterId).first;
-		}
-		result.letters.emplace(ch, j->second.addToEnd(key));
+		return row;
 	}
+	const auto result = _list.addToEnd(key);
+	addNameWords(key);
 	return result;
 }
 
@@ -40,35 +33,17 @@ Row *IndexedList::addByName(Key key) {
 	if (const auto row = _list.getRow(key)) {
 		return row;
 	}
-
 	const auto result = _list.addByName(key);
-	for (const auto &ch : key.entry()->chatListFirstLetters()) {
-		auto j = _index.find(ch);
-		if (j == _index.cend()) {
-			j = _index.emplace(ch, _sortMode, _filterId).first;
-		}
-		j->second.addByName(key);
-	}
+	addNameWords(key);
 	return result;
 }
 
-void IndexedList::adjustByDate(const RowsByLetter &links) {
-	_list.adjustByDate(links.main);
-	for (const auto &[ch, row] : links.letters) {
-		if (auto it = _index.find(ch); it != _index.cend()) {
-			it->second.adjustByDate(row);
-		}
-	}
+void IndexedList::adjustByDate(not_null<Row*> row) {
+	_list.adjustByDate(row);
 }
 
 void IndexedList::moveToTop(Key key) {
-	if (_list.moveToTop(key)) {
-		for (const auto &ch : key.entry()->chatListFirstLetters()) {
-			if (auto it = _index.find(ch); it != _index.cend()) {
-				it->second.moveToTop(key);
-			}
-		}
-	}
+	_list.moveToTop(key);
 }
 
 void IndexedList::movePinned(Row *row, int deltaSign) {
@@ -86,147 +61,123 @@ void IndexedList::movePinned(Row *row, int deltaSign) {
 		(*swapPinnedIndexWith)->key());
 }
 
-void IndexedList::peerNameChanged(
-		not_null<PeerData*> peer,
-		const base::flat_set<QChar> &oldLetters) {
-	Expects(_sortMode != SortMode::Date);
-
-	if (const auto history = peer->owner().historyLoaded(peer)) {
-		if (_sortMode == SortMode::Name) {
-			adjustByName(history, oldLetters);
-		} else {
-			adjustNames(FilterId(), history, oldLetters);
+void IndexedList::peerNameChanged(not_null<PeerData*> peer) {
+	const auto history = peer->owner().historyLoaded(peer);
+	if (!history) {
+		return;
+	}
+	const auto key = Key(history);
+	if (_sortMode == SortMode::Name) {
+		if (!_list.adjustByName(key)) {
+			return;
 		}
+	} else if (!_list.contains(key)) {
+		return;
 	}
+	removeNameWords(key);
+	addNameWords(key);
 }
 
-void IndexedList::peerNameChanged(
-		FilterId filterId,
-		not_null<PeerData*> peer,
-		const base::flat_set<QChar> &oldLetters) {
-	Expects(_sortMode == SortMode::Date);
-
-	if (const auto history = peer->owner().historyLoaded(peer)) {
-		adjustNames(filterId, history, oldLetters);
+void IndexedList::del(Key key, Row *replacedBy) {
+	if (_list.del(key, replacedBy)) {
+		removeNameWords(key);
 	}
 }
 
-void IndexedList::adjustByName(
-		Key key,
-		const base::flat_set<QChar> &oldLetters) {
-	Expects(_sortMode == SortMode::Name);
-
-	const auto mainRow = _list.adjustByName(key);
-	if (!mainRow) return;
-
-	auto toRemove = oldLetters;
-	auto toAdd = base::flat_set<QChar>();
-	for (const auto &ch : key.entry()->chatListFirstLetters()) {
-		auto j = toRemove.find(ch);
-		if (j == toRemove.cend()) {
-			toAdd.insert(ch);
-		} else {
-			toRemove.erase(j);
-			if (auto it = _index.find(ch); it != _index.cend()) {
-				it->second.adjustByName(key);
-			}
-		}
-	}
-	for (auto ch : toRemove) {
-		if (auto it = _index.find(ch); it != _index.cend()) {
-			it->second.del(key, mainRow);
-		}
-	}
-	if (!toAdd.empty()) {
-		for (auto ch : toAdd) {
-			auto j = _index.find(ch);
-			if (j == _index.cend()) {
-				j = _index.emplace(ch, _sortMode, _filterId).first;
-			}
-			j->second.addByName(key);
-		}
-	}
+void IndexedList::clear() {
+	_nameWords.clear();
+	_nameWordsSorted = _nameWordsStale = 0;
 }
 
-void IndexedList::adjustNames(
-		FilterId filterId,
-		not_null<History*> history,
-		const base::flat_set<QChar> &oldLetters) {
-	const auto key = Dialogs::Key(history);
-	auto mainRow = _list.getRow(key);
-	if (!mainRow) return;
-
-	auto toRemove = oldLetters;
-	auto toAdd = base::flat_set<QChar>();
-	for (const auto &ch : key.entry()->chatListFirstLetters()) {
-		auto j = toRemove.find(ch);
-		if (j == toRemove.cend()) {
-			toAdd.insert(ch);
-		} else {
-			toRemove.erase(j);
-		}
-	}
-	for (auto ch : toRemove) {
-		if (_sortMode == SortMode::Date) {
-			history->removeChatListEntryByLetter(filterId, ch);
-		}
-		if (auto it = _index.find(ch); it != _index.cend()) {
-			it->second.del(key, mainRow);
-		}
-	}
-	for (auto ch : toAdd) {
-		auto j = _index.find(ch);
-		if (j == _index.cend()) {
-			j = _index.emplace(ch, _sortMode, _filterId).first;
-		}
-		auto row = j->second.addToEnd(key);
-		if (_sortMode == SortMode::Date) {
-			history->addChatListEntryByLetter(filterId, ch, row);
-		}
+void IndexedList::addNameWords(Key key) {
+	for (const auto &word : key.entry()->chatListNameWords()) {
+		_nameWords.push_back({ word, key });
 	}
 }
 
-void IndexedList::del(Key key, Row *replacedBy) {
-	if (_list.del(key, replacedBy)) {
-		for (const auto &ch : key.entry()->chatListFirstLetters()) {
-			if (auto it = _index.find(ch); it != _index.cend()) {
-				it->second.del(key, replacedBy);
-			}
-		}
-	}
+void IndexedList::removeNameWords(Key key) {
+	// Old words are left in place, they are not found as actual.
+	//
+	// For a renamed row they may be not the current ones, but their
+	// count is close enough to decide when to clear them up.
+	_nameWordsStale += int(key.entry()->chatListNameWords().size());
 }
 
-void IndexedList::clear() {
-	_index.clear();
+bool IndexedList::actualNameWord(const NameWord &word) const {
+	return _list.contains(word.key)
+		&& word.key.entry()->chatListNameWords().contains(word.word);
+}
+
+void IndexedList::sortNameWords() const {
+	const auto byWord = [](const NameWord &a, const NameWord &b) {
+		return (a.word < b.word) || (a.word == b.word && a.key < b.key);
+	};
+	const auto sorted = begin(_nameWords) + _nameWordsSorted;
+	if (sorted != end(_nameWords)) {
+		std::sort(sorted, end(_nameWords), byWord);
+		std::inplace_merge(begin(_nameWords), sorted, end(_nameWords), byWord);
+	}
+	if (_nameWordsStale * 2 > int(_nameWords.size())) {
+		const auto stale = [&](const NameWord &word) {
+			return !actualNameWord(word);
+		};
+		const auto same = [](const NameWord &a, const NameWord &b) {
+			return (a.word == b.word) && (a.key == b.key);
+		};
+		_nameWords.erase(
+			ranges::remove_if(_nameWords, stale),
+			end(_nameWords));
+		_nameWords.erase(
+			ranges::unique(_nameWords, same),
+			end(_nameWords));
+		_nameWordsStale = 0;
+	}
+	_nameWordsSorted = int(_nameWords.size());
 }
 
 std::vector<not_null<Row*>> IndexedList::filtered(
 		const QStringList &words) const {
-	const auto minimal = [&]() -> const Dialogs::List* {
-		if (empty()) {
-			return nullptr;
-		}
-		auto result = (const Dialogs::List*)nullptr;
-		for (const auto &word : words) {
-			if (word.isEmpty()) {
-				continue;
-			}
-			const auto found = filtered(word[0]);
-			if (!found || found->empty()) {
-				return nullptr;
-			} else if (!result || result->size() > found->size()) {
-				result = found;
-			}
-		}
-		return result;
-	}();
 	auto result = std::vector<not_null<Row*>>();
-	if (!minimal || minimal->empty()) {
+	if (empty()) {
+		return result;
+	}
+	sortNameWords();
+
+	// Take candidates from the word with the least name words for it.
+	using Range = std::pair<
+		std::vector<NameWord>::const_iterator,
+		std::vector<NameWord>::const_iterator>;
+	auto minimal = std::optional<Range>();
+	for (const auto &word : words) {
+		if (word.isEmpty()) {
+			continue;
+		}
+		const auto from = std::partition_point(
+			begin(_nameWords),
+			end(_nameWords),
+			[&](const NameWord &entry) { return entry.word < word; });
+		const auto till = std::partition_point(
+			from,
+			end(_nameWords),
+			[&](const NameWord &entry) {
+				return entry.word.startsWith(word);
+			});
+		if (from == till) {
+			return result;
+		} else if (!minimal
+			|| (minimal->second - minimal->first) > (till - from)) {
+			minimal = Range{ from, till };
+		}
+	}
+	if (!minimal) {
 		return result;
 	}
-	result.reserve(minimal->size());
-	for (const auto &row : *minimal) {
-		const auto &nameWords = row->entry()->chatListNameWords();
+	result.reserve(minimal->second - minimal->first);
+	for (auto i = minimal->first; i != minimal->second; ++i) {
+		if (!actualNameWord(*i)) {
+			continue;
+		}
+		const auto &nameWords = i->key.entry()->chatListNameWords();
 		const auto found = [&](const QString &word) {
 			for (const auto &name : nameWords) {
 				if (name.startsWith(word)) {
@@ -244,9 +195,13 @@ std::vector<not_null<Row*>> IndexedList::filtered(
 			return true;
 		}();
 		if (allFound) {
-			result.push_back(row);
+			result.emplace_back(_list.getRow(i->key));
 		}
 	}
+
+	// One row may have several name words starting with the same word.
+	ranges::sort(result, ranges::less(), &Row::pos);
+	result.erase(ranges::unique(result), end(result));
 	return result;
 }
 
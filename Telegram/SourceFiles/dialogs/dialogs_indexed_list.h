@@ -10,32 +10,21 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "dialogs/dialogs_entry.h"
 #include "dialogs/dialogs_list.h"
 
-class History;
-
 namespace Dialogs {
 
 class IndexedList {
 public:
 	IndexedList(SortMode sortMode, FilterId filterId = 0);
 
-	RowsByLetter addToEnd(Key key);
+	not_null<Row*> addToEnd(Key key);
 	Row *addByName(Key key);
-	void adjustByDate(const RowsByLetter &links);
+	void adjustByDate(not_null<Row*> row);
 	void moveToTop(Key key);
 
 	// row must belong to this indexed list all().
 	void movePinned(Row *row, int deltaSign);
 
-	// For sortMode != SortMode::Date && != Complex
-	void peerNameChanged(
-		not_null<PeerData*> peer,
-		const base::flat_set<QChar> &oldChars);
-
-	//For sortMode == SortMode::Date || == Complex
-	void peerNameChanged(
-		FilterId filterId,
-		not_null<PeerData*> peer,
-		const base::flat_set<QChar> &oldChars);
+	void peerNameChanged(not_null<PeerData*> peer);
 
 	void del(Key key, Row *replacedBy = nullptr);
 	void clear();
@@ -43,10 +32,9 @@ public:
 	const List &all() const {
 		return _list;
 	}
-	const List *filtered(QChar ch) const {
-		const auto i = _index.find(ch);
-		return (i != _index.end()) ? &i->second : nullptr;
-	}
+
+	// Rows with a name word starting with each of the words,
+	// in the order of all().
 	std::vector<not_null<Row*>> filtered(const QStringList &words) const;
 
 	// Part of List interface is duplicated here for all() list.
@@ -72,18 +60,26 @@ public:
 	iterator find(int y, int h) { return all().find(y, h); }
 
 private:
-	void adjustByName(
-		Key key,
-		const base::flat_set<QChar> &oldChars);
-	void adjustNames(
-		FilterId filterId,
-		not_null<History*> history,
-		const base::flat_set<QChar> &oldChars);
+	struct NameWord {
+		QString word;
+		Key key;
+	};
+
+	void addNameWords(Key key);
+	void removeNameWords(Key key);
+	void sortNameWords() const;
+	[[nodiscard]] bool actualNameWord(const NameWord &word) const;
 
 	SortMode _sortMode = SortMode();
 	FilterId _filterId = 0;
 	List _list, _empty;
-	base::flat_map<QChar, List> _index;
+
+	// Name words of all rows sorted for a prefix binary search. Words
+	// added after the last filtered() call are kept unsorted in the end,
+	// words of deleted or renamed rows are skipped until cleared up.
+	mutable std::vector<NameWord> _nameWords;
+	mutable int _nameWordsSorted = 0;
+	mutable int _nameWordsStale = 0;
 
 };
 
@@ -24,6 +24,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_drafts.h"
 #include "data/data_folder.h"
 #include "data/data_session.h"
+#include "data/data_messages_search_index.h"
 #include "data/data_channel.h"
 #include "data/data_chat.h"
 #include "data/data_user.h"
@@ -64,15 +65,16 @@ namespace {
 
 constexpr auto kHashtagResultsLimit = 5;
 constexpr auto kStartReorderThreshold = 30;
+constexpr auto kLocalSearchLimit = 50;
 
 inline int DialogsRowHeight() {
-	return (::Kotato::JsonSettings::GetInt("chat_list_lines") == 1
+	return (::Kotato::JsonSettings::GetInt(::Kotato::JsonSettings::Key::ChatListLines) == 1
 		? st::dialogsImportantBarHeight
 		: st::dialogsRowHeight);
 }
 
 inline int DialogsPhotoSize() {
-	return (::Kotato::JsonSettings::GetInt("chat_list_lines") == 1
+	return (::Kotato::JsonSettings::GetInt(::Kotato::JsonSettings::Key::ChatListLines) == 1
 		? st::dialogsUnreadHeight
 		: st::dialogsPhotoSize);
 }
@@ -263,8 +265,8 @@ InnerWidget::InnerWidget(
 		const auto repaintId = (_state == WidgetState::Default)
 			? _filterId
 			: 0;
-		if (const auto links = entry->chatListLinks(repaintId)) {
-			repaintDialogRow(repaintId, links->main);
+		if (const auto row = entry->maybeMainChatListLink(repaintId)) {
+			repaintDialogRow(repaintId, row);
 		}
 		if (session().supportMode()
 			&& !session().settings().supportAllSearchResults()) {
@@ -313,7 +315,7 @@ void InnerWidget::refreshWithCollapsedRows(bool toTop) {
 	if (archive &&
 		(session().settings().archiveCollapsed()
 			|| inMainMenu
-			|| ::Kotato::JsonSettings::GetInt("chat_list_lines") == 1)) {
+			|| ::Kotato::JsonSettings::GetInt(::Kotato::JsonSettings::Key::ChatListLines) == 1)) {
 		if (_selected && _selected->folder() == archive) {
 			_selected = nullptr;
 		}
@@ -745,7 +747,7 @@ void InnerWidget::paintPeerSearchResult(
 	auto namewidth = fullWidth - nameleft - st::dialogsPadding.x();
 	QRect rectForName(
 		nameleft,
-		(::Kotato::JsonSettings::GetInt("chat_list_lines") == 1)
+		(::Kotato::JsonSettings::GetInt(::Kotato::JsonSettings::Key::ChatListLines) == 1)
 			? st::dialogsPadding.y()
 			: st::dialogsPadding.y() + st::dialogsNameTop,
 		namewidth,
@@ -776,7 +778,7 @@ void InnerWidget::paintPeerSearchResult(
 		badgeStyle);
 	rectForName.setWidth(rectForName.width() - badgeWidth);
 
-	if (::Kotato::JsonSettings::GetInt("chat_list_lines") == 1) {
+	if (::Kotato::JsonSettings::GetInt(::Kotato::JsonSettings::Key::ChatListLines) == 1) {
 		QString text = peer->nameText().toString();
 		p.setPen(active
 			? st::dialogsNameFgActive
@@ -2126,6 +2128,29 @@ bool InnerWidget::searchReceived(
 	return lastDateFound != 0;
 }
 
+bool InnerWidget::localSearchReceived(const QString &query) {
+	const auto found = session().data().messagesSearchIndex().search(
+		query,
+		_searchInChat.history(),
+		_searchInMigrated,
+		_searchFromPeer,
+		kLocalSearchLimit);
+	if (found.empty()) {
+		return false;
+	}
+	const auto uniquePeers = uniqueSearchResults();
+	clearSearchResults(false);
+	for (const auto item : found) {
+		if (!uniquePeers || !hasHistoryInResults(item->history())) {
+			_searchResults.push_back(
+				std::make_unique<FakeRow>(_searchInChat, item));
+		}
+	}
+	_searchedCount = _searchResults.size();
+	refresh();
+	return true;
+}
+
 void InnerWidget::peerSearchReceived(
 		const QString &query,
 		const QVector<MTPPeer> &my,
@@ -2196,7 +2221,7 @@ bool InnerWidget::needCollapsedRowsRefresh() const {
 		&& (_collapsedRows.back()->folder != nullptr);
 	const auto archiveIsCollapsed = (archive != nullptr)
 		&& (session().settings().archiveCollapsed()
-			|| ::Kotato::JsonSettings::GetInt("chat_list_lines") == 1);
+			|| ::Kotato::JsonSettings::GetInt(::Kotato::JsonSettings::Key::ChatListLines) == 1);
 	const auto archiveIsInMainMenu = (archive != nullptr)
 		&& session().settings().archiveInMainMenu();
 	return archiveIsInMainMenu
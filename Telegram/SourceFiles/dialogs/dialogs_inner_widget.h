@@ -76,6 +76,7 @@ public:
 		HistoryItem *inject,
 		SearchRequestType type,
 		int fullCount);
+	bool localSearchReceived(const QString &query);
 	void peerSearchReceived(
 		const QString &query,
 		const QVector<MTPPeer> &my,
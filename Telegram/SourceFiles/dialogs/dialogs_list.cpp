@@ -59,22 +59,45 @@ not_null<Row*> List::addByName(Key key) {
 	return row;
 }
 
+bool List::searchAllowed(not_null<Row*> row) const {
+	// Rows are adjusted one by one as their keys change, so the others
+	// are sorted and the new place can be found by a binary search. But
+	// in a filter the keys are computed on the fly from the pinned index
+	// and while pinned rows are reordered some of them are out of order.
+	// Scan the neighbours one by one in those cases.
+	return !_filterId && !row->entry()->isPinnedDialog(_filterId);
+}
+
 void List::adjustByName(not_null<Row*> row) {
 	Expects(row->pos() >= 0 && row->pos() < _rows.size());
 
 	const auto &key = row->entry()->chatListNameSortKey();
+	const auto compare = [&](Row *row) {
+		return row->entry()->chatListNameSortKey().compare(key);
+	};
 	const auto index = row->pos();
 	const auto i = _rows.begin() + index;
-	const auto before = std::find_if(i + 1, _rows.end(), [&](Row *row) {
-		return row->entry()->chatListNameSortKey().compare(key) >= 0;
-	});
+	const auto search = searchAllowed(row);
+	const auto before = search
+		? std::partition_point(
+			i + 1,
+			_rows.end(),
+			[&](Row *row) { return compare(row) < 0; })
+		: std::find_if(i + 1, _rows.end(), [&](Row *row) {
+			return compare(row) >= 0;
+		});
 	if (before != i + 1) {
 		rotate(i, i + 1, before);
 	} else if (i != _rows.begin()) {
 		const auto from = std::make_reverse_iterator(i);
-		const auto after = std::find_if(from, _rows.rend(), [&](Row *row) {
-			return row->entry()->chatListNameSortKey().compare(key) <= 0;
-		}).base();
+		const auto after = search
+			? std::partition_point(
+				_rows.begin(),
+				i,
+				[&](Row *row) { return compare(row) <= 0; })
+			: std::find_if(from, _rows.rend(), [&](Row *row) {
+				return compare(row) <= 0;
+			}).base();
 		if (after != i) {
 			rotate(after, i, i + 1);
 		}
@@ -87,16 +110,27 @@ void List::adjustByDate(not_null<Row*> row) {
 	const auto key = row->sortKey(_filterId);
 	const auto index = row->pos();
 	const auto i = _rows.begin() + index;
-	const auto before = std::find_if(i + 1, _rows.end(), [&](Row *row) {
-		return (row->sortKey(_filterId) <= key);
-	});
+	const auto search = searchAllowed(row);
+	const auto before = search
+		? std::partition_point(
+			i + 1,
+			_rows.end(),
+			[&](Row *row) { return (row->sortKey(_filterId) > key); })
+		: std::find_if(i + 1, _rows.end(), [&](Row *row) {
+			return (row->sortKey(_filterId) <= key);
+		});
 	if (before != i + 1) {
 		rotate(i, i + 1, before);
 	} else {
 		const auto from = std::make_reverse_iterator(i);
-		const auto after = std::find_if(from, _rows.rend(), [&](Row *row) {
-			return (row->sortKey(_filterId) >= key);
-		}).base();
+		const auto after = search
+			? std::partition_point(
+				_rows.begin(),
+				i,
+				[&](Row *row) { return (row->sortKey(_filterId) >= key); })
+			: std::find_if(from, _rows.rend(), [&](Row *row) {
+				return (row->sortKey(_filterId) >= key);
+			}).base();
 		if (after != i) {
 			rotate(after, i, i + 1);
 		}
@@ -71,6 +71,7 @@ public:
 	iterator find(int y, int h) { return cfind(y, h); }
 
 private:
+	[[nodiscard]] bool searchAllowed(not_null<Row*> row) const;
 	void adjustByName(not_null<Row*> row);
 	void rotate(
 		std::vector<not_null<Row*>>::iterator first,
@@ -30,7 +30,7 @@ MainList::MainList(
 
 	session->changes().realtimeNameUpdates(
 	) | rpl::start_with_next([=](const Data::NameUpdate &update) {
-		_all.peerNameChanged(_filterId, update.peer, update.oldFirstLetters);
+		_all.peerNameChanged(update.peer);
 	}, _lifetime);
 }
 
@@ -86,7 +86,7 @@ void MainList::clear() {
 	_cloudListSize = 0;
 }
 
-RowsByLetter MainList::addEntry(const Key &key) {
+not_null<Row*> MainList::addEntry(const Key &key) {
 	const auto result = _all.addToEnd(key);
 
 	const auto unread = key.entry()->chatListUnreadState();
@@ -29,7 +29,7 @@ public:
 	void setAllAreMuted(bool allAreMuted = true);
 	void clear();
 
-	RowsByLetter addEntry(const Key &key);
+	not_null<Row*> addEntry(const Key &key);
 	void removeEntry(const Key &key);
 
 	void unreadStateChanged(
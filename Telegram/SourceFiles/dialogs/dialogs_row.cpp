@@ -149,7 +149,7 @@ void BasicRow::updateCornerBadgeShown(
 		not_null<PeerData*> peer,
 		Fn<void()> updateCallback) const {
 	const auto shown = [&] {
-		if (::Kotato::JsonSettings::GetInt("chat_list_lines") == 1) {
+		if (::Kotato::JsonSettings::GetInt(::Kotato::JsonSettings::Key::ChatListLines) == 1) {
 			return false;
 		}
 		if (const auto user = peer->asUser()) {
@@ -181,7 +181,7 @@ void BasicRow::PaintCornerBadgeFrame(
 		view,
 		0,
 		0,
-		(::Kotato::JsonSettings::GetInt("chat_list_lines") == 1
+		(::Kotato::JsonSettings::GetInt(::Kotato::JsonSettings::Key::ChatListLines) == 1
 			? st::dialogsUnreadHeight
 			: st::dialogsPhotoSize));
 
@@ -234,7 +234,7 @@ void BasicRow::paintUserpic(
 			st::dialogsPadding.x(),
 			st::dialogsPadding.y(),
 			fullWidth,
-			(::Kotato::JsonSettings::GetInt("chat_list_lines") == 1
+			(::Kotato::JsonSettings::GetInt(::Kotato::JsonSettings::Key::ChatListLines) == 1
 				? st::dialogsUnreadHeight
 				: st::dialogsPhotoSize));
 		if (!historyForCornerBadge || !_cornerBadgeShown) {
@@ -244,7 +244,7 @@ void BasicRow::paintUserpic(
 	}
 	ensureCornerBadgeUserpic();
 	if (_cornerBadgeUserpic->frame.isNull()) {
-		const auto frameSize = (::Kotato::JsonSettings::GetInt("chat_list_lines") == 1
+		const auto frameSize = (::Kotato::JsonSettings::GetInt(::Kotato::JsonSettings::Key::ChatListLines) == 1
 				? st::dialogsUnreadHeight
 				: st::dialogsPhotoSize) * cRetinaFactor();
 		_cornerBadgeUserpic->frame = QImage(frameSize, frameSize,
@@ -863,6 +863,11 @@ bool Widget::onSearchMessages(bool searchCache) {
 				i->second,
 				0);
 			result = true;
+		} else if (_searchQuery != q && _inner->localSearchReceived(q)) {
+			// Show local results while waiting for the server ones,
+			// don't load more of the previous query until that.
+			cancelSearchRequest();
+			_searchFull = _searchFullMigrated = true;
 		}
 	} else if (_searchQuery != q || _searchQueryFrom != _searchFromAuthor) {
 		_searchQuery = q;
@@ -870,6 +875,7 @@ bool Widget::onSearchMessages(bool searchCache) {
 		_searchNextRate = 0;
 		_searchFull = _searchFullMigrated = false;
 		cancelSearchRequest();
+		_inner->localSearchReceived(_searchQuery);
 		if (const auto peer = _searchInChat.peer()) {
 			auto &histories = session().data().histories();
 			const auto type = Data::Histories::RequestType::History;
@@ -1612,7 +1618,7 @@ void Widget::updateControlsGeometry() {
 		_forwardCancel->moveToLeft(0, filterAreaTop);
 		filterAreaTop += st::dialogsForwardHeight;
 	}
-	auto smallLayoutWidth = (st::dialogsPadding.x() + (::Kotato::JsonSettings::GetInt("chat_list_lines") == 1 ? st::dialogsUnreadHeight : st::dialogsPhotoSize) + st::dialogsPadding.x());
+	auto smallLayoutWidth = (st::dialogsPadding.x() + (::Kotato::JsonSettings::GetInt(::Kotato::JsonSettings::Key::ChatListLines) == 1 ? st::dialogsUnreadHeight : st::dialogsPhotoSize) + st::dialogsPadding.x());
 	auto smallLayoutRatio = (width() < st::columnMinimalWidthLeft) ? (st::columnMinimalWidthLeft - width()) / float64(st::columnMinimalWidthLeft - smallLayoutWidth) : 0.;
 	auto filterLeft = (controller()->filtersWidth() ? st::dialogsFilterSkip : st::dialogsFilterPadding.x() + _mainMenuToggle->width()) + st::dialogsFilterPadding.x();
 	auto filterRight = (session().domain().local().hasLocalPasscode() ? (st::dialogsFilterPadding.x() + _lockUnlock->width()) : st::dialogsFilterSkip) + st::dialogsFilterPadding.x();
@@ -1848,7 +1854,7 @@ void Widget::onCancelSearchInChat() {
 void Widget::onDialogMoved(int movedFrom, int movedTo) {
 	int32 st = _scroll->scrollTop();
 	if (st > movedTo && st < movedFrom) {
-		_scroll->scrollToY(st + (::Kotato::JsonSettings::GetInt("chat_list_lines") == 1 ? st::dialogsImportantBarHeight : st::dialogsRowHeight));
+		_scroll->scrollToY(st + (::Kotato::JsonSettings::GetInt(::Kotato::JsonSettings::Key::ChatListLines) == 1 ? st::dialogsImportantBarHeight : st::dialogsRowHeight));
 	}
 }
 
@@ -126,7 +126,7 @@ void PaintNarrowCounter(
 	if (displayMentionBadge || displayReactionBadge) {
 		const auto counter = QString();
 		const auto unreadRight = st::dialogsPadding.x()
-			+ (::Kotato::JsonSettings::GetInt("chat_list_lines") == 1
+			+ (::Kotato::JsonSettings::GetInt(::Kotato::JsonSettings::Key::ChatListLines) == 1
 				? st::dialogsUnreadHeight
 				: st::dialogsPhotoSize)
 			- skipBeforeMention;
@@ -996,7 +996,7 @@ void RowPainter::paint(
 		&& history->unreadReactions().has();
 	const auto displayUnreadCounter = [&] {
 		if (fullWidth < st::columnMinimalWidthLeft
-			&& ::Kotato::JsonSettings::GetInt("chat_list_lines") == 1) {
+			&& ::Kotato::JsonSettings::GetInt(::Kotato::JsonSettings::Key::ChatListLines) == 1) {
 			return false;
 		}
 
@@ -1032,7 +1032,7 @@ void RowPainter::paint(
 		| (peer && peer->isSelf() ? Flag::SavedMessages : Flag(0))
 		| (peer && peer->isRepliesChat() ? Flag::RepliesMessages : Flag(0));
 	const auto paintItemCallback = [&](int nameleft, int namewidth) {
-		const auto texttop = (::Kotato::JsonSettings::GetInt("chat_list_lines") == 1
+		const auto texttop = (::Kotato::JsonSettings::GetInt(::Kotato::JsonSettings::Key::ChatListLines) == 1
 			? st::dialogsPadding.y()
 			: st::dialogsPadding.y()
 				+ st::msgNameFont->height
@@ -1054,7 +1054,7 @@ void RowPainter::paint(
 			unreadMuted,
 			mentionOrReactionMuted);
 		if (flags & Flag::SearchResult
-			|| ::Kotato::JsonSettings::GetInt("chat_list_lines") > 1) {
+			|| ::Kotato::JsonSettings::GetInt(::Kotato::JsonSettings::Key::ChatListLines) > 1) {
 			const auto &color = active
 				? st::dialogsTextFgServiceActive
 				: (selected
@@ -1102,9 +1102,9 @@ void RowPainter::paint(
 			active,
 			unreadMuted,
 			mentionOrReactionMuted,
-			::Kotato::JsonSettings::GetInt("chat_list_lines"));
+			::Kotato::JsonSettings::GetInt(::Kotato::JsonSettings::Key::ChatListLines));
 	};
-	if (::Kotato::JsonSettings::GetInt("chat_list_lines") == 1) {
+	if (::Kotato::JsonSettings::GetInt(::Kotato::JsonSettings::Key::ChatListLines) == 1) {
 		paintOneLineRow(
 			p,
 			row,
@@ -1210,7 +1210,7 @@ void RowPainter::paint(
 		| (showSavedMessages ? Flag::SavedMessages : Flag(0))
 		| (showRepliesMessages ? Flag::RepliesMessages : Flag(0));
 	const auto paintItemCallback = [&](int nameleft, int namewidth) {
-		const auto texttop = (::Kotato::JsonSettings::GetInt("chat_list_lines") == 1
+		const auto texttop = (::Kotato::JsonSettings::GetInt(::Kotato::JsonSettings::Key::ChatListLines) == 1
 			? st::dialogsPadding.y()
 			: st::dialogsPadding.y()
 				+ st::msgNameFont->height
@@ -1232,7 +1232,7 @@ void RowPainter::paint(
 			mentionOrReactionMuted);
 
 		if (flags & Flag::SearchResult
-			|| ::Kotato::JsonSettings::GetInt("chat_list_lines") > 1) {
+			|| ::Kotato::JsonSettings::GetInt(::Kotato::JsonSettings::Key::ChatListLines) > 1) {
 			const auto itemRect = QRect(
 				nameleft,
 				texttop,
@@ -1261,9 +1261,9 @@ void RowPainter::paint(
 			active,
 			unreadMuted,
 			mentionOrReactionMuted,
-			::Kotato::JsonSettings::GetInt("chat_list_lines"));
+			::Kotato::JsonSettings::GetInt(::Kotato::JsonSettings::Key::ChatListLines));
 	};
-	if (::Kotato::JsonSettings::GetInt("chat_list_lines") == 1) {
+	if (::Kotato::JsonSettings::GetInt(::Kotato::JsonSettings::Key::ChatListLines) == 1) {
 		paintOneLineRow(
 			p,
 			row,
@@ -1307,7 +1307,7 @@ QRect RowPainter::sendActionAnimationRect(
 		int fullWidth,
 		bool textUpdated) {
 	const auto nameleft = st::dialogsPadding.x()
-		+ (::Kotato::JsonSettings::GetInt("chat_list_lines") == 1
+		+ (::Kotato::JsonSettings::GetInt(::Kotato::JsonSettings::Key::ChatListLines) == 1
 			? st::dialogsUnreadHeight
 			: st::dialogsPhotoSize)
 		+ st::dialogsPhotoPadding;
@@ -211,6 +211,31 @@ bool RefreshFileReference(FileLocation &to, const FileLocation &from) {
 	return false;
 }
 
+LocationKey ComputeLocationKey(const FileLocation &value) {
+	auto result = LocationKey();
+	result.type = value.dcId;
+	value.data.match([&](const MTPDinputDocumentFileLocation &data) {
+		const auto letter = data.vthumb_size().v.isEmpty()
+			? char(0)
+			: data.vthumb_size().v[0];
+		result.type |= (2ULL << 24);
+		result.type |= (uint64(uint32(letter)) << 16);
+		result.id = data.vid().v;
+	}, [&](const MTPDinputPhotoFileLocation &data) {
+		const auto letter = data.vthumb_size().v.isEmpty()
+			? char(0)
+			: data.vthumb_size().v[0];
+		result.type |= (6ULL << 24);
+		result.type |= (uint64(uint32(letter)) << 16);
+		result.id = data.vid().v;
+	}, [&](const MTPDinputTakeoutFileLocation &data) {
+		result.type |= (5ULL << 24);
+	}, [](const auto &data) {
+		Unexpected("File location type in Export::Data::ComputeLocationKey.");
+	});
+	return result;
+}
+
 Image ParseMaxImage(
 		const MTPDphoto &photo,
 		const QString &suggestedPath) {
@@ -59,6 +59,17 @@ struct FileLocation {
 
 bool RefreshFileReference(FileLocation &to, const FileLocation &from);
 
+struct LocationKey {
+	uint64 type = 0;
+	uint64 id = 0;
+
+	inline bool operator<(const LocationKey &other) const {
+		return std::tie(type, id) < std::tie(other.type, other.id);
+	}
+};
+
+LocationKey ComputeLocationKey(const FileLocation &value);
+
 struct File {
 	enum class SkipReason {
 		None,
@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "export/export_api_wrap.h"
 
 #include "export/export_settings.h"
+#include "export/export_incremental_state.h"
 #include "export/data/export_data_types.h"
 #include "export/output/export_output_result.h"
 #include "export/output/export_output_file.h"
@@ -15,6 +16,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/value_ordering.h"
 #include "base/bytes.h"
 #include "base/random.h"
+#include "core/utils.h"
 #include <set>
 #include <deque>
 
@@ -31,40 +33,6 @@ constexpr auto kTopPeerSliceLimit = 100;
 constexpr auto kFileMaxSize = 2000 * 1024 * 1024;
 constexpr auto kLocationCacheSize = 100'000;
 
-struct LocationKey {
-	uint64 type;
-	uint64 id;
-
-	inline bool operator<(const LocationKey &other) const {
-		return std::tie(type, id) < std::tie(other.type, other.id);
-	}
-};
-
-LocationKey ComputeLocationKey(const Data::FileLocation &value) {
-	auto result = LocationKey();
-	result.type = value.dcId;
-	value.data.match([&](const MTPDinputDocumentFileLocation &data) {
-		const auto letter = data.vthumb_size().v.isEmpty()
-			? char(0)
-			: data.vthumb_size().v[0];
-		result.type |= (2ULL << 24);
-		result.type |= (uint64(uint32(letter)) << 16);
-		result.id = data.vid().v;
-	}, [&](const MTPDinputPhotoFileLocation &data) {
-		const auto letter = data.vthumb_size().v.isEmpty()
-			? char(0)
-			: data.vthumb_size().v[0];
-		result.type |= (6ULL << 24);
-		result.type |= (uint64(uint32(letter)) << 16);
-		result.id = data.vid().v;
-	}, [&](const MTPDinputTakeoutFileLocation &data) {
-		result.type |= (5ULL << 24);
-	}, [](const auto &data) {
-		Unexpected("File location type in Export::ComputeLocationKey.");
-	});
-	return result;
-}
-
 Settings::Type SettingsFromDialogsType(Data::DialogInfo::Type type) {
 	using DialogType = Data::DialogInfo::Type;
 	switch (type) {
@@ -86,6 +54,47 @@ Settings::Type SettingsFromDialogsType(Data::DialogInfo::Type type) {
 	return Settings::Type(0);
 }
 
+Data::File::SkipReason FileSkipReason(
+		const Settings &settings,
+		const Data::File &file,
+		const Data::Message *message) {
+	using SkipReason = Data::File::SkipReason;
+	using Type = MediaSettings::Type;
+	const auto type = message ? v::match(message->media.content, [&](
+			const Data::Document &data) {
+		if (data.isSticker) {
+			return Type::Sticker;
+		} else if (data.isVideoMessage) {
+			return Type::VideoMessage;
+		} else if (data.isVoiceMessage) {
+			return Type::VoiceMessage;
+		} else if (data.isAnimated) {
+			return Type::GIF;
+		} else if (data.isVideoFile) {
+			return Type::Video;
+		} else {
+			return Type::File;
+		}
+	}, [](const auto &data) {
+		return Type::Photo;
+	}) : Type(0);
+
+	const auto limit = settings.media.sizeLimit;
+	if (message && Data::SkipMessageByDate(*message, settings)) {
+		return SkipReason::DateLimits;
+	} else if ((settings.media.types & type) != type) {
+		return SkipReason::FileType;
+	} else if ((message ? message->file().size : file.size) >= limit) {
+		// Don't load thumbs for large files that we skip.
+		return SkipReason::FileSize;
+	}
+	return SkipReason::None;
+}
+
+[[nodiscard]] QByteArray Md5Result(HashMd5 &md5) {
+	return QByteArray((const char*)md5.result(), 16);
+}
+
 } // namespace
 
 class ApiWrap::LoadedFileCache {
@@ -99,8 +108,8 @@ public:
 
 private:
 	int _limit = 0;
-	std::map<LocationKey, QString> _map;
-	std::deque<LocationKey> _list;
+	std::map<Data::LocationKey, QString> _map;
+	std::deque<Data::LocationKey> _list;
 
 };
 
@@ -158,6 +167,7 @@ struct ApiWrap::FileProcess {
 	Data::FileOrigin origin;
 	int offset = 0;
 	int size = 0;
+	HashMd5 md5;
 
 	struct Request {
 		int offset = 0;
@@ -167,6 +177,16 @@ struct ApiWrap::FileProcess {
 	mtpRequestId requestId = 0;
 };
 
+struct ApiWrap::FilePreload {
+	Data::FileLocation location;
+	QString path;
+	uint64 randomId = 0;
+	int size = 0;
+	QByteArray bytes;
+	mtpRequestId requestId = 0;
+	bool failed = false;
+};
+
 struct ApiWrap::FileProgress {
 	int ready = 0;
 	int total = 0;
@@ -206,11 +226,26 @@ struct ApiWrap::ChatProcess {
 
 	int localSplitIndex = 0;
 	int32 largestIdPlusOne = 1;
+	int32 exportedTill = 0;
 
 	Data::ParseMediaContext context;
 	std::optional<Data::MessagesSlice> slice;
 	bool lastSlice = false;
 	int fileIndex = 0;
+
+	// The following slice is requested while the current one is loading.
+	struct NextSlice {
+		int localSplitIndex = 0;
+		int32 offsetId = 0;
+		std::optional<MTPmessages_Messages> result;
+		bool waiting = false;
+	};
+	std::optional<NextSlice> nextSlice;
+
+	// Files of the current slice loaded in advance, by index * 2 + thumb.
+	base::flat_map<int, FilePreload> preloads;
+	int preloadedBytes = 0;
+	int waitingPreload = -1;
 };
 
 
@@ -300,7 +335,7 @@ void ApiWrap::LoadedFileCache::save(
 	if (!location) {
 		return;
 	}
-	const auto key = ComputeLocationKey(location);
+	const auto key = Data::ComputeLocationKey(location);
 	_map[key] = relativePath;
 	_list.push_back(key);
 	if (_list.size() > _limit) {
@@ -315,7 +350,7 @@ std::optional<QString> ApiWrap::LoadedFileCache::find(
 	if (!location) {
 		return std::nullopt;
 	}
-	const auto key = ComputeLocationKey(location);
+	const auto key = Data::ComputeLocationKey(location);
 	if (const auto i = _map.find(key); i != end(_map)) {
 		return i->second;
 	}
@@ -404,12 +439,14 @@ rpl::producer<Output::Result> ApiWrap::ioErrors() const {
 void ApiWrap::startExport(
 		const Settings &settings,
 		Output::Stats *stats,
+		IncrementalState *incremental,
 		FnMut<void(StartInfo)> done) {
 	Expects(_settings == nullptr);
 	Expects(_startProcess == nullptr);
 
 	_settings = std::make_unique<Settings>(settings);
 	_stats = stats;
+	_incremental = incremental;
 	_startProcess = std::make_unique<StartProcess>();
 	_startProcess->done = std::move(done);
 
@@ -957,8 +994,16 @@ void ApiWrap::requestMessagesCount(int localSplitIndex) {
 	Expects(_chatProcess != nullptr);
 	Expects(localSplitIndex < _chatProcess->info.splits.size());
 
+	const auto splitIndex = _chatProcess->info.splits[localSplitIndex];
+	if (splitIndex < 0
+		&& _incremental
+		&& _incremental->exportedTill(_chatProcess->info.peerId)) {
+		// Migrated group history doesn't change and was exported before.
+		messagesCountLoaded(localSplitIndex, 0);
+		return;
+	}
 	requestChatMessages(
-		_chatProcess->info.splits[localSplitIndex],
+		splitIndex,
 		0, // offset_id
 		0, // add_offset
 		1, // limit
@@ -1368,27 +1413,87 @@ void ApiWrap::requestMessagesSlice() {
 		loadMessagesFiles({});
 		return;
 	}
+	if (_incremental) {
+		const auto till = _incremental->exportedTill(
+			_chatProcess->info.peerId);
+		_chatProcess->largestIdPlusOne = std::max(
+			_chatProcess->largestIdPlusOne,
+			till + 1);
+	}
+	if (auto &next = _chatProcess->nextSlice) {
+		Assert(next->localSplitIndex == _chatProcess->localSplitIndex);
+		Assert(next->offsetId == _chatProcess->largestIdPlusOne);
+
+		if (next->result) {
+			const auto result = std::move(*next->result);
+			next = std::nullopt;
+			messagesSliceLoaded(result);
+		} else {
+			next->waiting = true;
+		}
+		return;
+	}
 	requestChatMessages(
 		_chatProcess->info.splits[_chatProcess->localSplitIndex],
 		_chatProcess->largestIdPlusOne,
 		-kMessagesSliceLimit,
 		kMessagesSliceLimit,
 		[=](const MTPmessages_Messages &result) {
+		messagesSliceLoaded(result);
+	});
+}
+
+void ApiWrap::messagesSliceLoaded(const MTPmessages_Messages &result) {
+	Expects(_chatProcess != nullptr);
+
+	result.match([&](const MTPDmessages_messagesNotModified &data) {
+		error("Unexpected messagesNotModified received.");
+	}, [&](const auto &data) {
+		if constexpr (MTPDmessages_messages::Is<decltype(data)>()) {
+			_chatProcess->lastSlice = true;
+		}
+		auto slice = Data::ParseMessagesSlice(
+			_chatProcess->context,
+			data.vmessages(),
+			data.vusers(),
+			data.vchats(),
+			_chatProcess->info.relativePath);
+		requestNextMessagesSlice(slice);
+		loadMessagesFiles(std::move(slice));
+	});
+}
+
+void ApiWrap::requestNextMessagesSlice(const Data::MessagesSlice &slice) {
+	Expects(_chatProcess != nullptr);
+	Expects(!_chatProcess->nextSlice.has_value());
+
+	if (_chatProcess->lastSlice
+		|| slice.list.empty()
+		|| _settings->preloadFilesCount <= 0) {
+		return;
+	}
+	const auto localSplitIndex = _chatProcess->localSplitIndex;
+	const auto offsetId = slice.list.back().id + 1;
+	_chatProcess->nextSlice = ChatProcess::NextSlice{
+		.localSplitIndex = localSplitIndex,
+		.offsetId = offsetId,
+	};
+	requestChatMessages(
+		_chatProcess->info.splits[localSplitIndex],
+		offsetId,
+		-kMessagesSliceLimit,
+		kMessagesSliceLimit,
+		[=](MTPmessages_Messages &&result) {
 		Expects(_chatProcess != nullptr);
+		Expects(_chatProcess->nextSlice.has_value());
 
-		result.match([&](const MTPDmessages_messagesNotModified &data) {
-			error("Unexpected messagesNotModified received.");
-		}, [&](const auto &data) {
-			if constexpr (MTPDmessages_messages::Is<decltype(data)>()) {
-				_chatProcess->lastSlice = true;
-			}
-			loadMessagesFiles(Data::ParseMessagesSlice(
-				_chatProcess->context,
-				data.vmessages(),
-				data.vusers(),
-				data.vchats(),
-				_chatProcess->info.relativePath));
-		});
+		auto &next = _chatProcess->nextSlice;
+		if (next->waiting) {
+			next = std::nullopt;
+			messagesSliceLoaded(result);
+		} else {
+			next->result = std::move(result);
+		}
 	});
 }
 
@@ -1512,6 +1617,11 @@ void ApiWrap::loadNextMessageFile() {
 		if (Data::SkipMessageByDate(message, *_settings)) {
 			continue;
 		}
+		const auto key = _chatProcess->fileIndex * 2;
+		if (waitForFilePreload(key, list[_chatProcess->fileIndex].file())) {
+			preloadMessagesFiles();
+			return;
+		}
 		const auto fileProgress = [=](FileProgress value) {
 			return loadMessageFileProgress(value);
 		};
@@ -1522,6 +1632,12 @@ void ApiWrap::loadNextMessageFile() {
 			[=](const QString &path) { loadMessageFileDone(path); },
 			currentFileMessage());
 		if (!ready) {
+			preloadMessagesFiles();
+			return;
+		}
+		auto &thumb = list[_chatProcess->fileIndex].thumb().file;
+		if (waitForFilePreload(key + 1, thumb)) {
+			preloadMessagesFiles();
 			return;
 		}
 		const auto thumbProgress = [=](FileProgress value) {
@@ -1534,16 +1650,208 @@ void ApiWrap::loadNextMessageFile() {
 			[=](const QString &path) { loadMessageThumbDone(path); },
 			currentFileMessage());
 		if (!thumbReady) {
+			preloadMessagesFiles();
 			return;
 		}
 	}
 	finishMessagesSlice();
 }
 
+void ApiWrap::preloadMessagesFiles() {
+	Expects(_chatProcess != nullptr);
+	Expects(_chatProcess->slice.has_value());
+
+	const auto loading = [&] {
+		return ranges::count_if(_chatProcess->preloads, [](const auto &p) {
+			return p.second.requestId != 0;
+		});
+	};
+	const auto &list = _chatProcess->slice->list;
+	for (auto index = _chatProcess->fileIndex + 1
+		; index < list.size()
+		; ++index) {
+		if (loading() >= _settings->preloadFilesCount
+			|| _chatProcess->preloadedBytes >= _settings->preloadBytesLimit) {
+			return;
+		}
+		const auto &message = list[index];
+		if (Data::SkipMessageByDate(message, *_settings)) {
+			continue;
+		}
+		preloadFile(index * 2, message.file(), message);
+		preloadFile(index * 2 + 1, message.thumb().file, message);
+	}
+}
+
+void ApiWrap::preloadFile(
+		int key,
+		const Data::File &file,
+		const Data::Message &message) {
+	Expects(_chatProcess != nullptr);
+
+	using SkipReason = Data::File::SkipReason;
+
+	auto &process = *_chatProcess;
+	if (process.preloads.contains(key)
+		|| !file.relativePath.isEmpty()
+		|| file.skipReason != SkipReason::None
+		|| !file.location
+		|| !file.content.isEmpty()
+		|| file.size <= 0
+		|| (process.preloadedBytes + file.size
+			> _settings->preloadBytesLimit)
+		|| (FileSkipReason(*_settings, file, &message)
+			!= SkipReason::None)
+		|| _fileCache->find(file.location)
+		|| (_incremental
+			&& _incremental->findFile(file.location, file.size))) {
+		return;
+	}
+	process.preloadedBytes += file.size;
+	process.preloads.emplace(key, FilePreload{
+		.location = file.location,
+		.path = file.suggestedPath,
+		.randomId = base::RandomValue<uint64>(),
+		.size = file.size,
+	});
+	preloadFilePart(key);
+}
+
+void ApiWrap::preloadFilePart(int key) {
+	Expects(_chatProcess != nullptr);
+	Expects(_takeoutId.has_value());
+
+	const auto i = _chatProcess->preloads.find(key);
+	Assert(i != end(_chatProcess->preloads));
+	auto &preload = i->second;
+	const auto offset = int(preload.bytes.size());
+	preload.requestId = _mtp.request(MTPInvokeWithTakeout<MTPupload_GetFile>(
+		MTP_long(*_takeoutId),
+		MTPupload_GetFile(
+			MTP_flags(0),
+			preload.location.data,
+			MTP_int(offset),
+			MTP_int(kFileChunkSize))
+	)).done([=](const MTPupload_File &result) {
+		filePreloadPartDone(key, offset, result);
+	}).fail([=] {
+		// Errors are handled when the file is loaded the usual way.
+		filePreloadFinished(key, true);
+	}).toDC(MTP::ShiftDcId(
+		preload.location.dcId,
+		MTP::kExportPreloadDcShift
+	)).send();
+}
+
+void ApiWrap::filePreloadPartDone(
+		int key,
+		int offset,
+		const MTPupload_File &result) {
+	Expects(_chatProcess != nullptr);
+
+	const auto i = _chatProcess->preloads.find(key);
+	if (i == end(_chatProcess->preloads)
+		|| i->second.bytes.size() != offset) {
+		return;
+	}
+	auto &preload = i->second;
+	preload.requestId = 0;
+	if (result.type() != mtpc_upload_file) {
+		filePreloadFinished(key, true);
+		return;
+	}
+	const auto &bytes = result.c_upload_file().vbytes().v;
+	preload.bytes.append(bytes);
+	if (_chatProcess->waitingPreload == key) {
+		const auto progress = FileProgress{
+			int(preload.bytes.size()),
+			preload.size
+		};
+		if (!loadMessageFileProgress(
+				progress,
+				preload.randomId,
+				preload.path)) {
+			return;
+		}
+	}
+	if (!bytes.isEmpty() && preload.bytes.size() < preload.size) {
+		preloadFilePart(key);
+		return;
+	}
+	filePreloadFinished(key, (preload.bytes.size() != preload.size));
+}
+
+void ApiWrap::filePreloadFinished(int key, bool failed) {
+	Expects(_chatProcess != nullptr);
+
+	const auto i = _chatProcess->preloads.find(key);
+	if (i == end(_chatProcess->preloads)) {
+		return;
+	}
+	i->second.requestId = 0;
+	if (failed) {
+		i->second.failed = true;
+		i->second.bytes = QByteArray();
+	}
+	if (_chatProcess->waitingPreload == key) {
+		_chatProcess->waitingPreload = -1;
+		loadNextMessageFile();
+	} else if (_chatProcess->slice) {
+		preloadMessagesFiles();
+	}
+}
+
+bool ApiWrap::waitForFilePreload(int key, Data::File &file) {
+	Expects(_chatProcess != nullptr);
+
+	const auto i = _chatProcess->preloads.find(key);
+	if (i == end(_chatProcess->preloads)) {
+		return false;
+	}
+
+	// Report the bytes preloaded so far like the usual loading does.
+	const auto progress = FileProgress{
+		int(i->second.bytes.size()),
+		i->second.size
+	};
+	if (!i->second.failed
+		&& !loadMessageFileProgress(
+			progress,
+			i->second.randomId,
+			i->second.path)) {
+		return true;
+	} else if (i->second.requestId) {
+		_chatProcess->waitingPreload = key;
+		return true;
+	}
+	auto preload = std::move(i->second);
+	_chatProcess->preloads.erase(i);
+	_chatProcess->preloadedBytes -= preload.size;
+	if (!preload.failed) {
+		file.content = std::move(preload.bytes);
+		writePreloadedFile(file, currentFileMessageOrigin());
+		file.content = QByteArray();
+	}
+	return false;
+}
+
+void ApiWrap::cancelFilePreloads() {
+	Expects(_chatProcess != nullptr);
+
+	for (const auto &[key, preload] : base::take(_chatProcess->preloads)) {
+		if (preload.requestId) {
+			_mtp.request(preload.requestId).cancel();
+		}
+	}
+	_chatProcess->preloadedBytes = 0;
+	_chatProcess->waitingPreload = -1;
+}
+
 void ApiWrap::finishMessagesSlice() {
 	Expects(_chatProcess != nullptr);
 	Expects(_chatProcess->slice.has_value());
 
+	cancelFilePreloads();
 	auto slice = *base::take(_chatProcess->slice);
 	if (!slice.list.empty()) {
 		_chatProcess->largestIdPlusOne = slice.list.back().id + 1;
@@ -1551,6 +1859,8 @@ void ApiWrap::finishMessagesSlice() {
 			_chatProcess->localSplitIndex];
 		if (splitIndex < 0) {
 			slice = AdjustMigrateMessageIds(std::move(slice));
+		} else {
+			_chatProcess->exportedTill = slice.list.back().id;
 		}
 		if (!_chatProcess->handleSlice(std::move(slice))) {
 			return;
@@ -1571,14 +1881,25 @@ void ApiWrap::finishMessagesSlice() {
 
 bool ApiWrap::loadMessageFileProgress(FileProgress progress) {
 	Expects(_fileProcess != nullptr);
+
+	return loadMessageFileProgress(
+		progress,
+		_fileProcess->randomId,
+		_fileProcess->relativePath);
+}
+
+bool ApiWrap::loadMessageFileProgress(
+		FileProgress progress,
+		uint64 randomId,
+		const QString &path) {
 	Expects(_chatProcess != nullptr);
 	Expects(_chatProcess->slice.has_value());
 	Expects((_chatProcess->fileIndex >= 0)
 		&& (_chatProcess->fileIndex < _chatProcess->slice->list.size()));
 
 	return _chatProcess->fileProgress(DownloadProgress{
-		.randomId = _fileProcess->randomId,
-		.path = _fileProcess->relativePath,
+		.randomId = randomId,
+		.path = path,
 		.itemIndex = _chatProcess->fileIndex,
 		.ready = progress.ready,
 		.total = progress.total });
@@ -1623,6 +1944,11 @@ void ApiWrap::finishMessages() {
 	Expects(!_chatProcess->slice.has_value());
 
 	const auto process = base::take(_chatProcess);
+	if (_incremental && process->exportedTill) {
+		_incremental->setExportedTill(
+			process->info.peerId,
+			process->exportedTill);
+	}
 	process->done();
 }
 
@@ -1644,37 +1970,12 @@ bool ApiWrap::processFileLoad(
 		return !file.relativePath.isEmpty();
 	}
 
-	using Type = MediaSettings::Type;
-	const auto type = message ? v::match(message->media.content, [&](
-			const Data::Document &data) {
-		if (data.isSticker) {
-			return Type::Sticker;
-		} else if (data.isVideoMessage) {
-			return Type::VideoMessage;
-		} else if (data.isVoiceMessage) {
-			return Type::VoiceMessage;
-		} else if (data.isAnimated) {
-			return Type::GIF;
-		} else if (data.isVideoFile) {
-			return Type::Video;
-		} else {
-			return Type::File;
-		}
-	}, [](const auto &data) {
-		return Type::Photo;
-	}) : Type(0);
-
-	const auto limit = _settings->media.sizeLimit;
-	if (message && Data::SkipMessageByDate(*message, *_settings)) {
-		file.skipReason = SkipReason::DateLimits;
-		return true;
-	} else if ((_settings->media.types & type) != type) {
-		file.skipReason = SkipReason::FileType;
-		return true;
-	} else if ((message ? message->file().size : file.size) >= limit) {
-		// Don't load thumbs for large files that we skip.
-		file.skipReason = SkipReason::FileSize;
+	const auto skipReason = FileSkipReason(*_settings, file, message);
+	if (skipReason != SkipReason::None) {
+		file.skipReason = skipReason;
 		return true;
+	} else if (copyExportedFile(file, origin)) {
+		return !file.relativePath.isEmpty();
 	}
 	loadFile(file, origin, std::move(progress), std::move(done));
 	return false;
@@ -1695,6 +1996,15 @@ bool ApiWrap::writePreloadedFile(
 		if (const auto result = process->file.writeBlock(file.content)) {
 			file.relativePath = process->relativePath;
 			_fileCache->save(file.location, file.relativePath);
+			if (_incremental) {
+				const auto &content = file.content;
+				auto md5 = HashMd5(content.constData(), content.size());
+				_incremental->saveFile(
+					file.location,
+					_settings->path + file.relativePath,
+					file.content.size(),
+					Md5Result(md5));
+			}
 		} else {
 			ioError(result);
 		}
@@ -1703,6 +2013,30 @@ bool ApiWrap::writePreloadedFile(
 	return false;
 }
 
+bool ApiWrap::copyExportedFile(
+		Data::File &file,
+		const Data::FileOrigin &origin) {
+	Expects(_settings != nullptr);
+
+	if (!_incremental) {
+		return false;
+	}
+	const auto source = _incremental->findFile(file.location, file.size);
+	if (!source) {
+		return false;
+	}
+	const auto process = prepareFileProcess(file, origin);
+	const auto path = _settings->path + process->relativePath;
+	if (const auto result = Output::File::Copy(*source, path, _stats)) {
+		file.relativePath = process->relativePath;
+		_fileCache->save(file.location, file.relativePath);
+		_incremental->saveFileCopy(file.location, path);
+	} else {
+		ioError(result);
+	}
+	return true;
+}
+
 void ApiWrap::loadFile(
 		const Data::File &file,
 		const Data::FileOrigin &origin,
@@ -1822,6 +2156,7 @@ void ApiWrap::filePartDone(int offset, const MTPupload_File &result) {
 				ioError(result);
 				return;
 			}
+			_fileProcess->md5.feed(bytes.constData(), bytes.size());
 			requests.pop_front();
 		}
 
@@ -1842,6 +2177,13 @@ void ApiWrap::filePartDone(int offset, const MTPupload_File &result) {
 	auto process = base::take(_fileProcess);
 	const auto relativePath = process->relativePath;
 	_fileCache->save(process->location, relativePath);
+	if (_incremental) {
+		_incremental->saveFile(
+			process->location,
+			_settings->path + relativePath,
+			process->file.size(),
+			Md5Result(process->md5));
+	}
 	process->done(process->relativePath);
 }
 
@@ -33,6 +33,7 @@ class Stats;
 } // namespace Output
 
 struct Settings;
+class IncrementalState;
 
 class ApiWrap {
 public:
@@ -48,6 +49,7 @@ public:
 	void startExport(
 		const Settings &settings,
 		Output::Stats *stats,
+		IncrementalState *incremental,
 		FnMut<void(StartInfo)> done);
 
 	void requestDialogsList(
@@ -97,6 +99,7 @@ private:
 	struct UserpicsProcess;
 	struct OtherDataProcess;
 	struct FileProcess;
+	struct FilePreload;
 	struct FileProgress;
 	struct ChatsProcess;
 	struct LeftChannelsProcess;
@@ -150,6 +153,8 @@ private:
 	void checkFirstMessageDate(int localSplitIndex, int count);
 	void messagesCountLoaded(int localSplitIndex, int count);
 	void requestMessagesSlice();
+	void messagesSliceLoaded(const MTPmessages_Messages &result);
+	void requestNextMessagesSlice(const Data::MessagesSlice &slice);
 	void requestChatMessages(
 		int splitIndex,
 		int offsetId,
@@ -159,10 +164,27 @@ private:
 	void loadMessagesFiles(Data::MessagesSlice &&slice);
 	void loadNextMessageFile();
 	bool loadMessageFileProgress(FileProgress value);
+	bool loadMessageFileProgress(
+		FileProgress value,
+		uint64 randomId,
+		const QString &path);
 	void loadMessageFileDone(const QString &relativePath);
 	bool loadMessageThumbProgress(FileProgress value);
 	void loadMessageThumbDone(const QString &relativePath);
 	void finishMessagesSlice();
+	void preloadMessagesFiles();
+	void preloadFile(
+		int key,
+		const Data::File &file,
+		const Data::Message &message);
+	void preloadFilePart(int key);
+	void filePreloadPartDone(
+		int key,
+		int offset,
+		const MTPupload_File &result);
+	void filePreloadFinished(int key, bool failed);
+	bool waitForFilePreload(int key, Data::File &file);
+	void cancelFilePreloads();
 	void finishMessages();
 
 	[[nodiscard]] Data::Message *currentFileMessage() const;
@@ -180,6 +202,9 @@ private:
 	bool writePreloadedFile(
 		Data::File &file,
 		const Data::FileOrigin &origin);
+	bool copyExportedFile(
+		Data::File &file,
+		const Data::FileOrigin &origin);
 	void loadFile(
 		const Data::File &file,
 		const Data::FileOrigin &origin,
@@ -214,6 +239,7 @@ private:
 	std::optional<uint64> _takeoutId;
 	std::optional<UserId> _selfId;
 	Output::Stats *_stats = nullptr;
+	IncrementalState *_incremental = nullptr;
 
 	std::unique_ptr<Settings> _settings;
 	MTPInputUser _user = MTP_inputUserSelf();
@@ -9,8 +9,10 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "export/export_api_wrap.h"
 #include "export/export_settings.h"
+#include "export/export_incremental_state.h"
 #include "export/data/export_data_types.h"
 #include "export/output/export_output_abstract.h"
+#include "export/output/export_output_file.h"
 #include "export/output/export_output_result.h"
 #include "export/output/export_output_stats.h"
 #include "mtproto/mtp_instance.h"
@@ -126,6 +128,7 @@ private:
 	mutable Step _lastProcessingStep = Step::Initializing;
 
 	std::unique_ptr<Output::AbstractWriter> _writer;
+	std::unique_ptr<IncrementalState> _incremental;
 	std::vector<Step> _steps;
 	int _stepIndex = -1;
 
@@ -247,7 +250,14 @@ void ControllerObject::startExport(
 	}
 	_settings = NormalizeSettings(settings);
 	_environment = environment;
+	Output::File::ResetErrors();
 
+	if (_settings.incremental) {
+		_incremental = std::make_unique<IncrementalState>(_settings.path);
+		if (ioCatchError(_incremental->read())) {
+			return;
+		}
+	}
 	_settings.path = Output::NormalizePath(_settings);
 	_writer = Output::CreateWriter(_settings.format);
 	fillExportSteps();
@@ -329,7 +339,9 @@ void ControllerObject::cancelExportFast() {
 
 void ControllerObject::exportNext() {
 	if (++_stepIndex >= _steps.size()) {
-		if (ioCatchError(_writer->finish())) {
+		if (ioCatchError(_writer->finish())
+			|| ioCatchError(Output::File::Sync())
+			|| (_incremental && ioCatchError(_incremental->write()))) {
 			return;
 		}
 		_api.finishExport([=] {
@@ -354,9 +366,11 @@ void ControllerObject::exportNext() {
 
 void ControllerObject::initialize() {
 	setState(stateInitializing());
-	_api.startExport(_settings, &_stats, [=](ApiWrap::StartInfo info) {
-		initialized(info);
-	});
+	_api.startExport(
+		_settings,
+		&_stats,
+		_incremental.get(),
+		[=](ApiWrap::StartInfo info) { initialized(info); });
 }
 
 void ControllerObject::initialized(const ApiWrap::StartInfo &info) {
@@ -603,6 +617,10 @@ int ControllerObject::substepsInStep(Step step) const {
 }
 
 void ControllerObject::setFinishedState() {
+	LOG(("Export Info: Written %1 files, %2 bytes, %3 bytes per second."
+		).arg(_stats.filesCount()
+		).arg(_stats.bytesCount()
+		).arg(_stats.bytesPerSecond()));
 	setState(FinishedState{
 		_writer->mainFilePath(),
 		_stats.filesCount(),
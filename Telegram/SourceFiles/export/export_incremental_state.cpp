@@ -0,0 +1,218 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "export/export_incremental_state.h"
+
+#include "export/output/export_output_result.h"
+#include "core/utils.h"
+
+#include <QtCore/QFileInfo>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QJsonArray>
+#include <QtCore/QSaveFile>
+
+namespace Export {
+namespace {
+
+constexpr auto kStateFileName = "export_state.json";
+constexpr auto kStateVersion = 1;
+constexpr auto kHashChunkSize = 1024 * 1024;
+
+[[nodiscard]] QByteArray ComputeMd5(QFile &f) {
+	auto md5 = HashMd5();
+	auto chunk = QByteArray(kHashChunkSize, Qt::Uninitialized);
+	while (true) {
+		const auto read = f.read(chunk.data(), chunk.size());
+		if (read < 0) {
+			return QByteArray();
+		} else if (!read) {
+			break;
+		}
+		md5.feed(chunk.constData(), read);
+	}
+	return QByteArray((const char*)md5.result(), 16);
+}
+
+[[nodiscard]] int64 ComputeModified(const QString &path) {
+	return QFileInfo(path).lastModified().toSecsSinceEpoch();
+}
+
+} // namespace
+
+IncrementalState::IncrementalState(const QString &folder)
+: _folder(folder.endsWith('/') ? folder : (folder + '/')) {
+}
+
+QString IncrementalState::statePath() const {
+	return _folder + kStateFileName;
+}
+
+Output::Result IncrementalState::read() {
+	QFile f(statePath());
+	if (!f.exists()) {
+		return Output::Result::Success();
+	} else if (!f.open(QIODevice::ReadOnly)) {
+		return Output::Result(Output::Result::Type::Error, f.fileName());
+	}
+	auto error = QJsonParseError{ 0, QJsonParseError::NoError };
+	const auto document = QJsonDocument::fromJson(f.readAll(), &error);
+	const auto root = document.object();
+	if (error.error != QJsonParseError::NoError
+		|| root.value("version").toInt() != kStateVersion) {
+		LOG(("Export Error: Bad incremental state in '%1', ignoring."
+			).arg(f.fileName()));
+		return Output::Result::Success();
+	}
+	for (const auto &value : root.value("chats").toArray()) {
+		const auto chat = value.toObject();
+		const auto id = chat.value("id").toString().toULongLong();
+		const auto peerId = PeerId(id);
+		const auto till = chat.value("till").toInt();
+		if (peerId && till > 0) {
+			_chats[peerId] = till;
+		}
+	}
+	for (const auto &value : root.value("files").toArray()) {
+		const auto file = value.toObject();
+		const auto key = Data::LocationKey{
+			.type = file.value("type").toString().toULongLong(),
+			.id = file.value("id").toString().toULongLong(),
+		};
+		const auto md5 = file.value("md5").toString().toLatin1();
+		auto exported = ExportedFile{
+			.relativePath = file.value("path").toString(),
+			.size = file.value("size").toInt(),
+			.md5 = QByteArray::fromHex(md5),
+			.modified = file.value("modified").toString().toLongLong(),
+		};
+		if (key.id
+			&& !exported.relativePath.isEmpty()
+			&& exported.size > 0
+			&& exported.md5.size() == 16) {
+			_files.emplace(key, std::move(exported));
+		}
+	}
+	return Output::Result::Success();
+}
+
+Output::Result IncrementalState::write() const {
+	auto chats = QJsonArray();
+	for (const auto &[peerId, till] : _chats) {
+		chats.append(QJsonObject{
+			{ "id", QString::number(peerId.value) },
+			{ "till", till },
+		});
+	}
+	auto files = QJsonArray();
+	for (const auto &[key, file] : _files) {
+		auto modified = file.modified;
+		if (file.written) {
+			// The writes are finished only after File::Sync(),
+			// so the size and the modification time are checked here.
+			const auto info = QFileInfo(_folder + file.relativePath);
+			if (info.size() != file.size) {
+				continue;
+			}
+			modified = info.lastModified().toSecsSinceEpoch();
+		}
+		files.append(QJsonObject{
+			{ "type", QString::number(key.type) },
+			{ "id", QString::number(key.id) },
+			{ "path", file.relativePath },
+			{ "size", file.size },
+			{ "md5", QString::fromLatin1(file.md5.toHex()) },
+			{ "modified", QString::number(modified) },
+		});
+	}
+	const auto root = QJsonObject{
+		{ "version", kStateVersion },
+		{ "chats", chats },
+		{ "files", files },
+	};
+	QSaveFile f(statePath());
+	const auto content = QJsonDocument(root).toJson(QJsonDocument::Compact);
+	return (f.open(QIODevice::WriteOnly)
+		&& f.write(content) == content.size()
+		&& f.commit())
+		? Output::Result::Success()
+		: Output::Result(Output::Result::Type::Error, f.fileName());
+}
+
+int32 IncrementalState::exportedTill(PeerId peerId) const {
+	const auto i = _chats.find(peerId);
+	return (i != end(_chats)) ? i->second : 0;
+}
+
+void IncrementalState::setExportedTill(PeerId peerId, int32 messageId) {
+	auto &till = _chats[peerId];
+	till = std::max(till, messageId);
+}
+
+std::optional<QString> IncrementalState::findFile(
+		const Data::FileLocation &location,
+		int size) const {
+	if (!location || size <= 0) {
+		return std::nullopt;
+	}
+	const auto i = _files.find(Data::ComputeLocationKey(location));
+	if (i == end(_files) || i->second.size != size) {
+		return std::nullopt;
+	}
+	const auto path = _folder + i->second.relativePath;
+	QFile f(path);
+	if (f.size() != size) {
+		return std::nullopt;
+	}
+	const auto modified = ComputeModified(path);
+	if (i->second.modified && i->second.modified != modified) {
+		// Changed after it was exported, even if the size is the same.
+		return std::nullopt;
+	} else if (!i->second.checked) {
+		if (!f.open(QIODevice::ReadOnly)
+			|| ComputeMd5(f) != i->second.md5) {
+			return std::nullopt;
+		}
+		i->second.modified = modified;
+		i->second.checked = true;
+	}
+	return path;
+}
+
+void IncrementalState::saveFile(
+		const Data::FileLocation &location,
+		const QString &path,
+		int size,
+		const QByteArray &md5) {
+	if (!location || size <= 0) {
+		return;
+	}
+	const auto key = Data::ComputeLocationKey(location);
+	if (!key.id) {
+		return;
+	}
+	_files[key] = ExportedFile{
+		.relativePath = QDir(_folder).relativeFilePath(path),
+		.size = size,
+		.md5 = md5,
+		.checked = true,
+		.written = true,
+	};
+}
+
+void IncrementalState::saveFileCopy(
+		const Data::FileLocation &location,
+		const QString &path) {
+	const auto i = _files.find(Data::ComputeLocationKey(location));
+	if (i != end(_files)) {
+		i->second.relativePath = QDir(_folder).relativeFilePath(path);
+		i->second.modified = 0;
+		i->second.written = true;
+	}
+}
+
+} // namespace Export
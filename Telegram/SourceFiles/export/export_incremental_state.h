@@ -0,0 +1,61 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "export/data/export_data_types.h"
+
+namespace Export {
+namespace Output {
+struct Result;
+} // namespace Output
+
+// What the previous incremental exports to the same folder have saved:
+// the last exported message in each chat and the exported media files.
+class IncrementalState {
+public:
+	explicit IncrementalState(const QString &folder);
+
+	[[nodiscard]] Output::Result read();
+	// Should be called after Output::File::Sync() succeeded.
+	[[nodiscard]] Output::Result write() const;
+
+	[[nodiscard]] int32 exportedTill(PeerId peerId) const;
+	void setExportedTill(PeerId peerId, int32 messageId);
+
+	// Returns an absolute path to an unchanged exported copy of the file.
+	[[nodiscard]] std::optional<QString> findFile(
+		const Data::FileLocation &location,
+		int size) const;
+	void saveFile(
+		const Data::FileLocation &location,
+		const QString &path,
+		int size,
+		const QByteArray &md5);
+	void saveFileCopy(
+		const Data::FileLocation &location,
+		const QString &path);
+
+private:
+	struct ExportedFile {
+		QString relativePath;
+		int size = 0;
+		QByteArray md5;
+		mutable int64 modified = 0;
+		mutable bool checked = false;
+		bool written = false;
+	};
+
+	[[nodiscard]] QString statePath() const;
+
+	QString _folder;
+	base::flat_map<PeerId, int32> _chats;
+	base::flat_map<Data::LocationKey, ExportedFile> _files;
+
+};
+
+} // namespace Export
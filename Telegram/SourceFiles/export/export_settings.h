@@ -83,6 +83,14 @@ struct Settings {
 
 	TimeId availableAt = 0;
 
+	// Continue the previous exports to the same folder.
+	bool incremental = false;
+
+	// Media files and the next messages slice are loaded in advance while
+	// the current ones are being written, within these limits.
+	int preloadFilesCount = 8;
+	int preloadBytesLimit = 32 * 1024 * 1024;
+
 	bool onlySinglePeer() const {
 		return singlePeer.type() != mtpc_inputPeerEmpty;
 	}
@@ -9,8 +9,10 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "export/output/export_output_result.h"
 #include "export/output/export_output_stats.h"
+#include "base/platform/base_platform_file_utilities.h"
 #include "base/qt/qt_string_view.h"
 
+#include <crl/crl_queue.h>
 #include <QtCore/QFileInfo>
 #include <QtCore/QDir>
 
@@ -18,10 +20,112 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 namespace Export {
 namespace Output {
+namespace {
+
+constexpr auto kBufferSize = 1024 * 1024;
+constexpr auto kCheckpointSize = 16 * 1024 * 1024;
+constexpr auto kCheckpointTimeout = crl::time(5000);
+
+[[nodiscard]] crl::queue &WriteQueue() {
+	static auto result = crl::queue();
+	return result;
+}
+
+} // namespace
+
+// Everything except the construction is done on the write queue.
+struct File::State {
+	explicit State(const QString &path);
+
+	void write(const QByteArray &block);
+	void flush(bool checkpoint);
+	void close();
+	void fail();
+
+	[[nodiscard]] static base::flat_set<not_null<State*>> &Opened();
+	[[nodiscard]] static QString &FailedPath();
+
+	QFile file;
+	QByteArray buffer;
+	int unsaved = 0;
+	crl::time saved = 0;
+	std::atomic<bool> failed = false;
+};
+
+File::State::State(const QString &path) : file(path) {
+}
+
+void File::State::write(const QByteArray &block) {
+	if (failed) {
+		return;
+	}
+	buffer.append(block);
+	if (buffer.size() >= kBufferSize) {
+		flush(false);
+	}
+}
+
+void File::State::flush(bool checkpoint) {
+	if (failed) {
+		return;
+	} else if (const auto size = int(buffer.size())) {
+		if (file.write(buffer) != size) {
+			fail();
+			return;
+		}
+		buffer.resize(0);
+		unsaved += size;
+	}
+	const auto now = crl::now();
+	if (!unsaved
+		|| (!checkpoint
+			&& unsaved < kCheckpointSize
+			&& now - saved < kCheckpointTimeout)) {
+		return;
+	} else if (!file.flush()) {
+		fail();
+		return;
+	}
+	base::Platform::FlushFileData(file);
+	unsaved = 0;
+	saved = now;
+}
+
+void File::State::close() {
+	flush(false);
+	file.close();
+	Opened().remove(this);
+}
+
+void File::State::fail() {
+	failed = true;
+	if (FailedPath().isEmpty()) {
+		FailedPath() = file.fileName();
+	}
+	buffer = QByteArray();
+}
+
+base::flat_set<not_null<File::State*>> &File::State::Opened() {
+	static auto result = base::flat_set<not_null<State*>>();
+	return result;
+}
+
+QString &File::State::FailedPath() {
+	static auto result = QString();
+	return result;
+}
 
 File::File(const QString &path, Stats *stats) : _path(path), _stats(stats) {
 }
 
+File::~File() {
+	if (const auto state = base::take(_state)) {
+		WriteQueue().async([=] {
+			state->close();
+		});
+	}
+}
+
 int File::size() const {
 	return _offset;
 }
@@ -31,69 +135,81 @@ bool File::empty() const {
 }
 
 Result File::writeBlock(const QByteArray &block) {
-	const auto result = writeBlockAttempt(block);
-	if (!result) {
-		_file.reset();
-	}
-	return result;
-}
-
-Result File::writeBlockAttempt(const QByteArray &block) {
 	if (_stats && !_inStats) {
 		_inStats = true;
 		_stats->incrementFiles();
 	}
-	if (const auto result = reopen(); !result) {
+	if (const auto result = open(); !result) {
 		return result;
+	} else if (_state->failed) {
+		return error();
 	}
 	const auto size = block.size();
 	if (!size) {
 		return Result::Success();
 	}
-	if (_file->write(block) == size && _file->flush()) {
-		_offset += size;
-		if (_stats) {
-			_stats->incrementBytes(size);
-		}
-		return Result::Success();
+	_offset += size;
+	if (_stats) {
+		_stats->incrementBytes(size);
 	}
-	return error();
+	WriteQueue().async([state = _state, block] {
+		state->write(block);
+	});
+	return Result::Success();
+}
+
+Result File::Sync() {
+	auto failedPath = QString();
+	WriteQueue().sync([&] {
+		for (const auto &state : State::Opened()) {
+			state->flush(true);
+		}
+		failedPath = base::take(State::FailedPath());
+	});
+	return failedPath.isEmpty()
+		? Result::Success()
+		: Result(Result::Type::Error, failedPath);
+}
+
+void File::ResetErrors() {
+	// Queued after all the writes of the previous exports.
+	WriteQueue().async([] {
+		State::FailedPath() = QString();
+	});
 }
 
-Result File::reopen() {
-	if (_file && _file->isOpen()) {
+Result File::open() {
+	if (_state) {
 		return Result::Success();
 	}
-	_file.emplace(_path);
-	if (_file->exists()) {
-		if (_file->size() < _offset) {
-			return fatalError();
-		} else if (!_file->resize(_offset)) {
+
+	// The file is created right away, so that PrepareRelativePath sees it.
+	auto state = std::make_shared<State>(_path);
+	auto &file = state->file;
+	if (file.exists() && !file.resize(0)) {
+		return error();
+	} else if (!file.open(QIODevice::Append)) {
+		const auto info = QFileInfo(_path);
+		const auto dir = info.absoluteDir();
+		const auto opened = !dir.exists()
+			&& dir.mkpath(dir.absolutePath())
+			&& file.open(QIODevice::Append);
+		if (!opened) {
 			return error();
 		}
-	} else if (_offset > 0) {
-		return fatalError();
-	}
-	if (_file->open(QIODevice::Append)) {
-		return Result::Success();
 	}
-	const auto info = QFileInfo(_path);
-	const auto dir = info.absoluteDir();
-	return (!dir.exists()
-		&& dir.mkpath(dir.absolutePath())
-		&& _file->open(QIODevice::Append))
-		? Result::Success()
-		: error();
+	state->saved = crl::now();
+	_state = std::move(state);
+	WriteQueue().async([state = _state] {
+		State::Opened().emplace(state.get());
+	});
+	return Result::Success();
 }
 
 Result File::error() const {
 	return Result(Result::Type::Error, _path);
 }
 
-Result File::fatalError() const {
-	return Result(Result::Type::FatalError, _path);
-}
-
 QString File::PrepareRelativePath(
 		const QString &folder,
 		const QString &suggested) {
@@ -7,8 +7,6 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #pragma once
 
-#include "base/optional.h"
-
 #include <QtCore/QFile>
 #include <QtCore/QString>
 #include <QtCore/QByteArray>
@@ -19,15 +17,26 @@ namespace Output {
 struct Result;
 class Stats;
 
+// Blocks are coalesced and written to disk on a background queue,
+// a write error is returned from one of the following calls.
 class File {
 public:
 	File(const QString &path, Stats *stats);
+	File(const File &other) = delete;
+	File &operator=(const File &other) = delete;
+	~File();
 
 	[[nodiscard]] int size() const;
 	[[nodiscard]] bool empty() const;
 
 	[[nodiscard]] Result writeBlock(const QByteArray &block);
 
+	// Waits until all the written blocks of all files reach the disk.
+	[[nodiscard]] static Result Sync();
+
+	// Forgets the write errors of the previous exports.
+	static void ResetErrors();
+
 	[[nodiscard]] static QString PrepareRelativePath(
 		const QString &folder,
 		const QString &suggested);
@@ -38,15 +47,15 @@ public:
 		Stats *stats);
 
 private:
-	[[nodiscard]] Result reopen();
-	[[nodiscard]] Result writeBlockAttempt(const QByteArray &block);
+	struct State;
+
+	[[nodiscard]] Result open();
 
 	[[nodiscard]] Result error() const;
-	[[nodiscard]] Result fatalError() const;
 
 	QString _path;
 	int _offset = 0;
-	std::optional<QFile> _file;
+	std::shared_ptr<State> _state;
 
 	Stats *_stats = nullptr;
 	bool _inStats = false;
@@ -925,6 +925,9 @@ Result JsonWriter::writeOtherData(const Data::File &data) {
 	Expects(data.skipReason == Data::File::SkipReason::None);
 	Expects(!data.relativePath.isEmpty());
 
+	if (const auto result = File::Sync(); !result) {
+		return result;
+	}
 	QFile f(pathWithRelativePath(data.relativePath));
 	if (!f.open(QIODevice::ReadOnly)) {
 		return Result(Result::Type::FatalError, f.fileName());
@@ -12,7 +12,8 @@ namespace Output {
 
 Stats::Stats(const Stats &other)
 : _files(other._files.load())
-, _bytes(other._bytes.load()) {
+, _bytes(other._bytes.load())
+, _started(other._started.load()) {
 }
 
 void Stats::incrementFiles() {
@@ -20,6 +21,8 @@ void Stats::incrementFiles() {
 }
 
 void Stats::incrementBytes(int count) {
+	auto started = crl::time(0);
+	_started.compare_exchange_strong(started, crl::now());
 	_bytes += count;
 }
 
@@ -31,5 +34,14 @@ int64 Stats::bytesCount() const {
 	return _bytes;
 }
 
+int64 Stats::bytesPerSecond() const {
+	const auto started = _started.load();
+	if (!started) {
+		return 0;
+	}
+	const auto elapsed = std::max(crl::now() - started, crl::time(1));
+	return _bytes.load() * 1000 / elapsed;
+}
+
 } // namespace Output
 } // namespace Export
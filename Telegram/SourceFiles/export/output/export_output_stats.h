@@ -22,10 +22,12 @@ public:
 
 	int filesCount() const;
 	int64 bytesCount() const;
+	int64 bytesPerSecond() const;
 
 private:
 	std::atomic<int> _files;
 	std::atomic<int64> _bytes;
+	std::atomic<crl::time> _started;
 
 };
 
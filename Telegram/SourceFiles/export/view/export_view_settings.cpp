@@ -273,6 +273,26 @@ void SettingsWidget::setupPathAndFormat(
 	addLocationLabel(container);
 	addFormatOption(tr::lng_export_option_html(tr::now), Format::Html);
 	addFormatOption(tr::lng_export_option_json(tr::now), Format::Json);
+
+	const auto incremental = container->add(
+		object_ptr<Ui::Checkbox>(
+			container,
+			tr::lng_export_option_incremental(tr::now),
+			readData().incremental,
+			st::defaultBoxCheckbox),
+		st::exportSettingPadding);
+	incremental->checkedChanges(
+	) | rpl::start_with_next([=](bool checked) {
+		changeData([&](Settings &data) {
+			data.incremental = checked;
+		});
+	}, incremental->lifetime());
+	container->add(
+		object_ptr<Ui::FlatLabel>(
+			container,
+			tr::lng_export_option_incremental_about(tr::now),
+			st::exportAboutOptionLabel),
+		st::exportAboutOptionPadding);
 }
 
 void SettingsWidget::addLocationLabel(
@@ -177,9 +177,12 @@ CodecPointer MakeCodecPointer(not_null<AVStream*> stream) {
 		return {};
 	}
 	context->pkt_timebase = stream->time_base;
-	if(::Kotato::JsonSettings::GetBool("ffmpeg_multithread")) {
-		if (::Kotato::JsonSettings::GetInt("ffmpeg_thread_count") > 0) {
-			av_opt_set(context, "threads", std::to_string(::Kotato::JsonSettings::GetInt("ffmpeg_thread_count")).c_str(), 0);
+	using ::Kotato::JsonSettings::Key;
+	if (::Kotato::JsonSettings::GetBool(Key::FFmpegMultithread)) {
+		const auto threads = ::Kotato::JsonSettings::GetInt(
+			Key::FFmpegThreadCount);
+		if (threads > 0) {
+			av_opt_set(context, "threads", std::to_string(threads).c_str(), 0);
 		} else {
 			av_opt_set(context, "threads", "auto", 0);
 		}
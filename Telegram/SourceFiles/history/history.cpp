@@ -32,6 +32,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_user.h"
 #include "data/data_document.h"
 #include "data/data_histories.h"
+#include "data/data_messages_cache.h"
+#include "data/data_messages_search_index.h"
 #include "lang/lang_keys.h"
 #include "apiwrap.h"
 #include "api/api_chat_participants.h"
@@ -2048,10 +2050,6 @@ const base::flat_set<QString> &History::chatListNameWords() const {
 	return peer->nameWords();
 }
 
-const base::flat_set<QChar> &History::chatListFirstLetters() const {
-	return peer->nameFirstLetters();
-}
-
 void History::loadUserpic() {
 	peer->loadUserpic();
 }
@@ -3098,6 +3096,7 @@ void History::clear(ClearType type) {
 		}
 		_notifications.clear();
 		owner().notifyHistoryCleared(this);
+		owner().messagesCache().remove(peer->id);
 		if (unreadCountKnown()) {
 			setUnreadCount(0);
 		}
@@ -3243,7 +3242,12 @@ bool History::switchPinnedHidden(bool hidden) {
 	return result;
 }
 
-History::~History() = default;
+History::~History() {
+	auto &index = owner().messagesSearchIndex();
+	for (const auto &item : _messages) {
+		index.remove(item.get());
+	}
+}
 
 HistoryBlock::HistoryBlock(not_null<History*> history)
 : _history(history) {
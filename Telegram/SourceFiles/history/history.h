@@ -420,7 +420,6 @@ public:
 	const QString &chatListName() const override;
 	const QString &chatListNameSortKey() const override;
 	const base::flat_set<QString> &chatListNameWords() const override;
-	const base::flat_set<QChar> &chatListFirstLetters() const override;
 	void loadUserpic() override;
 	void paintUserpic(
 		Painter &p,
@@ -2626,7 +2626,7 @@ void HistoryInner::recountHistoryGeometry() {
 	updateBotInfo(false);
 	if (_botAbout && !_botAbout->info->text.isEmpty()) {
 		int32 tw = _scroll->width() - st::msgMargin.left() - st::msgMargin.right();
-		if (!::Kotato::JsonSettings::GetBool("adaptive_bubbles") && tw > st::msgMaxWidth) tw = st::msgMaxWidth;
+		if (!::Kotato::JsonSettings::GetBool(::Kotato::JsonSettings::Key::AdaptiveBubbles) && tw > st::msgMaxWidth) tw = st::msgMaxWidth;
 		tw -= st::msgPadding.left() + st::msgPadding.right();
 		const auto descriptionWidth = _history->peer->isRepliesChat()
 			? 0
@@ -2642,7 +2642,7 @@ void HistoryInner::recountHistoryGeometry() {
 			: (st::msgNameFont->height + st::botDescSkip);
 		int32 descH = st::msgMargin.top() + st::msgPadding.top() + descriptionHeight + _botAbout->height + st::msgPadding.bottom() + st::msgMargin.bottom();
 		int32 descMaxWidth = _scroll->width();
-		if (_isChatWide && !::Kotato::JsonSettings::GetBool("adaptive_bubbles")) {
+		if (_isChatWide && !::Kotato::JsonSettings::GetBool(::Kotato::JsonSettings::Key::AdaptiveBubbles)) {
 			descMaxWidth = qMin(descMaxWidth, int32(st::msgMaxWidth + 2 * st::msgPhotoSkip + 2 * st::msgMargin.left()));
 		}
 		int32 descAtX = (descMaxWidth - _botAbout->width) / 2 - st::msgPadding.left();
@@ -2679,7 +2679,7 @@ void HistoryInner::updateBotInfo(bool recount) {
 				Ui::ItemTextBotNoMonoOptions());
 			if (recount) {
 				int32 tw = _scroll->width() - st::msgMargin.left() - st::msgMargin.right();
-				if (!::Kotato::JsonSettings::GetBool("adaptive_bubbles") && tw > st::msgMaxWidth) tw = st::msgMaxWidth;
+				if (!::Kotato::JsonSettings::GetBool(::Kotato::JsonSettings::Key::AdaptiveBubbles) && tw > st::msgMaxWidth) tw = st::msgMaxWidth;
 				tw -= st::msgPadding.left() + st::msgPadding.right();
 				const auto descriptionWidth = _history->peer->isRepliesChat()
 					? 0
@@ -2867,7 +2867,7 @@ void HistoryInner::updateSize() {
 			: (st::msgNameFont->height + st::botDescSkip);
 		int32 descH = st::msgMargin.top() + st::msgPadding.top() + descriptionHeight + _botAbout->height + st::msgPadding.bottom() + st::msgMargin.bottom();
 		int32 descMaxWidth = _scroll->width();
-		if (_isChatWide && !::Kotato::JsonSettings::GetBool("adaptive_bubbles")) {
+		if (_isChatWide && !::Kotato::JsonSettings::GetBool(::Kotato::JsonSettings::Key::AdaptiveBubbles)) {
 			descMaxWidth = qMin(descMaxWidth, int32(st::msgMaxWidth + 2 * st::msgPhotoSkip + 2 * st::msgMargin.left()));
 		}
 		int32 descAtX = (descMaxWidth - _botAbout->width) / 2 - st::msgPadding.left();
@@ -3326,7 +3326,7 @@ void HistoryInner::mouseActionUpdate() {
 					dateWidth += st::msgServicePadding.left() + st::msgServicePadding.right();
 					auto dateLeft = st::msgServiceMargin.left();
 					auto maxwidth = _contentWidth;
-					if (_isChatWide && !::Kotato::JsonSettings::GetBool("adaptive_bubbles")) {
+					if (_isChatWide && !::Kotato::JsonSettings::GetBool(::Kotato::JsonSettings::Key::AdaptiveBubbles)) {
 						maxwidth = qMin(maxwidth, int32(st::msgMaxWidth + 2 * st::msgPhotoSkip + 2 * st::msgMargin.left()));
 					}
 					auto widthForDate = maxwidth - st::msgServiceMargin.left() - st::msgServiceMargin.left();
@@ -42,6 +42,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "storage/storage_shared_media.h"
 #include "mtproto/mtproto_config.h"
 #include "data/data_session.h"
+#include "data/data_messages_search_index.h"
 #include "data/data_changes.h"
 #include "data/data_game.h"
 #include "data/data_media_types.h"
@@ -1689,6 +1690,10 @@ TextWithEntities HistoryMessage::withLocalEntities(
 }
 
 void HistoryMessage::setText(const TextWithEntities &textWithEntities) {
+	history()->owner().messagesSearchIndex().update(
+		this,
+		textWithEntities.text);
+
 	for (const auto &entity : textWithEntities.entities) {
 		auto type = entity.type();
 		if (type == EntityType::Url
@@ -69,6 +69,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_sponsored_messages.h"
 #include "data/data_file_origin.h"
 #include "data/data_histories.h"
+#include "data/data_messages_cache.h"
 #include "data/data_group_call.h"
 #include "data/stickers/data_stickers.h"
 #include "history/history.h"
@@ -290,6 +291,24 @@ object_ptr<Ui::FlatButton> SetupDiscussButton(
 	});
 }
 
+[[nodiscard]] const QVector<MTPMessage> *MessagesFromSlice(
+		const MTPmessages_Messages &messages) {
+	return messages.match([](const MTPDmessages_messagesNotModified &)
+	-> const QVector<MTPMessage>* {
+		return nullptr;
+	}, [](const auto &data) {
+		return &data.vmessages().v;
+	});
+}
+
+[[nodiscard]] TimeId EditDateFromMessage(const MTPMessage &message) {
+	return message.match([](const MTPDmessage &data) {
+		return data.vedit_date().value_or_empty();
+	}, [](const auto &) {
+		return TimeId();
+	});
+}
+
 } // namespace
 
 HistoryWidget::HistoryWidget(
@@ -1073,6 +1092,7 @@ void HistoryWidget::initVoiceRecordBar() {
 	_voiceRecordBar->sendVoiceRequests(
 	) | rpl::start_with_next([=](const auto &data) {
 		if (!canWriteMessage() || data.bytes.isEmpty() || !_history) {
+			session().uploader().cancelStreamed(data.streamedFileId);
 			return;
 		}
 
@@ -1081,7 +1101,8 @@ void HistoryWidget::initVoiceRecordBar() {
 			data.bytes,
 			data.waveform,
 			data.duration,
-			action);
+			action,
+			data.streamedFileId);
 		_voiceRecordBar->clearListenState();
 		applyLocalDraft();
 	}, lifetime());
@@ -2609,6 +2630,11 @@ void HistoryWidget::clearAllLoadRequests() {
 		histories.cancelRequest(_firstLoadRequest);
 		_firstLoadRequest = 0;
 	}
+	if (_firstLoadRefreshRequest) {
+		histories.cancelRequest(_firstLoadRefreshRequest);
+		_firstLoadRefreshRequest = 0;
+		_cachedMessages.clear();
+	}
 	if (_preloadRequest) {
 		histories.cancelRequest(_preloadRequest);
 		_preloadRequest = 0;
@@ -2711,7 +2737,7 @@ void HistoryWidget::refreshSendAsToggle() {
 	} else if (_sendAs) {
 		return;
 	}
-	_sendAs.create(this, st::sendAsButton, ::Kotato::JsonSettings::GetInt("userpic_corner_type"));
+	_sendAs.create(this, st::sendAsButton, ::Kotato::JsonSettings::GetInt(::Kotato::JsonSettings::Key::UserpicCornerType));
 	Ui::SetupSendAsButton(_sendAs.data(), controller());
 }
 
@@ -3125,6 +3151,9 @@ void HistoryWidget::messagesFailed(const MTP::Error &error, int requestId) {
 	} else if (_firstLoadRequest == requestId) {
 		_firstLoadRequest = 0;
 		controller()->showBackFromStack();
+	} else if (_firstLoadRefreshRequest == requestId) {
+		_firstLoadRefreshRequest = 0;
+		_cachedMessages.clear();
 	} else if (_delayedShowAtRequest == requestId) {
 		_delayedShowAtRequest = 0;
 	}
@@ -3248,6 +3277,75 @@ void HistoryWidget::messagesReceived(PeerData *peer, const MTPmessages_Messages
 	}
 }
 
+void HistoryWidget::showCachedMessages(
+		const MTPmessages_Messages &messages) {
+	const auto list = MessagesFromSlice(messages);
+	if (!_history->isEmpty() || !list || list->isEmpty()) {
+		return;
+	}
+
+	// The cached slice is shown for display only, without applying its
+	// pts, users or chats. The server request is kept alive and its
+	// result is applied over these messages in refreshCachedMessages.
+	_cachedMessages.clear();
+	for (const auto &message : *list) {
+		_cachedMessages.emplace(
+			IdFromMessage(message),
+			EditDateFromMessage(message));
+	}
+	_firstLoadRefreshRequest = base::take(_firstLoadRequest);
+	addMessagesToFront(_peer, *list);
+	historyLoaded();
+}
+
+void HistoryWidget::refreshCachedMessages(
+		not_null<PeerData*> peer,
+		const MTPmessages_Messages &messages) {
+	_firstLoadRequest = base::take(_firstLoadRefreshRequest);
+	_history->clear(History::ClearType::Unload);
+	_history->getReadyFor(ShowAtTheEndMsgId);
+
+	const auto cached = base::take(_cachedMessages);
+	messagesReceived(peer, messages, _firstLoadRequest);
+
+	// Items created from the cache are kept by the session and reused
+	// as they are, so apply server edits and deletions to them.
+	const auto list = MessagesFromSlice(messages);
+	if (!list || cached.empty()) {
+		return;
+	}
+	auto &owner = peer->owner();
+	auto fresh = base::flat_set<MsgId>();
+	auto minId = list->isEmpty() ? MsgId() : IdFromMessage(list->front());
+	auto edited = 0;
+	for (const auto &message : *list) {
+		const auto id = IdFromMessage(message);
+		fresh.emplace(id);
+		minId = std::min(minId, id);
+		const auto i = cached.find(id);
+		if (i == end(cached)) {
+			continue;
+		} else if (i->second != EditDateFromMessage(message)) {
+			++edited;
+		}
+		owner.updateEditedMessage(message);
+	}
+
+	// The server slice has all messages newer than its oldest one.
+	auto deleted = QVector<MTPint>();
+	for (const auto &[id, editDate] : cached) {
+		if (id >= minId && !fresh.contains(id)) {
+			deleted.push_back(MTP_int(id));
+		}
+	}
+	if (!deleted.isEmpty()) {
+		owner.processMessagesDeleted(peer->id, deleted);
+	}
+	DEBUG_LOG(("Messages Cache: refreshed %1 edited and %2 deleted messages."
+		).arg(edited
+		).arg(deleted.size()));
+}
+
 void HistoryWidget::historyLoaded() {
 	_historyInited = false;
 	doneShow();
@@ -3266,6 +3364,7 @@ bool HistoryWidget::doWeReadMentions() const {
 		&& _list
 		&& _historyInited
 		&& !_firstLoadRequest
+		&& !_firstLoadRefreshRequest
 		&& !_delayedShowAtRequest
 		&& !_a_show.animating()
 		&& controller()->widget()->doWeMarkAsRead();
@@ -3278,7 +3377,7 @@ void HistoryWidget::checkHistoryActivation() {
 }
 
 void HistoryWidget::firstLoadMessages() {
-	if (!_history || _firstLoadRequest) {
+	if (!_history || _firstLoadRequest || _firstLoadRefreshRequest) {
 		return;
 	}
 
@@ -3323,6 +3422,10 @@ void HistoryWidget::firstLoadMessages() {
 	const auto historyHash = uint64(0);
 
 	const auto history = from;
+	const auto newest = (history == _history)
+		&& !_migrated
+		&& !offsetId
+		&& !offset;
 	const auto type = Data::Histories::RequestType::History;
 	auto &histories = history->owner().histories();
 	_firstLoadRequest = histories.sendRequest(history, type, [=](Fn<void()> finish) {
@@ -3336,13 +3439,36 @@ void HistoryWidget::firstLoadMessages() {
 			MTP_int(minId),
 			MTP_long(historyHash)
 		)).done([=](const MTPmessages_Messages &result) {
-			messagesReceived(history->peer, result, _firstLoadRequest);
+			if (newest) {
+				history->owner().messagesCache().put(
+					history->peer->id,
+					result);
+			}
+			if (_firstLoadRefreshRequest) {
+				refreshCachedMessages(history->peer, result);
+			} else {
+				messagesReceived(history->peer, result, _firstLoadRequest);
+			}
 			finish();
 		}).fail([=](const MTP::Error &error) {
-			messagesFailed(error, _firstLoadRequest);
+			messagesFailed(
+				error,
+				(_firstLoadRefreshRequest
+					? _firstLoadRefreshRequest
+					: _firstLoadRequest));
 			finish();
 		}).send();
 	});
+	if (newest && _history->isEmpty()) {
+		const auto requestId = _firstLoadRequest;
+		history->owner().messagesCache().get(
+			history->peer->id,
+			crl::guard(this, [=](const MTPmessages_Messages &cached) {
+				if (_history == history && _firstLoadRequest == requestId) {
+					showCachedMessages(cached);
+				}
+			}));
+	}
 }
 
 void HistoryWidget::loadMessages() {
@@ -3577,6 +3703,7 @@ void HistoryWidget::preloadHistoryIfNeeded() {
 
 void HistoryWidget::preloadHistoryByScroll() {
 	if (_firstLoadRequest
+		|| _firstLoadRefreshRequest
 		|| _delayedShowAtRequest
 		|| _scroll->isHidden()
 		|| !_peer
@@ -6607,7 +6734,7 @@ void HistoryWidget::setupGroupCallBar() {
 			peer,
 			st::historyGroupCallUserpics.size),
 		Core::App().appDeactivatedValue(),
-		::Kotato::JsonSettings::GetInt("userpic_corner_type"));
+		::Kotato::JsonSettings::GetInt(::Kotato::JsonSettings::Key::UserpicCornerType));
 
 	controller()->adaptive().oneColumnValue(
 	) | rpl::start_with_next([=](bool one) {
@@ -6659,7 +6786,7 @@ void HistoryWidget::setupRequestsBar() {
 		HistoryView::RequestsBarContentByPeer(
 			peer,
 			st::historyRequestsUserpics.size),
-		::Kotato::JsonSettings::GetInt("userpic_corner_type"));
+		::Kotato::JsonSettings::GetInt(::Kotato::JsonSettings::Key::UserpicCornerType));
 
 	controller()->adaptive().oneColumnValue(
 	) | rpl::start_with_next([=](bool one) {
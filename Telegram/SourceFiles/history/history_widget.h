@@ -554,6 +554,10 @@ private:
 	void gotPreview(QString links, const MTPMessageMedia &media, mtpRequestId req);
 	void messagesReceived(PeerData *peer, const MTPmessages_Messages &messages, int requestId);
 	void messagesFailed(const MTP::Error &error, int requestId);
+	void showCachedMessages(const MTPmessages_Messages &messages);
+	void refreshCachedMessages(
+		not_null<PeerData*> peer,
+		const MTPmessages_Messages &messages);
 	void addMessagesToFront(PeerData *peer, const QVector<MTPMessage> &messages);
 	void addMessagesToBack(PeerData *peer, const QVector<MTPMessage> &messages);
 
@@ -690,6 +694,8 @@ private:
 	MsgId _showAtMsgId = ShowAtUnreadMsgId;
 
 	int _firstLoadRequest = 0; // Not real mtpRequestId.
+	int _firstLoadRefreshRequest = 0; // Not real mtpRequestId.
+	base::flat_map<MsgId, TimeId> _cachedMessages; // Shown from the cache.
 	int _preloadRequest = 0; // Not real mtpRequestId.
 	int _preloadDownRequest = 0; // Not real mtpRequestId.
 
@@ -26,6 +26,7 @@ struct VoiceToSend {
 	VoiceWaveform waveform;
 	int duration = 0;
 	Api::SendOptions options;
+	uint64 streamedFileId = 0;
 };
 struct SendActionUpdate {
 	Api::SendProgressType type = Api::SendProgressType();
@@ -1991,7 +1991,7 @@ bool ComposeControls::updateSendAsButton() {
 	_sendAs = std::make_unique<Ui::SendAsButton>(
 		_wrap.get(),
 		st::sendAsButton,
-		::Kotato::JsonSettings::GetInt("userpic_corner_type"));
+		::Kotato::JsonSettings::GetInt(::Kotato::JsonSettings::Key::UserpicCornerType));
 	Ui::SetupSendAsButton(
 		_sendAs.get(),
 		rpl::single(peer.get()),
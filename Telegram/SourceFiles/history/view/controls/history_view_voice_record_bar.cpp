@@ -26,6 +26,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/audio/media_audio_capture.h"
 #include "media/player/media_player_button.h"
 #include "media/player/media_player_instance.h"
+#include "storage/file_upload.h"
 #include "styles/style_chat.h"
 #include "styles/style_layers.h"
 #include "styles/style_media_player.h"
@@ -999,6 +1000,7 @@ VoiceRecordBar::~VoiceRecordBar() {
 	if (isRecording()) {
 		stopRecording(StopType::Cancel);
 	}
+	cancelStreamedUpload();
 }
 
 void VoiceRecordBar::updateMessageGeometry() {
@@ -1299,7 +1301,17 @@ void VoiceRecordBar::startRecording() {
 
 		_recording = true;
 		_controller->widget()->setInnerFocus();
-		instance()->start();
+
+		// Upload the recorded parts while the user is still speaking.
+		cancelStreamedUpload();
+		const auto uploader = &_controller->session().uploader();
+		const auto fileId = _streamedFileId = uploader->startStreamed();
+		instance()->streamedParts(
+		) | rpl::start_with_next([=](const QByteArray &part) {
+			uploader->appendStreamed(fileId, part);
+		}, _recordingLifetime);
+
+		instance()->start(Storage::kStreamedUploadPartSize);
 		instance()->updated(
 		) | rpl::start_with_next_error([=](const Update &update) {
 			_recordingTipRequired = (update.samples < kMinSamples);
@@ -1380,6 +1392,9 @@ void VoiceRecordBar::finish() {
 	_showAnimation.stop();
 	_lockToStopAnimation.stop();
 
+	if (_listen) {
+		cancelStreamedUpload();
+	}
 	_listen = nullptr;
 
 	_sendActionUpdates.fire({ Api::SendProgressType::RecordVoice, -1 });
@@ -1396,12 +1411,16 @@ void VoiceRecordBar::hideFast() {
 void VoiceRecordBar::stopRecording(StopType type) {
 	using namespace ::Media::Capture;
 	if (type == StopType::Cancel) {
+		cancelStreamedUpload();
 		instance()->stop(crl::guard(this, [=](Result &&data) {
 			_cancelRequests.fire({});
 		}));
 		return;
 	}
 	instance()->stop(crl::guard(this, [=](Result &&data) {
+		if (!data.streamed) {
+			cancelStreamedUpload();
+		}
 		if (data.bytes.isEmpty()) {
 			// Close everything.
 			stop(false);
@@ -1411,7 +1430,12 @@ void VoiceRecordBar::stopRecording(StopType type) {
 		Window::ActivateWindow(_controller);
 		const auto duration = Duration(data.samples);
 		if (type == StopType::Send) {
-			_sendVoiceRequests.fire({ data.bytes, data.waveform, duration });
+			_sendVoiceRequests.fire({
+				data.bytes,
+				data.waveform,
+				duration,
+				{},
+				base::take(_streamedFileId) });
 		} else if (type == StopType::Listen) {
 			_listen = std::make_unique<ListenWrap>(
 				this,
@@ -1488,7 +1512,8 @@ void VoiceRecordBar::requestToSendWithOptions(Api::SendOptions options) {
 			data->bytes,
 			data->waveform,
 			Duration(data->samples),
-			options });
+			options,
+			base::take(_streamedFileId) });
 	}
 }
 
@@ -1573,6 +1598,12 @@ void VoiceRecordBar::clearListenState() {
 	}
 }
 
+void VoiceRecordBar::cancelStreamedUpload() {
+	if (const auto fileId = base::take(_streamedFileId)) {
+		_controller->session().uploader().cancelStreamed(fileId);
+	}
+}
+
 float64 VoiceRecordBar::showAnimationRatio() const {
 	// There is no reason to set the final value to zero,
 	// because at zero this widget is hidden.
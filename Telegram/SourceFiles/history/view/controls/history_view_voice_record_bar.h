@@ -112,6 +112,7 @@ private:
 	bool hasDuration() const;
 
 	void finish();
+	void cancelStreamedUpload();
 
 	void activeAnimate(bool active);
 	float64 showAnimationRatio() const;
@@ -151,6 +152,7 @@ private:
 	rpl::variable<bool> _lockShowing = false;
 	int _recordingSamples = 0;
 	float64 _redCircleProgress = 0.;
+	uint64 _streamedFileId = 0;
 
 	rpl::event_stream<> _recordingTipRequests;
 	bool _recordingTipRequired = false;
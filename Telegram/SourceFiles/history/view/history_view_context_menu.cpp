@@ -1102,7 +1102,7 @@ void AddWhoReactedAction(
 		Api::WhoReacted(item, context, st::defaultWhoRead, whoReadIds),
 		participantChosen,
 		showAllChosen,
-		::Kotato::JsonSettings::GetInt("userpic_corner_type")));
+		::Kotato::JsonSettings::GetInt(::Kotato::JsonSettings::Key::UserpicCornerType)));
 }
 
 void ShowWhoReactedMenu(
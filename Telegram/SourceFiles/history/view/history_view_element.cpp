@@ -307,7 +307,7 @@ void UnreadBar::paint(
 	p.setPen(st->historyUnreadBarFg());
 
 	int maxwidth = w;
-	if (chatWide && !::Kotato::JsonSettings::GetBool("adaptive_bubbles")) {
+	if (chatWide && !::Kotato::JsonSettings::GetBool(::Kotato::JsonSettings::Key::AdaptiveBubbles)) {
 		maxwidth = qMin(
 			maxwidth,
 			st::msgMaxWidth
@@ -2700,7 +2700,7 @@ void ListWidget::mouseActionUpdate() {
 					dateWidth += st::msgServicePadding.left() + st::msgServicePadding.right();
 					auto dateLeft = st::msgServiceMargin.left();
 					auto maxwidth = view->width();
-					if (_isChatWide && !::Kotato::JsonSettings::GetBool("adaptive_bubbles")) {
+					if (_isChatWide && !::Kotato::JsonSettings::GetBool(::Kotato::JsonSettings::Key::AdaptiveBubbles)) {
 						maxwidth = qMin(maxwidth, int32(st::msgMaxWidth + 2 * st::msgPhotoSkip + 2 * st::msgMargin.left()));
 					}
 					auto widthForDate = maxwidth - st::msgServiceMargin.left() - st::msgServiceMargin.left();
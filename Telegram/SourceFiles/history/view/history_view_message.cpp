@@ -2961,7 +2961,7 @@ QRect Message::countGeometry() const {
 	//	contentLeft += st::msgPhotoSkip - (hmaxwidth - hwidth);
 	}
 	accumulate_min(contentWidth, maxWidth());
-	if (!::Kotato::JsonSettings::GetBool("adaptive_bubbles")) {
+	if (!::Kotato::JsonSettings::GetBool(::Kotato::JsonSettings::Key::AdaptiveBubbles)) {
 		accumulate_min(contentWidth, _bubbleWidthLimit);
 	}
 	if (mediaWidth < contentWidth) {
@@ -2975,7 +2975,7 @@ QRect Message::countGeometry() const {
 	}
 	if (contentWidth < availableWidth
 		&& (!delegate()->elementIsChatWide()
-			|| (commentsRoot && ::Kotato::JsonSettings::GetBool("adaptive_bubbles")))) {
+			|| (commentsRoot && ::Kotato::JsonSettings::GetBool(::Kotato::JsonSettings::Key::AdaptiveBubbles)))) {
 		if (outbg) {
 			contentLeft += availableWidth - contentWidth;
 		} else if (commentsRoot) {
@@ -3019,10 +3019,10 @@ int Message::resizeContentGetHeight(int newWidth) {
 		}
 	}
 	accumulate_min(contentWidth, maxWidth());
-	_bubbleWidthLimit = (::Kotato::JsonSettings::GetBool("monospace_large_bubbles")
+	_bubbleWidthLimit = (::Kotato::JsonSettings::GetBool(::Kotato::JsonSettings::Key::MonospaceLargeBubbles)
 		? std::max(st::msgMaxWidth, monospaceMaxWidth())
 		: st::msgMaxWidth);
-	if (!::Kotato::JsonSettings::GetBool("adaptive_bubbles")) {
+	if (!::Kotato::JsonSettings::GetBool(::Kotato::JsonSettings::Key::AdaptiveBubbles)) {
 		accumulate_min(contentWidth, _bubbleWidthLimit);
 	}
 	if (mediaDisplayed) {
@@ -3057,7 +3057,7 @@ int Message::resizeContentGetHeight(int newWidth) {
 			_reactions->resizeGetHeight(textWidth);
 		}
 
-		if (!::Kotato::JsonSettings::GetBool("adaptive_bubbles") && contentWidth == maxWidth()) {
+		if (!::Kotato::JsonSettings::GetBool(::Kotato::JsonSettings::Key::AdaptiveBubbles) && contentWidth == maxWidth()) {
 			if (mediaDisplayed) {
 				if (entry) {
 					newHeight += entry->resizeGetHeight(contentWidth);
@@ -965,7 +965,8 @@ void RepliesWidget::sendVoice(ComposeControls::VoiceToSend &&data) {
 		data.bytes,
 		data.waveform,
 		data.duration,
-		std::move(action));
+		std::move(action),
+		data.streamedFileId);
 
 	_composeControls->cancelReplyMessage();
 	_composeControls->clearListenState();
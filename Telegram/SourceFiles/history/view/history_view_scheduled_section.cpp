@@ -43,6 +43,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/call_delayed.h"
 #include "core/file_utilities.h"
 #include "main/main_session.h"
+#include "storage/file_upload.h"
 #include "data/data_chat_participant_status.h"
 #include "data/data_session.h"
 #include "data/data_scheduled_messages.h"
@@ -221,6 +222,8 @@ void ScheduledWidget::setupComposeControls() {
 
 	_composeControls->sendVoiceRequests(
 	) | rpl::start_with_next([=](ComposeControls::VoiceToSend &&data) {
+		// Scheduling may take a while, upload the recording when sent.
+		session().uploader().cancelStreamed(data.streamedFileId);
 		sendVoice(data.bytes, data.waveform, data.duration);
 	}, lifetime());
 
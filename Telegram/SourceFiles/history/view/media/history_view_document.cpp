@@ -263,7 +263,7 @@ QSize Document::countOptimalSize() {
 
 	if (auto named = Get<HistoryDocumentNamed>()) {
 		accumulate_max(maxWidth, tleft + named->_namew + tright);
-		if (::Kotato::JsonSettings::GetBool("adaptive_bubbles") && captioned) {
+		if (::Kotato::JsonSettings::GetBool(::Kotato::JsonSettings::Key::AdaptiveBubbles) && captioned) {
 			accumulate_max(maxWidth, captioned->_caption.maxWidth() + st::msgPadding.left() + st::msgPadding.right());
 		} else {
 			accumulate_min(maxWidth, st::msgMaxWidth);
@@ -133,7 +133,7 @@ QSize Gif::sizeForAspectRatio() const {
 }
 
 QSize Gif::countThumbSize(int &inOutWidthMax) const {
-	const auto captionWithPaddings = ::Kotato::JsonSettings::GetBool("adaptive_bubbles")
+	const auto captionWithPaddings = ::Kotato::JsonSettings::GetBool(::Kotato::JsonSettings::Key::AdaptiveBubbles)
 		? _caption.maxWidth()
 			+ st::msgPadding.left()
 			+ st::msgPadding.right()
@@ -178,8 +178,8 @@ QSize Gif::countOptimalSize() {
 	if (_parent->hasBubble()) {
 		accumulate_max(maxWidth, _parent->minWidthForMedia());
 		if (!_caption.isEmpty()) {
-			if (::Kotato::JsonSettings::GetBool("adaptive_bubbles")) {
-				const auto captionWithPaddings = ::Kotato::JsonSettings::GetBool("adaptive_bubbles")
+			if (::Kotato::JsonSettings::GetBool(::Kotato::JsonSettings::Key::AdaptiveBubbles)) {
+				const auto captionWithPaddings = ::Kotato::JsonSettings::GetBool(::Kotato::JsonSettings::Key::AdaptiveBubbles)
 					? _caption.maxWidth()
 						+ st::msgPadding.left()
 						+ st::msgPadding.right()
@@ -225,8 +225,8 @@ QSize Gif::countCurrentSize(int newWidth) {
 	if (_parent->hasBubble()) {
 		accumulate_max(newWidth, _parent->minWidthForMedia());
 		if (!_caption.isEmpty()) {
-			if (::Kotato::JsonSettings::GetBool("adaptive_bubbles")) {
-				const auto captionWithPaddings = ::Kotato::JsonSettings::GetBool("adaptive_bubbles")
+			if (::Kotato::JsonSettings::GetBool(::Kotato::JsonSettings::Key::AdaptiveBubbles)) {
+				const auto captionWithPaddings = ::Kotato::JsonSettings::GetBool(::Kotato::JsonSettings::Key::AdaptiveBubbles)
 					? _caption.maxWidth()
 						+ st::msgPadding.left()
 						+ st::msgPadding.right()
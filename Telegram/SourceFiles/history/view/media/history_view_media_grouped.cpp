@@ -129,7 +129,7 @@ QSize GroupedMedia::countOptimalSize() {
 		+ st::msgPadding.left()
 		+ st::msgPadding.right();
 	auto groupMaxWidth = st::historyGroupWidthMax;
-	if (::Kotato::JsonSettings::GetBool("adaptive_bubbles")) {
+	if (::Kotato::JsonSettings::GetBool(::Kotato::JsonSettings::Key::AdaptiveBubbles)) {
 		accumulate_max(groupMaxWidth, captionWithPaddings);
 	}
 
@@ -152,7 +152,7 @@ QSize GroupedMedia::countOptimalSize() {
 	}
 
 	if (!_caption.isEmpty()) {
-		if (::Kotato::JsonSettings::GetBool("adaptive_bubbles")) {
+		if (::Kotato::JsonSettings::GetBool(::Kotato::JsonSettings::Key::AdaptiveBubbles)) {
 			maxWidth = qMax(maxWidth, captionWithPaddings);
 		}
 		auto captionw = maxWidth - st::msgPadding.left() - st::msgPadding.right();
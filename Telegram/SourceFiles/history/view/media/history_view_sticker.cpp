@@ -95,8 +95,8 @@ bool Sticker::isEmojiSticker() const {
 }
 
 void Sticker::initSize() {
-	const auto currentStickerHeight = ::Kotato::JsonSettings::GetInt("sticker_height");
-	const auto currentScaleBoth = ::Kotato::JsonSettings::GetBool("sticker_scale_both");
+	const auto currentStickerHeight = ::Kotato::JsonSettings::GetInt(::Kotato::JsonSettings::Key::StickerHeight);
+	const auto currentScaleBoth = ::Kotato::JsonSettings::GetBool(::Kotato::JsonSettings::Key::StickerScaleBoth);
 	const auto maxHeight = int(st::maxStickerSize / 256.0 * currentStickerHeight);
 	const auto maxWidth = currentScaleBoth ? maxHeight : st::maxStickerSize;
 	if (isEmojiSticker() || _diceIndex >= 0) {
@@ -140,7 +140,7 @@ QSize Sticker::Size() {
 }
 
 QSize Sticker::EmojiSize() {
-	const auto currentStickerHeight = ::Kotato::JsonSettings::GetInt("sticker_height");
+	const auto currentStickerHeight = ::Kotato::JsonSettings::GetInt(::Kotato::JsonSettings::Key::StickerHeight);
 	const auto maxHeight = int(st::maxStickerSize / 256.0 * currentStickerHeight / 2);
 	const auto side = std::min(maxHeight, kMaxEmojiSizeFixed);
 	return { side, side };
@@ -307,7 +307,7 @@ QSize WebPage::countOptimalSize() {
 		_durationWidth = st::msgDateFont->width(_duration);
 	}
 	maxWidth += st::msgPadding.left() + st::webPageLeft + st::msgPadding.right();
-	if (::Kotato::JsonSettings::GetBool("adaptive_bubbles")) {
+	if (::Kotato::JsonSettings::GetBool(::Kotato::JsonSettings::Key::AdaptiveBubbles)) {
 		accumulate_min(maxWidth, st::msgMaxWidth);
 		accumulate_max(maxWidth, _parent->plainMaxWidth());
 	}
@@ -325,7 +325,7 @@ QSize WebPage::countCurrentSize(int newWidth) {
 		return { newWidth, minHeight() };
 	}
 
-	if (::Kotato::JsonSettings::GetBool("adaptive_bubbles") && !asArticle()) {
+	if (::Kotato::JsonSettings::GetBool(::Kotato::JsonSettings::Key::AdaptiveBubbles) && !asArticle()) {
 		accumulate_min(newWidth, maxWidth());
 	}
 
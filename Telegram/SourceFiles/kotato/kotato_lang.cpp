@@ -42,6 +42,7 @@ QString LangDir() {
 }
 
 void ParseLanguageData(
+	not_null<LoadedValues*> values,
 	const QString &langCode,
 	bool isDefault) {
 	const auto filename = isDefault
@@ -75,9 +76,9 @@ void ParseLanguageData(
 
 	const auto applyValue = [&](const QString &name, const QString &translation) {
 		if (langCode == kDefaultLanguage) {
-			DefaultValues.insert(name, translation);
+			values->defaultValues.insert(name, translation);
 		} else {
-			CurrentValues.insert(name, translation);
+			values->currentValues.insert(name, translation);
 		}
 	};
 
@@ -123,12 +124,15 @@ void ParseLanguageData(
 	}
 }
 
-void UnpackDefault() {
+void UnpackDefault(const LoadedValues &values) {
 	const auto langDir = LangDir();
 	if (!QDir().exists(langDir)) QDir().mkpath(langDir);
 
 	const auto langs = QDir(":/ktg_lang").entryList(QStringList() << "*.json", QDir::Files);
-	auto neededLangs = QStringList() << kDefaultLanguage << LangCode << BaseLangCode;
+	auto neededLangs = QStringList()
+		<< kDefaultLanguage
+		<< values.langCode
+		<< values.baseLangCode;
 	neededLangs.removeDuplicates();
 
 	for (auto language : langs) {
@@ -153,37 +157,50 @@ void UnpackDefault() {
 
 } // namespace
 
-void Load(const QString &baseLangCode, const QString &langCode) {
-	BaseLangCode = baseLangCode;
-	if (BaseLangCode.endsWith("-raw")) {
-		BaseLangCode.chop(4);
-	}
+LoadedValues Parse(const QString &baseLangCode, const QString &langCode) {
+	auto result = LoadedValues();
+	auto &base = result.baseLangCode;
+	auto &lang = result.langCode;
 
-	LangCode = langCode.isEmpty() ? baseLangCode : langCode;
-	if (LangCode.endsWith("-raw")) {
-		LangCode.chop(4);
+	base = baseLangCode;
+	if (base.endsWith("-raw")) {
+		base.chop(4);
 	}
 
-	DefaultValues.clear();
-	CurrentValues.clear();
+	lang = langCode.isEmpty() ? baseLangCode : langCode;
+	if (lang.endsWith("-raw")) {
+		lang.chop(4);
+	}
 
-	if (BaseLangCode != kDefaultLanguage) {
-		ParseLanguageData(kDefaultLanguage, true);
-		ParseLanguageData(kDefaultLanguage, false);
+	if (base != kDefaultLanguage) {
+		ParseLanguageData(&result, kDefaultLanguage, true);
+		ParseLanguageData(&result, kDefaultLanguage, false);
 	}
 
-	ParseLanguageData(BaseLangCode, true);
-	ParseLanguageData(BaseLangCode, false);
+	ParseLanguageData(&result, base, true);
+	ParseLanguageData(&result, base, false);
 
-	if (LangCode != BaseLangCode) {
-		ParseLanguageData(LangCode, true);
-		ParseLanguageData(LangCode, false);
+	if (lang != base) {
+		ParseLanguageData(&result, lang, true);
+		ParseLanguageData(&result, lang, false);
 	}
 
-	UnpackDefault();
+	UnpackDefault(result);
+	return result;
+}
+
+void Apply(LoadedValues &&values) {
+	BaseLangCode = std::move(values.baseLangCode);
+	LangCode = std::move(values.langCode);
+	DefaultValues = std::move(values.defaultValues);
+	CurrentValues = std::move(values.currentValues);
 	LangChanges.fire({});
 }
 
+void Load(const QString &baseLangCode, const QString &langCode) {
+	Apply(Parse(baseLangCode, langCode));
+}
+
 QString Translate(const QString &key, Var var1, Var var2, Var var3, Var var4) {
 	auto phrase = (CurrentValues.contains(key) && !CurrentValues.value(key).isEmpty())
 		? CurrentValues.value(key)
@@ -32,6 +32,21 @@ struct EntVar {
 	TextWithEntities value;
 };
 
+struct LoadedValues {
+	QString baseLangCode;
+	QString langCode;
+	QMap<QString, QString> defaultValues;
+	QMap<QString, QString> currentValues;
+};
+
+// Thread: Any. Reads the language files and unpacks the bundled ones.
+[[nodiscard]] LoadedValues Parse(
+	const QString &baseLangCode,
+	const QString &langCode);
+
+// Thread: Main.
+void Apply(LoadedValues &&values);
+
 void Load(const QString &baseLangCode, const QString &langCode);
 
 QString Translate(
@@ -30,6 +30,34 @@ namespace JsonSettings {
 namespace {
 
 constexpr auto kWriteJsonTimeout = crl::time(5000);
+constexpr auto kKeyCount = int(Key::kCount);
+
+constexpr const char *KeyNames[] = {
+	"adaptive_bubbles",
+	"monospace_large_bubbles",
+	"big_emoji_outline",
+	"sticker_height",
+	"sticker_scale_both",
+	"chat_list_lines",
+	"userpic_corner_type",
+	"ffmpeg_multithread",
+	"ffmpeg_thread_count",
+	"video_decode_ahead",
+	"streaming_slices_in_memory",
+	"pixmap_cache_size",
+};
+static_assert(std::size(KeyNames) == kKeyCount);
+
+std::array<std::atomic<int>, kKeyCount> CachedValues;
+
+void UpdateCached(const QString &mapKey, const QVariant &value) {
+	for (auto i = 0; i != kKeyCount; ++i) {
+		if (mapKey == QLatin1String(KeyNames[i])) {
+			CachedValues[i].store(value.toInt(), std::memory_order_relaxed);
+			return;
+		}
+	}
+}
 
 class Manager : public QObject {
 public:
@@ -376,10 +404,22 @@ const std::map<QString, Definition, std::greater<QString>> DefinitionMap {
 		.type = SettingType::IntSetting,
 		.defaultValue = 0,
 		.limitHandler = IntLimitMin(0) }},
+	{ "video_decode_ahead", {
+		.type = SettingType::IntSetting,
+		.defaultValue = 250,
+		.limitHandler = IntLimit(0, 2000, 250), }},
+	{ "streaming_slices_in_memory", {
+		.type = SettingType::IntSetting,
+		.defaultValue = 4,
+		.limitHandler = IntLimit(2, 16, 4), }},
 	{ "recent_stickers_limit", {
 		.type = SettingType::IntSetting,
 		.defaultValue = 20,
 		.limitHandler = IntLimit(0, 200, 20), }},
+	{ "pixmap_cache_size", {
+		.type = SettingType::IntSetting,
+		.defaultValue = 256,
+		.limitHandler = IntLimit(16, 4096, 256), }},
 	{ "userpic_corner_type", {
 		.type = SettingType::IntSetting,
 		.defaultValue = 3,
@@ -651,8 +691,17 @@ void Manager::fill() {
 
 	const auto addDefaultValue = [&] (const QString &option, QVariant value) {
 		_settingsHashMap.insert(option, value);
+		UpdateCached(option, value);
 	};
 
+	for (const auto name : KeyNames) {
+		const auto i = DefinitionMap.find(name);
+		Assert(i != DefinitionMap.end()
+			&& i->second.scope == SettingScope::Global
+			&& (i->second.type == SettingType::BoolSetting
+				|| i->second.type == SettingType::IntSetting));
+	}
+
 	for (const auto &[key, def] : DefinitionMap) {
 		if (def.scope != SettingScope::Global) {
 			continue;
@@ -795,6 +844,7 @@ rpl::producer<QString> Manager::eventsWithPending(const QString &key, uint64 acc
 void Manager::set(const QString &key, QVariant value, uint64 accountId, bool isTestAccount) {
 	const auto mapKey = MakeMapKey(key, accountId, isTestAccount);
 	_settingsHashMap.insert(mapKey, value);
+	UpdateCached(mapKey, value);
 	_eventStream.fire_copy(mapKey);
 }
 
@@ -1031,6 +1081,18 @@ void Finish() {
 	Data->write(true);
 }
 
+QString KeyName(Key key) {
+	Expects(key != Key::kCount);
+
+	return QString::fromLatin1(KeyNames[int(key)]);
+}
+
+int GetCached(Key key) {
+	Expects(key != Key::kCount);
+
+	return CachedValues[int(key)].load(std::memory_order_relaxed);
+}
+
 QVariant Get(const QString &key, uint64 accountId, bool isTestAccount) {
 	return (Data) ? Data->get(key, accountId, isTestAccount) : QVariant();
 }
@@ -15,6 +15,26 @@ https://github.com/kotatogram/kotatogram-desktop/blob/dev/LEGAL
 namespace Kotato {
 namespace JsonSettings {
 
+// Global settings read while painting, laying out or decoding.
+// Their values are mirrored in atomics, so reading them by a key
+// doesn't hash a string or convert a QVariant and works off main thread.
+enum class Key {
+	AdaptiveBubbles,
+	MonospaceLargeBubbles,
+	BigEmojiOutline,
+	StickerHeight,
+	StickerScaleBoth,
+	ChatListLines,
+	UserpicCornerType,
+	FFmpegMultithread,
+	FFmpegThreadCount,
+	VideoDecodeAhead,
+	StreamingSlicesInMemory,
+	PixmapCacheSize,
+
+	kCount,
+};
+
 void Start();
 void Load();
 void Write();
@@ -55,6 +75,21 @@ void ResetAfterRestart(
 	uint64 accountId = 0,
 	bool isTestAccount = false);
 
+[[nodiscard]] QString KeyName(Key key);
+[[nodiscard]] int GetCached(Key key);
+
+[[nodiscard]] inline bool GetBool(Key key) {
+	return GetCached(key) != 0;
+}
+
+[[nodiscard]] inline int GetInt(Key key) {
+	return GetCached(key);
+}
+
+[[nodiscard]] inline rpl::producer<QString> Events(Key key) {
+	return Events(KeyName(key));
+}
+
 inline bool GetBool(
 	const QString &key,
 	uint64 accountId = 0,
@@ -585,6 +585,8 @@ void writeMtp(int32 dc, const QString &v) {
 			return base + "_export";
 		} else if (shift == MTP::kExportMediaDcShift) {
 			return base + "_export_download";
+		} else if (shift == MTP::kExportPreloadDcShift) {
+			return base + "_export_preload";
 		} else if (shift == MTP::kConfigDcShift) {
 			return base + "_config_enumeration";
 		} else if (shift == MTP::kLogoutDcShift) {
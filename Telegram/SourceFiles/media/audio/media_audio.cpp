@@ -199,14 +199,18 @@ void Start(not_null<Instance*> instance) {
 	LOG(("OpenAL Logging Level: %1").arg(loglevel ? loglevel : "(not set)"));
 
 	OpenAL::LoadEFXExtension();
-	EnumeratePlaybackDevices();
-	EnumerateCaptureDevices();
 
 	MixerInstance = new Player::Mixer(instance);
 
 	Platform::Audio::Init();
 }
 
+// Thread: Main.
+void LogDevices() {
+	EnumeratePlaybackDevices();
+	EnumerateCaptureDevices();
+}
+
 // Thread: Main.
 void Finish(not_null<Instance*> instance) {
 	Platform::Audio::DeInit();
@@ -36,6 +36,9 @@ class Instance;
 void Start(not_null<Instance*> instance);
 void Finish(not_null<Instance*> instance);
 
+// Thread: Main. Enumerates the devices after Start, traced separately.
+void LogDevices();
+
 // Thread: Main. Locks: AudioMutex.
 bool IsAttachedToDevice();
 
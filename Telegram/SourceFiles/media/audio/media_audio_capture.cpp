@@ -44,11 +44,16 @@ public:
 	Inner(QThread *thread);
 	~Inner();
 
-	void start(Fn<void(Update)> updated, Fn<void()> error);
+	void start(
+		Fn<void(Update)> updated,
+		Fn<void()> error,
+		Fn<void(QByteArray)> streamed,
+		int streamPartSize);
 	void stop(Fn<void(Result&&)> callback = nullptr);
 
 private:
 	void process();
+	void pushStreamedParts();
 
 	[[nodiscard]] bool processFrame(int32 offset, int32 framesize);
 	void fail();
@@ -61,6 +66,7 @@ private:
 
 	Fn<void(Update)> _updated;
 	Fn<void()> _error;
+	Fn<void(QByteArray)> _streamed;
 
 	struct Private;
 	const std::unique_ptr<Private> d;
@@ -84,7 +90,7 @@ Instance::Instance() : _inner(std::make_unique<Inner>(&_thread)) {
 	_thread.start();
 }
 
-void Instance::start() {
+void Instance::start(int streamPartSize) {
 	_updates.fire_done();
 	InvokeQueued(_inner.get(), [=] {
 		_inner->start([=](Update update) {
@@ -95,7 +101,11 @@ void Instance::start() {
 			crl::on_main(this, [=] {
 				_updates.fire_error({});
 			});
-		});
+		}, [=](QByteArray part) {
+			crl::on_main(this, [=, part = std::move(part)]() mutable {
+				_streamedParts.fire(std::move(part));
+			});
+		}, streamPartSize);
 		crl::on_main(this, [=] {
 			_started = true;
 		});
@@ -167,6 +177,10 @@ struct Instance::Inner::Private {
 	QByteArray data;
 	int32 dataPos = 0;
 
+	int32 streamPartSize = 0;
+	int32 streamedSize = 0;
+	bool streamedBroken = false;
+
 	int64 waveformMod = 0;
 	int64 waveformEach = (kCaptureFrequency / 100);
 	uint16 waveformPeak = 0;
@@ -189,6 +203,10 @@ struct Instance::Inner::Private {
 		auto l = reinterpret_cast<Private*>(opaque);
 
 		if (buf_size <= 0) return 0;
+		if (l->dataPos < l->streamedSize) {
+			// Rewriting the already streamed bytes.
+			l->streamedBroken = true;
+		}
 		if (l->dataPos + buf_size > l->data.size()) l->data.resize(l->dataPos + buf_size);
 		memcpy(l->data.data() + l->dataPos, buf, buf_size);
 		l->dataPos += buf_size;
@@ -233,9 +251,17 @@ void Instance::Inner::fail() {
 	}
 }
 
-void Instance::Inner::start(Fn<void(Update)> updated, Fn<void()> error) {
+void Instance::Inner::start(
+		Fn<void(Update)> updated,
+		Fn<void()> error,
+		Fn<void(QByteArray)> streamed,
+		int streamPartSize) {
 	_updated = std::move(updated);
 	_error = std::move(error);
+	_streamed = std::move(streamed);
+	d->streamPartSize = streamPartSize;
+	d->streamedSize = 0;
+	d->streamedBroken = false;
 
 	// Start OpenAL Capture
 	d->device = alcCaptureOpenDevice(nullptr, kCaptureFrequency, AL_FORMAT_MONO16, kCaptureFrequency / 5);
@@ -452,6 +478,10 @@ void Instance::Inner::stop(Fn<void(Result&&)> callback) {
 	}
 
 	QByteArray result = d->fullSamples ? d->data : QByteArray();
+	const auto streamed = (d->streamPartSize > 0)
+		&& (d->streamedSize > 0)
+		&& !d->streamedBroken
+		&& (result.size() >= d->streamedSize);
 	VoiceWaveform waveform;
 	qint32 samples = d->fullSamples;
 	if (needResult && samples && !d->waveform.isEmpty()) {
@@ -530,13 +560,17 @@ void Instance::Inner::stop(Fn<void(Result&&)> callback) {
 		d->dataPos = 0;
 		d->data.clear();
 
+		d->streamPartSize = 0;
+		d->streamedSize = 0;
+		d->streamedBroken = false;
+
 		d->waveformMod = 0;
 		d->waveformPeak = 0;
 		d->waveform.clear();
 	}
 
 	if (needResult) {
-		callback({ result, waveform, samples });
+		callback({ result, waveform, samples, streamed });
 	}
 }
 
@@ -606,11 +640,23 @@ void Instance::Inner::process() {
 			memmove(_captured.data(), _captured.constData() + encoded, goodSize);
 			_captured.resize(goodSize);
 		}
+
+		pushStreamedParts();
 	} else {
 		DEBUG_LOG(("Audio Capture: no samples to capture."));
 	}
 }
 
+void Instance::Inner::pushStreamedParts() {
+	if (!d->streamPartSize || d->streamedBroken || !_streamed) {
+		return;
+	}
+	while (d->data.size() - d->streamedSize >= d->streamPartSize) {
+		_streamed(d->data.mid(d->streamedSize, d->streamPartSize));
+		d->streamedSize += d->streamPartSize;
+	}
+}
+
 bool Instance::Inner::processFrame(int32 offset, int32 framesize) {
 	// Prepare audio frame
 
@@ -23,6 +23,10 @@ struct Result {
 	QByteArray bytes;
 	VoiceWaveform waveform;
 	int samples = 0;
+
+	// True if the streamedParts() events of this recording form
+	// a prefix of the bytes, so they don't need to be uploaded again.
+	bool streamed = false;
 };
 
 void Start();
@@ -46,7 +50,13 @@ public:
 		return _started.changes();
 	}
 
-	void start();
+	[[nodiscard]] rpl::producer<QByteArray> streamedParts() const {
+		return _streamedParts.events();
+	}
+
+	// With nonzero streamPartSize the encoded data is also fired in
+	// streamedParts() by pieces of that size while recording goes on.
+	void start(int streamPartSize = 0);
 	void stop(Fn<void(Result&&)> callback = nullptr);
 
 private:
@@ -56,6 +66,7 @@ private:
 	bool _available = false;
 	rpl::variable<bool> _started = false;;
 	rpl::event_stream<Update, rpl::empty_error> _updates;
+	rpl::event_stream<QByteArray> _streamedParts;
 	QThread _thread;
 	std::unique_ptr<Inner> _inner;
 
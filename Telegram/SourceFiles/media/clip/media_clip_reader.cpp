@@ -34,6 +34,38 @@ namespace {
 constexpr auto kClipThreadsCount = 8;
 constexpr auto kAverageGifSize = 320 * 240;
 constexpr auto kWaitBeforeGifPause = crl::time(200);
+constexpr auto kLateFrameThreshold = crl::time(20);
+
+struct DecodeStats {
+	std::atomic<int> queued = 0;
+	std::atomic<int> maxQueued = 0;
+	std::atomic<int> frames = 0;
+	std::atomic<int> lateFrames = 0;
+	std::atomic<crl::time> maxLateness = 0;
+};
+
+DecodeStats Stats;
+
+template <typename Type>
+void UpdateMax(std::atomic<Type> &value, Type candidate) {
+	auto current = value.load(std::memory_order_relaxed);
+	while (current < candidate
+		&& !value.compare_exchange_weak(
+			current,
+			candidate,
+			std::memory_order_relaxed)) {
+	}
+}
+
+void CountDecodeStarted(crl::time lateness) {
+	const auto queued = Stats.queued.fetch_sub(1, std::memory_order_relaxed);
+	UpdateMax(Stats.maxQueued, queued);
+	Stats.frames.fetch_add(1, std::memory_order_relaxed);
+	if (lateness > kLateFrameThreshold) {
+		Stats.lateFrames.fetch_add(1, std::memory_order_relaxed);
+	}
+	UpdateMax(Stats.maxLateness, lateness);
+}
 
 QImage PrepareFrameImage(const FrameRequest &request, const QImage &original, bool hasAlpha, QImage &cache) {
 	const auto needResize = (original.size() != request.frame);
@@ -145,6 +177,11 @@ private:
 	};
 	ResultHandleState handleResult(ReaderPrivate *reader, ProcessResult result, crl::time ms);
 
+	// Decodes the next frame in the shared crl::async() pool,
+	// the reader is skipped by process() until the frame is ready.
+	void decode(ReaderPrivate *reader);
+	std::atomic<int> _decodingCount = 0;
+
 	using Readers = QMap<ReaderPrivate*, crl::time>;
 	Readers _readers;
 
@@ -664,6 +701,10 @@ private:
 	bool _started = false;
 	crl::time _videoPausedAtMs = 0;
 
+	bool _decoding = false;
+	std::atomic<bool> _decoded = false;
+	ProcessResult _decodedResult = ProcessResult::Wait;
+
 	friend class Manager;
 
 };
@@ -826,12 +867,31 @@ Manager::ResultHandleState Manager::handleResult(ReaderPrivate *reader, ProcessR
 				reader->_frame = index;
 			}
 		}
-		return handleResult(reader, reader->finishProcess(ms), ms);
+		decode(reader);
 	}
 
 	return ResultHandleContinue;
 }
 
+void Manager::decode(ReaderPrivate *reader) {
+	Expects(!reader->_decoding);
+
+	reader->_decoding = true;
+	reader->_decoded.store(false, std::memory_order_relaxed);
+	_decodingCount.fetch_add(1, std::memory_order_relaxed);
+	Stats.queued.fetch_add(1, std::memory_order_relaxed);
+
+	const auto due = reader->_nextFrameWhen;
+	crl::async([=] {
+		const auto now = crl::now();
+		CountDecodeStarted(now - due);
+		reader->_decodedResult = reader->finishProcess(now);
+		reader->_decoded.store(true, std::memory_order_release);
+		InvokeQueued(this, [=] { process(); });
+		_decodingCount.fetch_sub(1, std::memory_order_release);
+	});
+}
+
 void Manager::process() {
 	if (_processingInThread) {
 		_needReProcess = true;
@@ -846,7 +906,9 @@ void Manager::process() {
 	{
 		QMutexLocker lock(&_readerPointersMutex);
 		for (auto it = _readerPointers.begin(), e = _readerPointers.end(); it != e; ++it) {
-			if (it->loadAcquire() && it.key()->_private != nullptr) {
+			if (it->loadAcquire()
+				&& it.key()->_private != nullptr
+				&& !it.key()->_private->_decoding) {
 				auto i = _readers.find(it.key()->_private);
 				if (i == _readers.cend()) {
 					_readers.insert(it.key()->_private, 0);
@@ -871,14 +933,26 @@ void Manager::process() {
 
 	for (auto i = _readers.begin(), e = _readers.end(); i != e;) {
 		ReaderPrivate *reader = i.key();
-		if (i.value() <= ms) {
-			ResultHandleState state = handleResult(reader, reader->process(ms), ms);
+		if (reader->_decoding
+			&& !reader->_decoded.load(std::memory_order_acquire)) {
+			++i;
+			continue;
+		}
+		const auto decoded = base::take(reader->_decoding);
+		if (decoded || i.value() <= ms) {
+			const auto result = decoded
+				? reader->_decodedResult
+				: reader->process(ms);
+			ResultHandleState state = handleResult(reader, result, ms);
 			if (state == ResultHandleRemove) {
 				i = _readers.erase(i);
 				continue;
 			} else if (state == ResultHandleStop) {
 				_processingInThread = nullptr;
 				return;
+			} else if (reader->_decoding) {
+				++i;
+				continue;
 			}
 			ms = crl::now();
 			if (reader->_videoPausedAtMs) {
@@ -921,6 +995,9 @@ void Manager::finish() {
 }
 
 void Manager::clear() {
+	while (_decodingCount.load(std::memory_order_acquire) > 0) {
+		QThread::yieldCurrentThread();
+	}
 	{
 		QMutexLocker lock(&_readerPointersMutex);
 		for (auto it = _readerPointers.begin(), e = _readerPointers.end(); it != e; ++it) {
@@ -979,6 +1056,13 @@ Ui::PreparedFileInformation::Video PrepareForSending(const QString &fname, const
 
 void Finish() {
 	Workers.clear();
+
+	DEBUG_LOG(("Clip Info: "
+		"%1 frames decoded, %2 late, max lateness %3 ms, max queue %4."
+		).arg(Stats.frames.load()
+		).arg(Stats.lateFrames.load()
+		).arg(Stats.maxLateness.load()
+		).arg(Stats.maxQueued.load()));
 }
 
 Reader *const ReaderPointer::BadPointer = reinterpret_cast<Reader*>(1);
@@ -18,6 +18,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/audio/media_audio_capture.h"
 #include "media/streaming/media_streaming_instance.h"
 #include "media/streaming/media_streaming_player.h"
+#include "media/streaming/media_streaming_prefetch.h"
+#include "media/streaming/media_streaming_reader.h"
 #include "media/view/media_view_playback_progress.h"
 #include "calls/calls_instance.h"
 #include "history/history.h"
@@ -51,6 +53,9 @@ constexpr auto kRememberShuffledOrderItems = 16;
 
 constexpr auto kMinLengthForSavePosition = 20 * TimeId(60); // 20 minutes.
 
+// Read that much of the next song while the current one is playing.
+constexpr auto kPrefetchNextSize = 4 * 1024 * 1024;
+
 auto VoicePlaybackSpeed() {
 	return std::clamp(Core::App().settings().voicePlaybackSpeed(), 0.6, 1.7);
 }
@@ -65,10 +70,22 @@ struct Instance::Streamed {
 	AudioMsgId id;
 	Streaming::Instance instance;
 	View::PlaybackProgress progress;
+	bool receivedTillEnd = false;
 	bool clearing = false;
 	rpl::lifetime lifetime;
 };
 
+struct Instance::Prefetched {
+	Prefetched(
+		not_null<DocumentData*> document,
+		std::shared_ptr<Streaming::Document> shared,
+		std::shared_ptr<Streaming::Reader> reader);
+
+	not_null<DocumentData*> document;
+	std::shared_ptr<Streaming::Document> shared;
+	Streaming::Prefetch prefetch;
+};
+
 struct Instance::ShuffleData {
 	using UniversalMsgId = MsgId;
 
@@ -79,6 +96,7 @@ struct Instance::ShuffleData {
 	History *migrated = nullptr;
 	bool scheduled = false;
 	int indexInPlayedIds = 0;
+	UniversalMsgId nextPicked = 0;
 	bool allLoaded = false;
 	rpl::lifetime nextSliceLifetime;
 	rpl::lifetime lifetime;
@@ -123,6 +141,15 @@ Instance::Streamed::Streamed(
 , instance(std::move(document), nullptr) {
 }
 
+Instance::Prefetched::Prefetched(
+	not_null<DocumentData*> document,
+	std::shared_ptr<Streaming::Document> shared,
+	std::shared_ptr<Streaming::Reader> reader)
+: document(document)
+, shared(std::move(shared))
+, prefetch(std::move(reader), kPrefetchNextSize) {
+}
+
 Instance::Data::Data(AudioMsgId::Type type, SharedMediaType overview)
 : type(type)
 , overview(overview) {
@@ -313,6 +340,7 @@ void Instance::playlistUpdated(not_null<Data*> data) {
 		data->shuffleData = nullptr;
 	}
 	data->playlistChanges.fire({});
+	prefetchNext(data);
 }
 
 bool Instance::validPlaylist(not_null<const Data*> data) const {
@@ -541,10 +569,30 @@ bool Instance::moveInPlaylist(
 		} else if (raw->indexInPlayedIds < raw->playedIds.size()) {
 			++raw->indexInPlayedIds;
 		}
-		const auto index = base::RandomIndex(raw->nonPlayedIds.size());
+		// Use the item that was chosen for prefetch if it is still there.
+		const auto picked = ranges::find(
+			raw->nonPlayedIds,
+			base::take(raw->nextPicked));
+		const auto index = (picked != end(raw->nonPlayedIds)
+			&& *picked != universal)
+			? int(picked - begin(raw->nonPlayedIds))
+			: base::RandomIndex(raw->nonPlayedIds.size());
 		return byUniversal(raw->nonPlayedIds[index]);
 	}
 
+	if (const auto item = itemInPlaylistOrder(data, delta)) {
+		return jumpByItem(item);
+	}
+	return false;
+}
+
+HistoryItem *Instance::itemInPlaylistOrder(
+		not_null<Data*> data,
+		int delta) {
+	if (!data->playlistIndex) {
+		return nullptr;
+	}
+	const auto repeatAll = (repeat(data) == RepeatMode::All);
 	const auto newIndex = *data->playlistIndex
 		+ (order(data) == OrderMode::Reverse ? -delta : delta);
 	const auto useIndex = (!repeatAll
@@ -556,18 +604,89 @@ bool Instance::moveInPlaylist(
 		: ((newIndex + int(data->playlistSlice->size()))
 			% int(data->playlistSlice->size()));
 	if (const auto item = itemByIndex(data, useIndex)) {
-		return jumpByItem(item);
+		return item;
 	} else if (repeatAll
 		&& data->playlistOtherSlice
 		&& data->playlistOtherSlice->size() > 0) {
 		const auto &other = *data->playlistOtherSlice;
 		if (newIndex < 0 && other.skippedAfter() == 0) {
-			return jumpById(other[other.size() - 1]);
+			return data->history->owner().message(other[other.size() - 1]);
 		} else if (newIndex > 0 && other.skippedBefore() == 0) {
-			return jumpById(other[0]);
+			return data->history->owner().message(other[0]);
 		}
 	}
-	return false;
+	return nullptr;
+}
+
+HistoryItem *Instance::nextShuffledItem(not_null<Data*> data) {
+	const auto raw = data->shuffleData.get();
+	if (!raw || !raw->history) {
+		return nullptr;
+	}
+	const auto universal = computeCurrentUniversalId(data);
+	auto id = ShuffleData::UniversalMsgId();
+	if (raw->indexInPlayedIds + 1 < raw->playedIds.size()) {
+		id = raw->playedIds[raw->indexInPlayedIds + 1];
+	} else {
+		// Choose the random next item now, moveInPlaylist() will use it.
+		const auto picked = raw->nextPicked;
+		if (!picked
+			|| picked == universal
+			|| !ranges::contains(raw->nonPlayedIds, picked)) {
+			auto candidates = raw->nonPlayedIds;
+			candidates.erase(
+				ranges::remove(candidates, universal),
+				end(candidates));
+			if (candidates.empty()) {
+				return nullptr;
+			}
+			raw->nextPicked = candidates[
+				base::RandomIndex(candidates.size())];
+		}
+		id = raw->nextPicked;
+	}
+	const auto fullId = (id < 0 && raw->migrated)
+		? FullMsgId(raw->migrated->peer->id, id + ServerMaxMsgId)
+		: FullMsgId(raw->history->peer->id, id);
+	return raw->history->owner().message(fullId);
+}
+
+void Instance::prefetchNext(not_null<Data*> data) {
+	if (data->type != AudioMsgId::Type::Song
+		|| !data->streamed
+		|| !data->streamed->receivedTillEnd
+		|| repeat(data) == RepeatMode::One) {
+		return;
+	}
+	const auto item = (order(data) == OrderMode::Shuffle)
+		? nextShuffledItem(data)
+		: itemInPlaylistOrder(data, 1);
+	const auto media = item ? item->media() : nullptr;
+	const auto document = media ? media->document() : nullptr;
+	if (!document
+		|| !document->isAudioFile()
+		|| document == data->current.audio()) {
+		data->prefetched = nullptr;
+		return;
+	} else if (data->prefetched && data->prefetched->document == document) {
+		return;
+	}
+	data->prefetched = nullptr;
+
+	auto &streaming = document->owner().streaming();
+	auto shared = streaming.sharedDocument(document, item->fullId());
+	auto reader = shared
+		? streaming.sharedReader(document, item->fullId())
+		: nullptr;
+	if (!reader) {
+		return;
+	}
+	DEBUG_LOG(("Audio Player: prefetching %1 of the next song."
+		).arg(std::min(kPrefetchNextSize, reader->size())));
+	data->prefetched = std::make_unique<Prefetched>(
+		document,
+		std::move(shared),
+		std::move(reader));
 }
 
 void Instance::updatePowerSaveBlocker(
@@ -788,6 +907,13 @@ void Instance::playStreamed(
 	const auto data = getData(audioId.type());
 	Assert(data != nullptr);
 
+	// Let the prefetched song continue from the already read data.
+	if (const auto prefetched = base::take(data->prefetched)) {
+		if (prefetched->document == audioId.audio()) {
+			prefetched->prefetch.handOver();
+		}
+	}
+
 	clearStreamed(data, data->current.audio() != audioId.audio());
 	data->streamed = std::make_unique<Streamed>(
 		audioId,
@@ -846,6 +972,7 @@ void Instance::stop(AudioMsgId::Type type) {
 		if (data->streamed) {
 			clearStreamed(data);
 		}
+		data->prefetched = nullptr;
 		data->resumeOnCallEnd = false;
 		_playerStopped.fire_copy({type});
 	}
@@ -1279,6 +1406,15 @@ void Instance::handleStreamingUpdate(
 		emitUpdate(data->type);
 	}, [&](PreloadedAudio &update) {
 		//emitUpdate(data->type, [](AudioMsgId) { return true; });
+		const auto streamed = data->streamed.get();
+		const auto duration = streamed->instance.info().audio.state.duration;
+		if (!streamed->receivedTillEnd
+			&& duration != kTimeUnknown
+			&& update.till >= duration) {
+			// Don't compete with the current song for the bandwidth.
+			streamed->receivedTillEnd = true;
+			prefetchNext(data);
+		}
 	}, [&](UpdateAudio &update) {
 		emitUpdate(data->type);
 	}, [&](WaitingForData) {
@@ -171,6 +171,7 @@ private:
 	using SharedMediaType = Storage::SharedMediaType;
 	using SliceKey = SparseIdsMergedSlice::Key;
 	struct Streamed;
+	struct Prefetched;
 	struct ShuffleData;
 	struct Data {
 		Data(AudioMsgId::Type type, SharedMediaType overview);
@@ -198,6 +199,7 @@ private:
 		bool isPlaying = false;
 		bool resumeOnCallEnd = false;
 		std::unique_ptr<Streamed> streamed;
+		std::unique_ptr<Prefetched> prefetched;
 		std::unique_ptr<ShuffleData> shuffleData;
 		std::unique_ptr<base::PowerSaveBlocker> powerSaveBlocker;
 		std::unique_ptr<base::PowerSaveBlocker> powerSaveBlockerVideo;
@@ -240,6 +242,9 @@ private:
 	void validateOtherPlaylist(not_null<Data*> data);
 	void playlistUpdated(not_null<Data*> data);
 	bool moveInPlaylist(not_null<Data*> data, int delta, bool autonext);
+	HistoryItem *itemInPlaylistOrder(not_null<Data*> data, int delta);
+	HistoryItem *nextShuffledItem(not_null<Data*> data);
+	void prefetchNext(not_null<Data*> data);
 	void updatePowerSaveBlocker(
 		not_null<Data*> data,
 		const TrackState &state);
@@ -32,6 +32,38 @@ constexpr auto kMaxQueuedPackets = 1024;
 		).split(QChar(',')).contains(u"webm");
 }
 
+[[nodiscard]] std::vector<int> CollectSeekPoints(
+		not_null<AVFormatContext*> format,
+		const Stream &stream) {
+	const auto info = format->streams[stream.index];
+#if LIBAVFORMAT_VERSION_INT >= AV_VERSION_INT(58, 78, 100)
+	const auto count = avformat_index_get_entries_count(info);
+	const auto entry = [&](int index) {
+		return avformat_index_get_entry(info, index);
+	};
+#else // LIBAVFORMAT_VERSION_INT >= 58.78.100
+	const auto count = info->nb_index_entries;
+	const auto entry = [&](int index) {
+		return &info->index_entries[index];
+	};
+#endif // LIBAVFORMAT_VERSION_INT >= 58.78.100
+
+	auto result = std::vector<int>();
+	result.reserve(count);
+	for (auto i = 0; i != count; ++i) {
+		const auto point = entry(i);
+		if (point
+			&& (point->flags & AVINDEX_KEYFRAME)
+			&& point->pos >= 0
+			&& point->pos <= std::numeric_limits<int>::max()) {
+			result.push_back(int(point->pos));
+		}
+	}
+	ranges::sort(result);
+	result.erase(ranges::unique(result), end(result));
+	return result;
+}
+
 } // namespace
 
 File::Context::Context(
@@ -294,6 +326,17 @@ void File::Context::start(crl::time position) {
 	if (_reader->isRemoteLoader()) {
 		sendFullInCache(true);
 	}
+	if (const auto &main = video.codec ? video : audio; main.codec) {
+		const auto durationKnown = [](const Stream &stream) {
+			return stream.codec && (stream.duration != kDurationUnavailable);
+		};
+		const auto duration = std::max(
+			durationKnown(video) ? video.duration : crl::time(0),
+			durationKnown(audio) ? audio.duration : crl::time(0));
+		_reader->setPlaybackInfo(
+			duration,
+			CollectSeekPoints(format.get(), main));
+	}
 	if (video.codec || audio.codec) {
 		seekToPosition(format.get(), video.codec ? video : audio, position);
 	}
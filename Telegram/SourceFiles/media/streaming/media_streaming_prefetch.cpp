@@ -0,0 +1,71 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "media/streaming/media_streaming_prefetch.h"
+
+#include "media/streaming/media_streaming_reader.h"
+#include "base/bytes.h"
+
+namespace Media {
+namespace Streaming {
+namespace {
+
+constexpr auto kReadBlockSize = 64 * 1024;
+
+} // namespace
+
+Prefetch::Prefetch(std::shared_ptr<Reader> reader, int size)
+: _reader(std::move(reader))
+, _size(std::clamp(size, 0, _reader->size())) {
+	_reader->startStreaming();
+	_thread = std::thread([=] {
+		auto buffer = bytes::vector(kReadBlockSize);
+		auto offset = 0;
+		while (offset < _size && !_interrupted) {
+			const auto amount = std::min(kReadBlockSize, _size - offset);
+			const auto result = _reader->fill(
+				offset,
+				bytes::make_span(buffer).subspan(0, amount),
+				&_semaphore);
+			if (result == Reader::FillState::Success) {
+				offset += amount;
+			} else if (result == Reader::FillState::Failed) {
+				break;
+			} else {
+				_semaphore.acquire();
+			}
+		}
+		if (!_interrupted) {
+			// Don't throttle other downloads while nobody plays it.
+			_reader->stopStreamingAsync();
+		}
+	});
+}
+
+void Prefetch::handOver() {
+	stop(true);
+}
+
+void Prefetch::stop(bool stillActive) {
+	if (_stopped) {
+		return;
+	}
+	_stopped = true;
+	if (_thread.joinable()) {
+		_interrupted = true;
+		_semaphore.release();
+		_thread.join();
+	}
+	_reader->stopStreaming(stillActive);
+}
+
+Prefetch::~Prefetch() {
+	stop(false);
+}
+
+} // namespace Streaming
+} // namespace Media
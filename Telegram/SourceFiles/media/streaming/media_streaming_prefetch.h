@@ -0,0 +1,44 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include <thread>
+
+namespace Media {
+namespace Streaming {
+
+class Reader;
+
+// Reads the beginning of a file through its shared Reader before any
+// File uses it, so that opening the file later doesn't wait for data.
+class Prefetch final {
+public:
+	Prefetch(std::shared_ptr<Reader> reader, int size);
+
+	Prefetch(const Prefetch &other) = delete;
+	Prefetch &operator=(const Prefetch &other) = delete;
+
+	// Stops reading and leaves the reader active for a File to start.
+	void handOver();
+
+	~Prefetch();
+
+private:
+	void stop(bool stillActive);
+
+	const std::shared_ptr<Reader> _reader;
+	const int _size = 0;
+	crl::semaphore _semaphore;
+	std::atomic<bool> _interrupted = false;
+	std::thread _thread;
+	bool _stopped = false;
+
+};
+
+} // namespace Streaming
+} // namespace Media
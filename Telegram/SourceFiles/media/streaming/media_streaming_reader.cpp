@@ -10,6 +10,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/streaming/media_streaming_common.h"
 #include "media/streaming/media_streaming_loader.h"
 #include "storage/cache/storage_cache_database.h"
+#include "kotato/kotato_settings.h"
 
 namespace Media {
 namespace Streaming {
@@ -21,12 +22,19 @@ constexpr auto kInSlice = kPartsInSlice * kPartSize;
 constexpr auto kMaxPartsInHeader = 64;
 constexpr auto kMaxOnlyInHeader = 80 * kPartSize;
 constexpr auto kPartsOutsideFirstSliceGood = 8;
-constexpr auto kSlicesInMemory = 2;
 
-// 1 MB of parts are requested from cloud ahead of reading demand.
+// At least 1 MB of parts are requested from cloud ahead of reading demand.
+// With a known bitrate it is extended up to a slice for kPreloadDuration.
 constexpr auto kPreloadPartsAhead = 8;
+constexpr auto kPreloadPartsAheadMax = kPartsInSlice;
+constexpr auto kPreloadDuration = 10 * crl::time(1000);
 constexpr auto kDownloaderRequestsLimit = 4;
 
+// When nothing else is loading the first parts of keyframes a bit after
+// the preloaded range are requested, so short seeks start faster.
+constexpr auto kSeekPointsPrefetch = 4;
+constexpr auto kSeekPrefetchDuration = 30 * crl::time(1000);
+
 using PartsMap = base::flat_map<int, QByteArray>;
 
 struct ParsedCacheEntry {
@@ -67,6 +75,18 @@ int MaxSliceSize(int sliceNumber, int size) {
 		: kInSlice;
 }
 
+int RoundUpToPart(int size) {
+	return ((size + kPartSize - 1) / kPartSize) * kPartSize;
+}
+
+int PreloadPartsByBitrate(int64 bytesPerSecond) {
+	const auto bytes = bytesPerSecond * kPreloadDuration / 1000;
+	return int(std::clamp(
+		(bytes + kPartSize - 1) / kPartSize,
+		int64(kPreloadPartsAhead),
+		int64(kPreloadPartsAheadMax)));
+}
+
 bytes::const_span ParseComplexCachedMap(
 		PartsMap &result,
 		bytes::const_span data,
@@ -262,14 +282,20 @@ void Reader::Slice::addPart(int offset, QByteArray bytes) {
 	}
 }
 
-auto Reader::Slice::prepareFill(int from, int till) -> PrepareFillResult {
+auto Reader::Slice::prepareFill(
+	int from,
+	int till,
+	int preloadParts,
+	int preloadLimit)
+-> PrepareFillResult {
 	auto result = PrepareFillResult();
 
 	result.ready = false;
 	const auto fromOffset = (from / kPartSize) * kPartSize;
 	const auto tillPart = (till + kPartSize - 1) / kPartSize;
-	const auto preloadTillOffset = (tillPart + kPreloadPartsAhead)
-		* kPartSize;
+	const auto preloadTillOffset = std::max(
+		std::min((tillPart + preloadParts) * kPartSize, preloadLimit),
+		tillPart * kPartSize);
 
 	const auto after = ranges::upper_bound(
 		parts,
@@ -333,7 +359,10 @@ auto Reader::Slice::offsetsFromLoader(int from, int till) const
 }
 
 Reader::Slices::Slices(int size, bool useCache)
-: _size(size) {
+: _slicesInMemory(::Kotato::JsonSettings::GetInt(
+	::Kotato::JsonSettings::Key::StreamingSlicesInMemory))
+, _preloadParts(kPreloadPartsAhead)
+, _size(size) {
 	Expects(size > 0);
 
 	if (useCache) {
@@ -381,6 +410,13 @@ void Reader::Slices::headerDone(bool fromCache) {
 	}
 }
 
+void Reader::Slices::setPreloadParts(int count) {
+	_preloadParts = std::clamp(
+		count,
+		kPreloadPartsAhead,
+		kPreloadPartsAheadMax);
+}
+
 int Reader::Slices::headerSize() const {
 	return _header.parts.size() * kPartSize;
 }
@@ -565,11 +601,6 @@ auto Reader::Slices::fill(int offset, bytes::span buffer) -> FillResult {
 		&& (fromSlice + 1 == tillSlice || fromSlice + 2 == tillSlice)
 		&& tillSlice <= _data.size());
 
-	const auto cacheNotLoaded = [&](int sliceIndex) {
-		return (_headerMode != HeaderMode::NoCache)
-			&& (_headerMode != HeaderMode::Unknown)
-			&& !(_data[sliceIndex].flags & Flag::LoadedFromCache);
-	};
 	const auto handlePrepareResult = [&](
 			int sliceIndex,
 			const Slice::PrepareFillResult &prepared) {
@@ -596,14 +627,41 @@ auto Reader::Slices::fill(int offset, bytes::span buffer) -> FillResult {
 	const auto firstTill = std::min(kInSlice, till - fromSlice * kInSlice);
 	const auto secondFrom = 0;
 	const auto secondTill = till - (fromSlice + 1) * kInSlice;
-	const auto first = _data[fromSlice].prepareFill(firstFrom, firstTill);
+	const auto preloadLimit = [&](int sliceIndex) {
+		return RoundUpToPart(maxSliceSize(sliceIndex + 1));
+	};
+	const auto first = _data[fromSlice].prepareFill(
+		firstFrom,
+		firstTill,
+		_preloadParts,
+		preloadLimit(fromSlice));
 	const auto second = (fromSlice + 1 < tillSlice)
-		? _data[fromSlice + 1].prepareFill(secondFrom, secondTill)
+		? _data[fromSlice + 1].prepareFill(
+			secondFrom,
+			secondTill,
+			_preloadParts,
+			preloadLimit(fromSlice + 1))
 		: Slice::PrepareFillResult();
 	handlePrepareResult(fromSlice, first);
 	if (fromSlice + 1 < tillSlice) {
 		handlePrepareResult(fromSlice + 1, second);
 	}
+
+	// Continue the preload into the next slice if it was already read.
+	const auto preloadTill = RoundUpToPart(till)
+		+ _preloadParts * kPartSize;
+	const auto nextSlice = tillSlice;
+	if (nextSlice < int(_data.size())
+		&& preloadTill > nextSlice * kInSlice
+		&& !cacheNotLoaded(nextSlice)) {
+		handlePrepareResult(
+			nextSlice,
+			_data[nextSlice].prepareFill(
+				0,
+				0,
+				(preloadTill - nextSlice * kInSlice) / kPartSize,
+				preloadLimit(nextSlice)));
+	}
 	if (first.ready && second.ready) {
 		markSliceUsed(fromSlice);
 		CopyLoaded(
@@ -636,7 +694,11 @@ auto Reader::Slices::fillFromHeader(int offset, bytes::span buffer)
 	const auto from = offset;
 	const auto till = int(offset + buffer.size());
 
-	const auto prepared = _header.prepareFill(from, till);
+	const auto prepared = _header.prepareFill(
+		from,
+		till,
+		_preloadParts,
+		RoundUpToPart(_size));
 	for (const auto full : prepared.offsetsFromLoader.values()) {
 		if (full < _size) {
 			result.offsetsFromLoader.add(full);
@@ -667,6 +729,27 @@ QByteArray Reader::Slices::partForDownloader(int offset) const {
 	return (i != end(slice.parts)) ? i->second : QByteArray();
 }
 
+bool Reader::Slices::cacheNotLoaded(int sliceIndex) const {
+	return (_headerMode != HeaderMode::NoCache)
+		&& (_headerMode != HeaderMode::Unknown)
+		&& !(_data[sliceIndex].flags & Slice::Flag::LoadedFromCache);
+}
+
+bool Reader::Slices::prefetchRequired(int offset) const {
+	Expects(offset < _size);
+
+	if (_headerMode == HeaderMode::Unknown) {
+		return false;
+	} else if (_header.parts.contains(offset)) {
+		return false;
+	} else if (isFullInHeader()) {
+		return true;
+	}
+	const auto index = offset / kInSlice;
+	return !cacheNotLoaded(index)
+		&& !_data[index].parts.contains(offset - index * kInSlice);
+}
+
 bool Reader::Slices::waitingForHeaderCache() const {
 	return (_header.flags & Slice::Flag::LoadingFromCache);
 }
@@ -704,7 +787,7 @@ Reader::SerializedSlice Reader::Slices::serializeAndUnloadUnused() {
 	using Flag = Slice::Flag;
 
 	if (_headerMode == HeaderMode::Unknown
-		|| _usedSlices.size() <= kSlicesInMemory) {
+		|| int(_usedSlices.size()) <= _slicesInMemory) {
 		return {};
 	}
 	const auto purgeSlice = _usedSlices.front();
@@ -910,6 +993,11 @@ void Reader::stopStreaming(bool stillActive) {
 
 	_stopStreamingAsync = false;
 	_waiting.store(nullptr, std::memory_order_release);
+	if (_cacheHelper && _cacheHelper->waiting != nullptr) {
+		// The waiting semaphore may be destroyed right after this call.
+		QMutexLocker lock(&_cacheHelper->mutex);
+		_cacheHelper->waiting.store(nullptr, std::memory_order_release);
+	}
 	if (!stillActive) {
 		_streamingActive = false;
 		refreshLoaderPriority();
@@ -1248,14 +1336,75 @@ Reader::FillState Reader::fill(
 	do {
 		lastResult = fillFromSlices(offset, buffer);
 		if (lastResult == FillState::Success) {
+			countStall(lastResult);
+			prefetchSeekPoints(offset + int(buffer.size()));
 			return done();
 		}
 		startWaiting();
 	} while (checkForSomethingMoreReceived());
 
+	countStall(lastResult);
 	return _streamingError ? failed() : lastResult;
 }
 
+void Reader::setPlaybackInfo(
+		crl::time duration,
+		std::vector<int> &&seekPoints) {
+	if (duration > 0 && duration <= kDurationMax) {
+		_bytesPerSecond = int64(size()) * 1000 / duration;
+		_slices.setPreloadParts(PreloadPartsByBitrate(_bytesPerSecond));
+	}
+	_seekPoints = std::move(seekPoints);
+}
+
+void Reader::prefetchSeekPoints(int offset) {
+	if (_seekPoints.empty()
+		|| !_bytesPerSecond
+		|| !_loadingOffsets.empty()) {
+		return;
+	}
+	const auto preloaded = int64(offset)
+		+ PreloadPartsByBitrate(_bytesPerSecond) * int64(kPartSize);
+	const auto horizon = preloaded
+		+ _bytesPerSecond * kSeekPrefetchDuration / 1000;
+	auto left = kSeekPointsPrefetch;
+	auto i = ranges::upper_bound(_seekPoints, preloaded);
+	const auto till = std::min(horizon, int64(size()));
+	for (; i != end(_seekPoints) && *i < till && left > 0; ++i) {
+		const auto part = (*i / kPartSize) * kPartSize;
+		if (_slices.prefetchRequired(part)) {
+			loadAtOffset(part);
+			--left;
+		}
+	}
+}
+
+void Reader::countStall(FillState state) {
+	const auto now = crl::now();
+	if (state != FillState::Success) {
+		if (!_stallStarted) {
+			_stallStarted = now;
+		}
+		return;
+	} else if (!_stallStarted) {
+		return;
+	}
+	const auto stall = now - base::take(_stallStarted);
+	_stalls.fetch_add(1, std::memory_order_relaxed);
+	_stalledTime.fetch_add(stall, std::memory_order_relaxed);
+	if (_maxStall.load(std::memory_order_relaxed) < stall) {
+		_maxStall.store(stall, std::memory_order_relaxed);
+	}
+}
+
+Reader::Stats Reader::stats() const {
+	return {
+		.stalls = _stalls.load(std::memory_order_relaxed),
+		.stalledTime = _stalledTime.load(std::memory_order_relaxed),
+		.maxStall = _maxStall.load(std::memory_order_relaxed),
+	};
+}
+
 Reader::FillState Reader::fillFromSlices(int offset, bytes::span buffer) {
 	using namespace rpl::mappers;
 
@@ -1393,6 +1542,13 @@ void Reader::finalizeCache() {
 }
 
 Reader::~Reader() {
+	if (const auto stats = this->stats(); stats.stalls > 0) {
+		DEBUG_LOG(("Streaming Info: "
+			"Reader stalled %1 times for %2 ms, the longest %3 ms."
+			).arg(stats.stalls
+			).arg(stats.stalledTime
+			).arg(stats.maxStall));
+	}
 	finalizeCache();
 }
 
@@ -38,6 +38,11 @@ public:
 		WaitingRemote,
 		Failed,
 	};
+	struct Stats {
+		int stalls = 0;
+		crl::time stalledTime = 0;
+		crl::time maxStall = 0;
+	};
 
 	// Main thread.
 	explicit Reader(
@@ -60,7 +65,12 @@ public:
 	[[nodiscard]] int headerSize() const;
 	[[nodiscard]] bool fullInCache() const;
 
+	// Single thread.
+	// Seek points are sorted byte offsets of keyframes from the container.
+	void setPlaybackInfo(crl::time duration, std::vector<int> &&seekPoints);
+
 	// Thread safe.
+	[[nodiscard]] Stats stats() const;
 	void startSleep(not_null<crl::semaphore*> wake);
 	void wakeFromSleep();
 	void stopSleep();
@@ -129,7 +139,11 @@ private:
 
 		void processCacheData(PartsMap &&data);
 		void addPart(int offset, QByteArray bytes);
-		PrepareFillResult prepareFill(int from, int till);
+		PrepareFillResult prepareFill(
+			int from,
+			int till,
+			int preloadParts,
+			int preloadLimit);
 
 		// Get up to kLoadFromRemoteMax not loaded parts in from-till range.
 		StackIntVector<kLoadFromRemoteMax> offsetsFromLoader(
@@ -146,6 +160,7 @@ private:
 		Slices(int size, bool useCache);
 
 		void headerDone(bool fromCache);
+		void setPreloadParts(int count);
 		[[nodiscard]] int headerSize() const;
 		[[nodiscard]] bool fullInCache() const;
 		[[nodiscard]] bool headerWontBeFilled() const;
@@ -165,6 +180,7 @@ private:
 
 		[[nodiscard]] QByteArray partForDownloader(int offset) const;
 		[[nodiscard]] bool readCacheForDownloaderRequired(int offset);
+		[[nodiscard]] bool prefetchRequired(int offset) const;
 
 	private:
 		enum class HeaderMode {
@@ -177,6 +193,7 @@ private:
 
 		void applyHeaderCacheData();
 		[[nodiscard]] int maxSliceSize(int sliceNumber) const;
+		[[nodiscard]] bool cacheNotLoaded(int sliceIndex) const;
 		[[nodiscard]] SerializedSlice serializeAndUnloadSlice(
 			int sliceNumber);
 		[[nodiscard]] SerializedSlice serializeAndUnloadUnused();
@@ -195,6 +212,8 @@ private:
 		std::vector<Slice> _data;
 		Slice _header;
 		std::deque<int> _usedSlices;
+		int _slicesInMemory = 0;
+		int _preloadParts = 0;
 		int _size = 0;
 		HeaderMode _headerMode = HeaderMode::Unknown;
 		bool _fullInCache = false;
@@ -216,6 +235,8 @@ private:
 	bool checkForSomethingMoreReceived();
 
 	FillState fillFromSlices(int offset, bytes::span buffer);
+	void prefetchSeekPoints(int offset);
+	void countStall(FillState state);
 
 	void finalizeCache();
 
@@ -248,6 +269,15 @@ private:
 
 	Slices _slices;
 
+	// Streaming thread.
+	std::vector<int> _seekPoints;
+	int64 _bytesPerSecond = 0;
+	crl::time _stallStarted = 0;
+
+	std::atomic<int> _stalls = 0;
+	std::atomic<crl::time> _stalledTime = 0;
+	std::atomic<crl::time> _maxStall = 0;
+
 	// Even if streaming had failed, the Reader can work for the downloader.
 	std::optional<Error> _streamingError;
 
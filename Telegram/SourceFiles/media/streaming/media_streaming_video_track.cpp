@@ -7,8 +7,10 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #include "media/streaming/media_streaming_video_track.h"
 
+#include "media/streaming/media_streaming_yuv420.h"
 #include "ffmpeg/ffmpeg_utility.h"
 #include "media/audio/media_audio.h"
+#include "kotato/kotato_settings.h"
 #include "base/concurrent_timer.h"
 #include "core/crash_reports.h"
 
@@ -21,54 +23,26 @@ constexpr auto kDisplaySkipped = crl::time(-1);
 constexpr auto kFinishedPosition = std::numeric_limits<crl::time>::max();
 static_assert(kDisplaySkipped != kTimeUnknown);
 
-[[nodiscard]] QImage ConvertToARGB32(const FrameYUV420 &data) {
-	Expects(data.y.data != nullptr);
-	Expects(data.u.data != nullptr);
-	Expects(data.v.data != nullptr);
-	Expects(!data.size.isEmpty());
-
-	//if (FFmpeg::RotationSwapWidthHeight(stream.rotation)) {
-	//	resize.transpose();
-	//}
-
-	auto result = FFmpeg::CreateFrameStorage(data.size);
-	const auto swscale = FFmpeg::MakeSwscalePointer(
-		data.size,
-		AV_PIX_FMT_YUV420P,
-		data.size,
-		AV_PIX_FMT_BGRA);
-	if (!swscale) {
-		return QImage();
-	}
-
-	// AV_NUM_DATA_POINTERS defined in AVFrame struct
-	const uint8_t *srcData[AV_NUM_DATA_POINTERS] = {
-		static_cast<const uint8_t*>(data.y.data),
-		static_cast<const uint8_t*>(data.u.data),
-		static_cast<const uint8_t*>(data.v.data),
-		nullptr,
-	};
-	int srcLinesize[AV_NUM_DATA_POINTERS] = {
-		data.y.stride,
-		data.u.stride,
-		data.v.stride,
-		0,
-	};
-	uint8_t *dstData[AV_NUM_DATA_POINTERS] = { result.bits(), nullptr };
-	int dstLinesize[AV_NUM_DATA_POINTERS] = { int(result.bytesPerLine()), 0 };
-
-	sws_scale(
-		swscale.get(),
-		srcData,
-		srcLinesize,
-		0,
-		data.size.height(),
-		dstData,
-		dstLinesize);
-
+// Frames decoded ahead of the shared frames ring are limited by the
+// "video_decode_ahead" duration, by memory and by count.
+constexpr auto kMaxDecodedAheadBytes = int64(64 * 1024 * 1024);
+constexpr auto kMaxDecodedAheadFrames = 60;
+constexpr auto kMaxPooledFrames = 8;
+
+[[nodiscard]] int64 FrameBytes(not_null<const AVFrame*> frame) {
+	auto result = int64();
+	for (const auto buffer : frame->buf) {
+		if (buffer) {
+			result += buffer->size;
+		}
+	}
 	return result;
 }
 
+[[nodiscard]] QImage ConvertToARGB32(const FrameYUV420 &data) {
+	return ConvertYUV420ToARGB32(data, data.size);
+}
+
 } // namespace
 
 class VideoTrackObject final {
@@ -117,6 +91,12 @@ private:
 		v::null_t,
 		FrameResult,
 		Shared::PrepareNextCheck>;
+	struct DecodedFrame {
+		FFmpeg::FramePointer decoded;
+		crl::time position = kTimeUnknown;
+		int index = 0;
+		FrameResult result = FrameResult::Done;
+	};
 
 	void fail(Error error);
 	[[nodiscard]] bool interrupted() const;
@@ -127,6 +107,11 @@ private:
 	void readFrames();
 	[[nodiscard]] ReadEnoughState readEnoughFrames(crl::time trackTime);
 	[[nodiscard]] FrameResult readFrame(not_null<Frame*> frame);
+	[[nodiscard]] FrameResult takeDecodedAhead(not_null<Frame*> frame);
+	[[nodiscard]] bool decodeAheadFrame();
+	[[nodiscard]] bool decodedAheadFull() const;
+	[[nodiscard]] FFmpeg::FramePointer takePooledFrame();
+	void releasePooledFrame(FFmpeg::FramePointer frame);
 	void fillRequests(not_null<Frame*> frame) const;
 	[[nodiscard]] QSize chooseOriginalResize() const;
 	void presentFrameIfNeeded();
@@ -168,6 +153,11 @@ private:
 	// For initial frame skipping for an exact seek.
 	FFmpeg::FramePointer _initialSkippingFrame;
 
+	// Decoded while the shared frames ring is full, to absorb decode spikes.
+	std::deque<DecodedFrame> _decodedAhead;
+	int64 _decodedAheadBytes = 0;
+	std::vector<FFmpeg::FramePointer> _framesPool;
+
 };
 
 VideoTrackObject::VideoTrackObject(
@@ -293,6 +283,12 @@ void VideoTrackObject::readFrames() {
 			if (delay != kTimeUnknown) {
 				queueReadFrames(delay);
 			}
+
+			// Decode one frame at a time, so that presenting
+			// and other queued calls are not delayed by a long burst.
+			if (decodeAheadFrame() && !interrupted()) {
+				queueReadFrames();
+			}
 		}, [](v::null_t) {
 		});
 		if (!v::is_null(result)) {
@@ -348,6 +344,9 @@ crl::time VideoTrackObject::computeDuration() const {
 }
 
 auto VideoTrackObject::readFrame(not_null<Frame*> frame) -> FrameResult {
+	if (!_decodedAhead.empty()) {
+		return takeDecodedAhead(frame);
+	}
 	if (const auto error = ReadNextFrame(_stream)) {
 		if (error.code() == AVERROR_EOF) {
 			if (!_options.loop) {
@@ -380,6 +379,121 @@ auto VideoTrackObject::readFrame(not_null<Frame*> frame) -> FrameResult {
 	return FrameResult::Done;
 }
 
+auto VideoTrackObject::takeDecodedAhead(not_null<Frame*> frame)
+-> FrameResult {
+	Expects(!_decodedAhead.empty());
+
+	auto entry = std::move(_decodedAhead.front());
+	_decodedAhead.pop_front();
+
+	switch (entry.result) {
+	case FrameResult::Done:
+		_decodedAheadBytes -= FrameBytes(entry.decoded.get());
+		std::swap(frame->decoded, entry.decoded);
+		releasePooledFrame(std::move(entry.decoded));
+		frame->index = entry.index;
+		frame->position = entry.position;
+		frame->displayed = kTimeUnknown;
+		return FrameResult::Done;
+	case FrameResult::Finished:
+		frame->position = kFinishedPosition;
+		frame->displayed = kTimeUnknown;
+		return FrameResult::Finished;
+	case FrameResult::Looped:
+		return FrameResult::Looped;
+	case FrameResult::Error:
+		fail(Error::InvalidData);
+		return FrameResult::Error;
+	}
+	Unexpected("Result in VideoTrackObject::takeDecodedAhead.");
+}
+
+bool VideoTrackObject::decodedAheadFull() const {
+	if (_decodedAhead.empty()) {
+		return false;
+	}
+	const auto last = _decodedAhead.back().result;
+	if (last == FrameResult::Finished
+		|| last == FrameResult::Error
+		|| int(_decodedAhead.size()) >= kMaxDecodedAheadFrames
+		|| _decodedAheadBytes >= kMaxDecodedAheadBytes) {
+		return true;
+	}
+	const auto isFrame = [](const DecodedFrame &entry) {
+		return (entry.result == FrameResult::Done);
+	};
+	const auto first = ranges::find_if(_decodedAhead, isFrame);
+	if (first == end(_decodedAhead)) {
+		return false;
+	}
+	const auto till = std::find_if(
+		_decodedAhead.rbegin(),
+		_decodedAhead.rend(),
+		isFrame);
+	const auto depth = crl::time(::Kotato::JsonSettings::GetInt(
+		::Kotato::JsonSettings::Key::VideoDecodeAhead));
+	return (till->position - first->position) >= depth * _options.speed;
+}
+
+bool VideoTrackObject::decodeAheadFrame() {
+	if (::Kotato::JsonSettings::GetInt(
+			::Kotato::JsonSettings::Key::VideoDecodeAhead) <= 0
+		|| decodedAheadFull()) {
+		return false;
+	}
+	auto entry = DecodedFrame();
+	if (const auto error = ReadNextFrame(_stream)) {
+		if (error.code() == AVERROR_EOF) {
+			if (!_options.loop) {
+				entry.result = FrameResult::Finished;
+			} else if (loopAround()) {
+				entry.result = FrameResult::Looped;
+			} else {
+				entry.result = FrameResult::Error;
+			}
+		} else if (error.code() != AVERROR(EAGAIN) || _readTillEnd) {
+			entry.result = FrameResult::Error;
+		} else {
+			// Waiting for more packets.
+			return false;
+		}
+		const auto looped = (entry.result == FrameResult::Looped);
+		_decodedAhead.push_back(std::move(entry));
+		return looped;
+	}
+	const auto position = currentFramePosition();
+	if (position == kTimeUnknown) {
+		entry.result = FrameResult::Error;
+		_decodedAhead.push_back(std::move(entry));
+		return false;
+	}
+	entry.decoded = takePooledFrame();
+	std::swap(entry.decoded, _stream.frame);
+	entry.index = _frameIndex++;
+	entry.position = position;
+	_decodedAheadBytes += FrameBytes(entry.decoded.get());
+	_decodedAhead.push_back(std::move(entry));
+	return true;
+}
+
+FFmpeg::FramePointer VideoTrackObject::takePooledFrame() {
+	if (_framesPool.empty()) {
+		return FFmpeg::MakeFramePointer();
+	}
+	auto result = std::move(_framesPool.back());
+	_framesPool.pop_back();
+	return result;
+}
+
+void VideoTrackObject::releasePooledFrame(FFmpeg::FramePointer frame) {
+	if (!frame || int(_framesPool.size()) >= kMaxPooledFrames) {
+		return;
+	}
+	// Drop the decoder buffer references, keep the AVFrame itself.
+	av_frame_unref(frame.get());
+	_framesPool.push_back(std::move(frame));
+}
+
 void VideoTrackObject::fillRequests(not_null<Frame*> frame) const {
 	auto i = frame->prepared.begin();
 	for (const auto &[instance, request] : _requests) {
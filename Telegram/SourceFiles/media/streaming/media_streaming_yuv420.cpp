@@ -0,0 +1,305 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "media/streaming/media_streaming_yuv420.h"
+
+#include "ffmpeg/ffmpeg_utility.h"
+
+#if defined _M_X64 || defined __x86_64__ || defined __SSE2__
+#define TDESKTOP_YUV420_SSE2
+#include <emmintrin.h>
+#elif defined _M_ARM64 || defined __aarch64__ || defined __ARM_NEON
+#define TDESKTOP_YUV420_NEON
+#include <arm_neon.h>
+#endif
+
+namespace Media {
+namespace Streaming {
+namespace {
+
+// BT.601 limited range coefficients with 13 fractional bits, rounded.
+// They fit in signed 16 bit and are widened to 32 bit when multiplied.
+// Every code path uses the same integer math and gives the same result.
+constexpr auto kShift = 13;
+constexpr auto kRound = (1 << (kShift - 1));
+constexpr auto kY = 9539; // 1.164384
+constexpr auto kRV = 13075; // 1.596027
+constexpr auto kGU = 3209; // 0.391762
+constexpr auto kGV = 6660; // 0.812968
+constexpr auto kBU = 16525; // 2.017232
+
+struct Mapping {
+	// Offsets of the source pixel are lumaBase[y] + lumaIndex[x].
+	std::vector<int> lumaIndex;
+	std::vector<int> uIndex;
+	std::vector<int> vIndex;
+	std::vector<int> lumaBase;
+	std::vector<int> uBase;
+	std::vector<int> vBase;
+
+	// Rows of the result can be read from the source rows directly.
+	bool direct = false;
+};
+
+[[nodiscard]] inline uint32 ConvertPixel(int y, int u, int v) {
+	const auto luma = (y - 16) * kY + kRound;
+	u -= 128;
+	v -= 128;
+	const auto r = std::clamp((luma + kRV * v) >> kShift, 0, 255);
+	const auto g = std::clamp((luma - kGU * u - kGV * v) >> kShift, 0, 255);
+	const auto b = std::clamp((luma + kBU * u) >> kShift, 0, 255);
+	return 0xFF000000U | (uint32(r) << 16) | (uint32(g) << 8) | uint32(b);
+}
+
+void ConvertRow(
+		const uchar *y,
+		const uchar *u,
+		const uchar *v,
+		uint32 *to,
+		int width) {
+	auto x = 0;
+#if defined TDESKTOP_YUV420_SSE2
+	const auto zero = _mm_setzero_si128();
+	const auto alpha = _mm_set1_epi8(char(0xFF));
+	const auto c16 = _mm_set1_epi16(16);
+	const auto c128 = _mm_set1_epi16(128);
+	const auto round = _mm_set1_epi32(kRound);
+
+	// Coefficients for the (luma, chroma) pairs of _mm_madd_epi16.
+	const auto pair = [](int first, int second) {
+		return _mm_set1_epi32(int(uint32(uint16(first))
+			| (uint32(uint16(second)) << 16)));
+	};
+	const auto cYRV = pair(kY, kRV);
+	const auto cYGU = pair(kY, -kGU);
+	const auto cGV = pair(0, -kGV);
+	const auto cYBU = pair(kY, kBU);
+	const auto load = [&](const uchar *from) {
+		return _mm_unpacklo_epi8(
+			_mm_loadl_epi64(reinterpret_cast<const __m128i*>(from)),
+			zero);
+	};
+	const auto channel = [&](__m128i low, __m128i high) {
+		return _mm_packs_epi32(
+			_mm_srai_epi32(_mm_add_epi32(low, round), kShift),
+			_mm_srai_epi32(_mm_add_epi32(high, round), kShift));
+	};
+	for (; x + 8 <= width; x += 8) {
+		const auto luma = _mm_sub_epi16(load(y + x), c16);
+		const auto cu = _mm_sub_epi16(load(u + x), c128);
+		const auto cv = _mm_sub_epi16(load(v + x), c128);
+		const auto lumaULow = _mm_unpacklo_epi16(luma, cu);
+		const auto lumaUHigh = _mm_unpackhi_epi16(luma, cu);
+		const auto lumaVLow = _mm_unpacklo_epi16(luma, cv);
+		const auto lumaVHigh = _mm_unpackhi_epi16(luma, cv);
+		const auto r = channel(
+			_mm_madd_epi16(lumaVLow, cYRV),
+			_mm_madd_epi16(lumaVHigh, cYRV));
+		const auto g = channel(
+			_mm_add_epi32(
+				_mm_madd_epi16(lumaULow, cYGU),
+				_mm_madd_epi16(lumaVLow, cGV)),
+			_mm_add_epi32(
+				_mm_madd_epi16(lumaUHigh, cYGU),
+				_mm_madd_epi16(lumaVHigh, cGV)));
+		const auto b = channel(
+			_mm_madd_epi16(lumaULow, cYBU),
+			_mm_madd_epi16(lumaUHigh, cYBU));
+		const auto bg = _mm_unpacklo_epi8(
+			_mm_packus_epi16(b, zero),
+			_mm_packus_epi16(g, zero));
+		const auto ra = _mm_unpacklo_epi8(_mm_packus_epi16(r, zero), alpha);
+		_mm_storeu_si128(
+			reinterpret_cast<__m128i*>(to + x),
+			_mm_unpacklo_epi16(bg, ra));
+		_mm_storeu_si128(
+			reinterpret_cast<__m128i*>(to + x + 4),
+			_mm_unpackhi_epi16(bg, ra));
+	}
+#elif defined TDESKTOP_YUV420_NEON
+	const auto c16 = vdupq_n_s16(16);
+	const auto c128 = vdupq_n_s16(128);
+	const auto load = [&](const uchar *from) {
+		return vreinterpretq_s16_u16(vmovl_u8(vld1_u8(from)));
+	};
+
+	// Rounding shift gives the same result as adding kRound first.
+	const auto channel = [&](int32x4_t low, int32x4_t high) {
+		return vqmovun_s16(vcombine_s16(
+			vqrshrn_n_s32(low, kShift),
+			vqrshrn_n_s32(high, kShift)));
+	};
+	for (; x + 8 <= width; x += 8) {
+		const auto luma = vsubq_s16(load(y + x), c16);
+		const auto cu = vsubq_s16(load(u + x), c128);
+		const auto cv = vsubq_s16(load(v + x), c128);
+		const auto lumaLow = vmull_n_s16(vget_low_s16(luma), kY);
+		const auto lumaHigh = vmull_n_s16(vget_high_s16(luma), kY);
+		auto pixels = uint8x8x4_t();
+		pixels.val[0] = channel(
+			vmlal_n_s16(lumaLow, vget_low_s16(cu), kBU),
+			vmlal_n_s16(lumaHigh, vget_high_s16(cu), kBU));
+		pixels.val[1] = channel(
+			vmlsl_n_s16(
+				vmlsl_n_s16(lumaLow, vget_low_s16(cu), kGU),
+				vget_low_s16(cv),
+				kGV),
+			vmlsl_n_s16(
+				vmlsl_n_s16(lumaHigh, vget_high_s16(cu), kGU),
+				vget_high_s16(cv),
+				kGV));
+		pixels.val[2] = channel(
+			vmlal_n_s16(lumaLow, vget_low_s16(cv), kRV),
+			vmlal_n_s16(lumaHigh, vget_high_s16(cv), kRV));
+		pixels.val[3] = vdup_n_u8(0xFF);
+		vst4_u8(reinterpret_cast<uint8_t*>(to + x), pixels);
+	}
+#endif // TDESKTOP_YUV420_SSE2 || TDESKTOP_YUV420_NEON
+	for (; x != width; ++x) {
+		to[x] = ConvertPixel(y[x], u[x], v[x]);
+	}
+}
+
+[[nodiscard]] Mapping PrepareMapping(
+		const FrameYUV420 &data,
+		QSize size,
+		int rotation) {
+	const auto sourceWidth = data.size.width();
+	const auto sourceHeight = data.size.height();
+	const auto columns = (rotation == 90 || rotation == 270);
+	const auto rotatedWidth = columns ? sourceHeight : sourceWidth;
+	const auto rotatedHeight = columns ? sourceWidth : sourceHeight;
+	const auto width = size.width();
+	const auto height = size.height();
+
+	// Nearest neighbour, sampling at the centers of the result pixels.
+	const auto sample = [](int index, int from, int to) {
+		return int((int64(2 * index + 1) * from) / (2 * to));
+	};
+	const auto sourceX = [&](int rx, int ry) {
+		switch (rotation) {
+		case 90: return ry;
+		case 180: return sourceWidth - 1 - rx;
+		case 270: return sourceWidth - 1 - ry;
+		}
+		return rx;
+	};
+	const auto sourceY = [&](int rx, int ry) {
+		switch (rotation) {
+		case 90: return sourceHeight - 1 - rx;
+		case 180: return sourceHeight - 1 - ry;
+		case 270: return rx;
+		}
+		return ry;
+	};
+
+	auto result = Mapping();
+	result.direct = !rotation && (width == sourceWidth);
+	result.lumaIndex.resize(width);
+	result.uIndex.resize(width);
+	result.vIndex.resize(width);
+	for (auto x = 0; x != width; ++x) {
+		const auto rx = sample(x, rotatedWidth, width);
+		if (columns) {
+			const auto sy = sourceY(rx, 0);
+			result.lumaIndex[x] = sy * data.y.stride;
+			result.uIndex[x] = (sy / 2) * data.u.stride;
+			result.vIndex[x] = (sy / 2) * data.v.stride;
+		} else {
+			const auto sx = sourceX(rx, 0);
+			result.lumaIndex[x] = sx;
+			result.uIndex[x] = result.vIndex[x] = (sx / 2);
+		}
+	}
+	result.lumaBase.resize(height);
+	result.uBase.resize(height);
+	result.vBase.resize(height);
+	for (auto y = 0; y != height; ++y) {
+		const auto ry = sample(y, rotatedHeight, height);
+		if (columns) {
+			const auto sx = sourceX(0, ry);
+			result.lumaBase[y] = sx;
+			result.uBase[y] = result.vBase[y] = (sx / 2);
+		} else {
+			const auto sy = sourceY(0, ry);
+			result.lumaBase[y] = sy * data.y.stride;
+			result.uBase[y] = (sy / 2) * data.u.stride;
+			result.vBase[y] = (sy / 2) * data.v.stride;
+		}
+	}
+	return result;
+}
+
+void ConvertRows(
+		const FrameYUV420 &data,
+		const Mapping &mapping,
+		uchar *bits,
+		int perLine,
+		int width,
+		int height) {
+	const auto luma = static_cast<const uchar*>(data.y.data);
+	const auto u = static_cast<const uchar*>(data.u.data);
+	const auto v = static_cast<const uchar*>(data.v.data);
+	auto buffer = std::vector<uchar>(3 * width);
+	const auto lumaRow = buffer.data();
+	const auto uRow = lumaRow + width;
+	const auto vRow = uRow + width;
+	for (auto y = 0; y != height; ++y, bits += perLine) {
+		const auto lumaFrom = luma + mapping.lumaBase[y];
+		const auto uFrom = u + mapping.uBase[y];
+		const auto vFrom = v + mapping.vBase[y];
+		if (!mapping.direct) {
+			for (auto x = 0; x != width; ++x) {
+				lumaRow[x] = lumaFrom[mapping.lumaIndex[x]];
+			}
+		}
+		for (auto x = 0; x != width; ++x) {
+			uRow[x] = uFrom[mapping.uIndex[x]];
+			vRow[x] = vFrom[mapping.vIndex[x]];
+		}
+		ConvertRow(
+			mapping.direct ? lumaFrom : lumaRow,
+			uRow,
+			vRow,
+			reinterpret_cast<uint32*>(bits),
+			width);
+	}
+}
+
+} // namespace
+
+QImage ConvertYUV420ToARGB32(
+		const FrameYUV420 &data,
+		QSize size,
+		int rotation,
+		QImage storage) {
+	Expects(data.y.data != nullptr);
+	Expects(data.u.data != nullptr);
+	Expects(data.v.data != nullptr);
+	Expects(!data.size.isEmpty());
+	Expects(!size.isEmpty());
+	Expects(rotation == 0
+		|| rotation == 90
+		|| rotation == 180
+		|| rotation == 270);
+
+	if (!FFmpeg::GoodStorageForFrame(storage, size)) {
+		storage = FFmpeg::CreateFrameStorage(size);
+	}
+	const auto mapping = PrepareMapping(data, size, rotation);
+	ConvertRows(
+		data,
+		mapping,
+		storage.bits(),
+		int(storage.bytesPerLine()),
+		size.width(),
+		size.height());
+	return storage;
+}
+
+} // namespace Streaming
+} // namespace Media
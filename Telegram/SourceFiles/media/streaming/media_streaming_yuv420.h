@@ -0,0 +1,25 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "media/streaming/media_streaming_common.h"
+
+namespace Media {
+namespace Streaming {
+
+// Converts a BT.601 limited range frame to opaque ARGB32 in one pass,
+// scaling it with the nearest neighbour to 'size' and rotating clockwise
+// by 'rotation' degrees. The 'size' is given after the rotation.
+[[nodiscard]] QImage ConvertYUV420ToARGB32(
+	const FrameYUV420 &data,
+	QSize size,
+	int rotation = 0,
+	QImage storage = QImage());
+
+} // namespace Streaming
+} // namespace Media
@@ -36,6 +36,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/audio/media_audio.h"
 #include "media/view/media_view_playback_controls.h"
 #include "media/view/media_view_group_thumbs.h"
+#include "media/view/media_view_tiled_image.h"
 #include "media/view/media_view_pip.h"
 #include "media/view/media_view_overlay_raster.h"
 #include "media/view/media_view_overlay_opengl.h"
@@ -652,6 +653,77 @@ void OverlayWidget::setStaticContent(QImage image) {
 	_staticContentTransparent = IsSemitransparent(_staticContent);
 }
 
+QImage OverlayWidget::prepareDocumentImage(
+		const QString &path,
+		QByteArray content) {
+	_tiled = TiledImage::Create(
+		path,
+		content,
+		kMaxDisplayImageSize,
+		[=] { updateContentRect(); });
+	return _tiled
+		? _tiled->takePreview()
+		: PrepareStaticImage({
+			.path = path,
+			.content = std::move(content),
+		});
+}
+
+QImage OverlayWidget::tiledContentImage(ContentGeometry &geometry) {
+	if (!_tiled
+		|| _staticContent.isNull()
+		|| _geometryAnimation.animating()) {
+		return QImage();
+	}
+	const auto factor = cIntRetinaFactor();
+	const auto content = geometry.rect;
+	if (content.width() * factor <= _staticContent.width()) {
+		return QImage();
+	}
+	const auto shown = finalContentRect();
+	const auto visible = shown.intersected(QRect(0, 0, width(), height()));
+	if (visible.isEmpty()) {
+		return QImage();
+	}
+
+	// Map the visible part back to the not rotated content.
+	const auto rotation = int(geometry.rotation) % 360;
+	const auto mapped = [&](QPoint point) {
+		const auto x = point.x() - shown.x();
+		const auto y = point.y() - shown.y();
+		switch (rotation) {
+		case 90: return QPointF(y, content.height() - x);
+		case 180: return QPointF(content.width() - x, content.height() - y);
+		case 270: return QPointF(content.width() - y, x);
+		}
+		return QPointF(x, y);
+	};
+	const auto part = QRectF(
+		mapped(visible.topLeft()),
+		mapped(visible.topLeft() + QPoint(visible.width(), visible.height()))
+	).normalized();
+	const auto original = _tiled->size();
+	const auto ratiox = original.width() / content.width();
+	const auto ratioy = original.height() / content.height();
+	const auto size = (rotation % 180)
+		? visible.size().transposed()
+		: visible.size();
+	auto result = _tiled->compose(
+		QRectF(
+			part.x() * ratiox,
+			part.y() * ratioy,
+			part.width() * ratiox,
+			part.height() * ratioy),
+		size * factor,
+		_staticContent);
+	if (!result.isNull()) {
+		auto rect = QRectF(QPointF(), QSizeF(size));
+		rect.moveCenter(QRectF(visible).center());
+		geometry.rect = rect;
+	}
+	return result;
+}
+
 bool OverlayWidget::contentShown() const {
 	return _photo || documentContentShown();
 }
@@ -2389,6 +2461,7 @@ void OverlayWidget::displayPhoto(not_null<PhotoData*> photo) {
 	refreshMediaViewer();
 
 	_staticContent = QImage();
+	_tiled = nullptr;
 	if (_photo->videoCanBePlayed()) {
 		initStreaming();
 	}
@@ -2441,6 +2514,7 @@ void OverlayWidget::displayDocument(
 		bool continueStreaming) {
 	_fullScreenVideo = false;
 	_staticContent = QImage();
+	_tiled = nullptr;
 	clearStreaming(_document != doc);
 	destroyThemePreview();
 	assignMediaPointer(doc);
@@ -2478,16 +2552,16 @@ void OverlayWidget::displayDocument(
 				_document->saveFromDataSilent();
 				auto &location = _document->location(true);
 				if (location.accessEnable()) {
-					setStaticContent(PrepareStaticImage({
-						.path = location.name(),
-					}));
+					setStaticContent(prepareDocumentImage(
+						location.name(),
+						QByteArray()));
 					if (!_staticContent.isNull()) {
 						_touchbarDisplay.fire(TouchBarItemType::Photo);
 					}
 				} else {
-					setStaticContent(PrepareStaticImage({
-						.content = _documentMedia->bytes(),
-					}));
+					setStaticContent(prepareDocumentImage(
+						QString(),
+						_documentMedia->bytes()));
 					if (!_staticContent.isNull()) {
 						_touchbarDisplay.fire(TouchBarItemType::Photo);
 					}
@@ -3358,9 +3432,11 @@ void OverlayWidget::paint(not_null<Renderer*> renderer) {
 			const auto fillTransparentBackground = (!_document
 				|| (!_document->sticker() && !_document->isVideoMessage()))
 				&& _staticContentTransparent;
+			auto geometry = contentGeometry();
+			const auto tiled = tiledContentImage(geometry);
 			renderer->paintTransformedStaticContent(
-				_staticContent,
-				contentGeometry(),
+				tiled.isNull() ? _staticContent : tiled,
+				geometry,
 				_staticContentTransparent,
 				fillTransparentBackground);
 		}
@@ -4716,6 +4792,7 @@ void OverlayWidget::clearAfterHide() {
 	destroyThemePreview();
 	_radial.stop();
 	_staticContent = QImage();
+	_tiled = nullptr;
 	_themePreview = nullptr;
 	_themeApply.destroyDelayed();
 	_themeCancel.destroyDelayed();
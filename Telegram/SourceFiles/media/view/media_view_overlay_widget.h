@@ -57,6 +57,7 @@ namespace Media::View {
 
 class GroupThumbs;
 class Pip;
+class TiledImage;
 
 class OverlayWidget final
 	: public ClickHandlerHost
@@ -410,6 +411,12 @@ private:
 	[[nodiscard]] bool documentContentShown() const;
 	[[nodiscard]] bool documentBubbleShown() const;
 	void setStaticContent(QImage image);
+	[[nodiscard]] QImage prepareDocumentImage(
+		const QString &path,
+		QByteArray content);
+
+	// Adjusts geometry to the shown part the result image covers.
+	[[nodiscard]] QImage tiledContentImage(ContentGeometry &geometry);
 	[[nodiscard]] bool contentShown() const;
 	[[nodiscard]] bool opaqueContentShown() const;
 	void clearStreaming(bool savePosition = true);
@@ -478,6 +485,7 @@ private:
 	int32 _dragging = 0;
 	QImage _staticContent;
 	bool _staticContentTransparent = false;
+	std::unique_ptr<TiledImage> _tiled;
 	bool _blurred = true;
 
 	ContentGeometry _oldGeometry;
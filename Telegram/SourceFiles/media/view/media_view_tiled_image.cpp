@@ -0,0 +1,299 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "media/view/media_view_tiled_image.h"
+
+#include <QtCore/QBuffer>
+#include <QtCore/QFile>
+#include <QtGui/QImageReader>
+
+#include <mutex>
+
+namespace Media::View {
+namespace {
+
+constexpr auto kTileSide = 512;
+
+// Tiles shown in the last composed image are never evicted,
+// so this may be exceeded while zoomed on a very large screen.
+constexpr auto kTilesCacheLimit = int64(64 * 1024 * 1024);
+
+[[nodiscard]] QImage ReadTile(QByteArray content, QSize size, QRect rect) {
+	auto buffer = QBuffer(&content);
+	auto reader = QImageReader(&buffer);
+	reader.setAutoTransform(false);
+	reader.setScaledSize(size);
+	reader.setScaledClipRect(rect);
+	auto result = reader.read();
+	if (result.size() != rect.size()) {
+		return QImage();
+	} else if (result.format() != QImage::Format_RGB32
+		&& result.format() != QImage::Format_ARGB32_Premultiplied) {
+		result = std::move(result).convertToFormat(
+			QImage::Format_ARGB32_Premultiplied);
+	}
+	return result;
+}
+
+} // namespace
+
+struct TiledImage::Shared {
+	QByteArray content;
+
+	std::mutex mutex;
+	base::flat_set<TileKey> wanted;
+};
+
+std::unique_ptr<TiledImage> TiledImage::Create(
+		const QString &path,
+		QByteArray content,
+		int previewSide,
+		Fn<void()> tileReady) {
+	auto buffer = QBuffer(&content);
+	auto file = QFile(path);
+	auto device = content.isEmpty() ? static_cast<QIODevice*>(&file) : &buffer;
+	auto reader = QImageReader(device);
+	reader.setAutoTransform(false);
+	const auto size = reader.size();
+	if (!reader.canRead()
+		|| size.isEmpty()
+		|| (size.width() <= previewSide && size.height() <= previewSide)
+		|| reader.supportsAnimation()
+		|| !reader.supportsOption(QImageIOHandler::ScaledSize)
+		|| !reader.supportsOption(QImageIOHandler::ScaledClipRect)
+		|| reader.transformation() != QImageIOHandler::TransformationNone) {
+		return nullptr;
+	}
+
+	// Scaled decoding skips most of the work for the huge original.
+	reader.setScaledSize(size.scaled(
+		previewSide,
+		previewSide,
+		Qt::KeepAspectRatio));
+	auto preview = reader.read();
+	if (preview.isNull()) {
+		return nullptr;
+	} else if (content.isEmpty()) {
+		auto input = QFile(path);
+		if (!input.open(QIODevice::ReadOnly)) {
+			return nullptr;
+		}
+		content = input.readAll();
+	}
+	return std::make_unique<TiledImage>(
+		std::move(content),
+		size,
+		std::move(preview),
+		std::move(tileReady));
+}
+
+TiledImage::TiledImage(
+	QByteArray content,
+	QSize size,
+	QImage preview,
+	Fn<void()> tileReady)
+: _shared(std::make_shared<Shared>())
+, _size(size)
+, _tileReady(std::move(tileReady))
+, _preview(std::move(preview)) {
+	Expects(!_size.isEmpty());
+	Expects(!_preview.isNull());
+
+	_shared->content = std::move(content);
+
+	// Levels coarser than the preview are never needed.
+	_levels = 1;
+	while (levelSize(_levels).width() > _preview.width()) {
+		++_levels;
+	}
+}
+
+TiledImage::~TiledImage() {
+	const auto lock = std::lock_guard(_shared->mutex);
+	_shared->wanted.clear();
+}
+
+QSize TiledImage::size() const {
+	return _size;
+}
+
+QImage TiledImage::takePreview() {
+	return base::take(_preview);
+}
+
+int TiledImage::chooseLevel(float64 scale) const {
+	// The coarsest level that is still not upscaled when shown.
+	auto result = 0;
+	while (result + 1 < _levels && (2 << result) * scale <= 1.) {
+		++result;
+	}
+	return result;
+}
+
+QSize TiledImage::levelSize(int level) const {
+	const auto divider = (1 << level);
+	return QSize(
+		(_size.width() + divider - 1) / divider,
+		(_size.height() + divider - 1) / divider);
+}
+
+QRect TiledImage::tileRect(TileKey key) const {
+	const auto size = levelSize(key.level);
+	return QRect(
+		key.column * kTileSide,
+		key.row * kTileSide,
+		kTileSide,
+		kTileSide).intersected(QRect(QPoint(), size));
+}
+
+QImage TiledImage::compose(
+		QRectF source,
+		QSize target,
+		const QImage &preview) {
+	source = source.intersected(QRectF(QPointF(), QSizeF(_size)));
+	if (source.isEmpty() || target.isEmpty()) {
+		return QImage();
+	} else if (_composedValid
+		&& _composedSource == source
+		&& _composed.size() == target) {
+		return _composed;
+	}
+	const auto scale = target.width() / source.width();
+	const auto level = chooseLevel(scale);
+	const auto size = levelSize(level);
+	const auto ratiox = _size.width() / float64(size.width());
+	const auto ratioy = _size.height() / float64(size.height());
+	const auto left = int(std::floor(source.x() / ratiox / kTileSide));
+	const auto top = int(std::floor(source.y() / ratioy / kTileSide));
+	const auto right = int(std::ceil(
+		(source.x() + source.width()) / ratiox / kTileSide));
+	const auto bottom = int(std::ceil(
+		(source.y() + source.height()) / ratioy / kTileSide));
+
+	auto result = QImage(target, QImage::Format_ARGB32_Premultiplied);
+	result.fill(Qt::transparent);
+	auto p = QPainter(&result);
+	p.setRenderHint(QPainter::SmoothPixmapTransform);
+
+	const auto previewx = preview.width() / float64(_size.width());
+	const auto previewy = preview.height() / float64(_size.height());
+	p.drawImage(
+		QRectF(QPointF(), QSizeF(target)),
+		preview,
+		QRectF(
+			source.x() * previewx,
+			source.y() * previewy,
+			source.width() * previewx,
+			source.height() * previewy));
+
+	++_paintIndex;
+	auto wanted = base::flat_set<TileKey>();
+	auto missing = std::vector<TileKey>();
+	for (auto row = top; row != bottom; ++row) {
+		for (auto column = left; column != right; ++column) {
+			const auto key = TileKey{ level, row, column };
+			wanted.emplace(key);
+			const auto i = _tiles.find(key);
+			if (i == end(_tiles)) {
+				missing.push_back(key);
+				continue;
+			}
+			i->second.lastUsed = _paintIndex;
+			if (i->second.image.isNull()) {
+				continue;
+			}
+			const auto rect = tileRect(key);
+			p.drawImage(
+				QRectF(
+					(rect.x() * ratiox - source.x()) * scale,
+					(rect.y() * ratioy - source.y()) * scale,
+					rect.width() * ratiox * scale,
+					rect.height() * ratioy * scale),
+				i->second.image);
+		}
+	}
+	p.end();
+
+	{
+		const auto lock = std::lock_guard(_shared->mutex);
+		_shared->wanted = std::move(wanted);
+	}
+	for (const auto &key : missing) {
+		request(key);
+	}
+	clearStale();
+
+	_composed = std::move(result);
+	_composedSource = source;
+	_composedValid = true;
+	return _composed;
+}
+
+bool TiledImage::wanted(TileKey key) const {
+	const auto lock = std::lock_guard(_shared->mutex);
+	return _shared->wanted.contains(key);
+}
+
+void TiledImage::request(TileKey key) {
+	if (!_requested.emplace(key).second) {
+		return;
+	}
+	const auto shared = _shared;
+	const auto size = levelSize(key.level);
+	const auto rect = tileRect(key);
+	const auto weak = base::make_weak(this);
+	crl::async([=] {
+		{
+			const auto lock = std::lock_guard(shared->mutex);
+			if (!shared->wanted.contains(key)) {
+				// Scrolled or zoomed away before we got to it.
+				crl::on_main(weak, [=] {
+					_requested.remove(key);
+					if (wanted(key)) {
+						request(key);
+					}
+				});
+				return;
+			}
+		}
+		crl::on_main(weak, [=, image = ReadTile(
+				shared->content,
+				size,
+				rect)]() mutable {
+			tileDecoded(key, std::move(image));
+		});
+	});
+}
+
+void TiledImage::tileDecoded(TileKey key, QImage image) {
+	_requested.remove(key);
+	_tilesBytes += image.sizeInBytes();
+
+	// Failed tiles are kept as null images to not request them again.
+	_tiles[key] = Tile{ std::move(image), _paintIndex };
+	_composedValid = false;
+	clearStale();
+	if (_tileReady) {
+		_tileReady();
+	}
+}
+
+void TiledImage::clearStale() {
+	while (_tilesBytes > kTilesCacheLimit) {
+		const auto i = ranges::min_element(
+			_tiles,
+			ranges::less(),
+			[](const auto &pair) { return pair.second.lastUsed; });
+		if (i == end(_tiles) || i->second.lastUsed == _paintIndex) {
+			return;
+		}
+		_tilesBytes -= i->second.image.sizeInBytes();
+		_tiles.erase(i);
+	}
+}
+
+} // namespace Media::View
@@ -0,0 +1,98 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/weak_ptr.h"
+
+#include <QtGui/QImage>
+
+namespace Media::View {
+
+// Huge still image decoded by tiles of a resolution pyramid on demand.
+//
+// Level 0 is the original resolution, each next level is twice smaller.
+// Only the tiles of the currently shown part are decoded, on workers,
+// and decoded tiles are kept in a memory-limited LRU cache.
+class TiledImage final : public base::has_weak_ptr {
+public:
+	// Returns nullptr if the image fits in previewSide x previewSide
+	// or its format can't decode a part of the image without the rest.
+	[[nodiscard]] static std::unique_ptr<TiledImage> Create(
+		const QString &path,
+		QByteArray content,
+		int previewSide,
+		Fn<void()> tileReady);
+
+	TiledImage(
+		QByteArray content,
+		QSize size,
+		QImage preview,
+		Fn<void()> tileReady);
+	~TiledImage();
+
+	[[nodiscard]] QSize size() const;
+
+	// Whole image scaled down to fit previewSide x previewSide.
+	[[nodiscard]] QImage takePreview();
+
+	// The source rect is in the original image pixels, result has
+	// the target size. Missing tiles are requested and taken from
+	// the preview meanwhile, tileReady is called when they are decoded.
+	[[nodiscard]] QImage compose(
+		QRectF source,
+		QSize target,
+		const QImage &preview);
+
+private:
+	struct Shared;
+	struct TileKey {
+		int level = 0;
+		int row = 0;
+		int column = 0;
+
+		friend inline bool operator<(TileKey a, TileKey b) {
+			return std::tie(a.level, a.row, a.column)
+				< std::tie(b.level, b.row, b.column);
+		}
+		friend inline bool operator==(TileKey a, TileKey b) {
+			return (a.level == b.level)
+				&& (a.row == b.row)
+				&& (a.column == b.column);
+		}
+	};
+	struct Tile {
+		QImage image;
+		int lastUsed = 0;
+	};
+
+	[[nodiscard]] int chooseLevel(float64 scale) const;
+	[[nodiscard]] QSize levelSize(int level) const;
+	[[nodiscard]] QRect tileRect(TileKey key) const;
+	[[nodiscard]] bool wanted(TileKey key) const;
+	void request(TileKey key);
+	void tileDecoded(TileKey key, QImage image);
+	void clearStale();
+
+	const std::shared_ptr<Shared> _shared;
+	const QSize _size;
+	const Fn<void()> _tileReady;
+	QImage _preview;
+	int _levels = 0;
+
+	base::flat_map<TileKey, Tile> _tiles;
+	base::flat_set<TileKey> _requested;
+	int64 _tilesBytes = 0;
+	int _paintIndex = 0;
+
+	QImage _composed;
+	QRectF _composedSource;
+	bool _composedValid = false;
+
+};
+
+} // namespace Media::View
@@ -0,0 +1,162 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include <QtCore/QReadWriteLock>
+
+#include <array>
+#include <atomic>
+#include <map>
+#include <optional>
+
+namespace MTP::details {
+
+struct RequestRegistryStats {
+	uint64 locks = 0;
+	uint64 contended = 0;
+
+	RequestRegistryStats &operator+=(const RequestRegistryStats &other) {
+		locks += other.locks;
+		contended += other.contended;
+		return *this;
+	}
+};
+
+// Map by request id split into independently locked shards.
+// Request ids are sequential, so neighbouring requests sent from
+// different threads end up in different shards.
+template <typename Value>
+class RequestRegistry final {
+public:
+	static constexpr auto kShardsCount = 16;
+
+	bool emplace(mtpRequestId requestId, Value &&value) {
+		auto &shard = shardFor(requestId);
+		WriteGuard guard(shard);
+		return shard.map.emplace(requestId, std::move(value)).second;
+	}
+	void set(mtpRequestId requestId, Value value) {
+		auto &shard = shardFor(requestId);
+		WriteGuard guard(shard);
+		shard.map.insert_or_assign(requestId, std::move(value));
+	}
+	bool remove(mtpRequestId requestId) {
+		auto &shard = shardFor(requestId);
+		WriteGuard guard(shard);
+		return (shard.map.erase(requestId) > 0);
+	}
+	[[nodiscard]] std::optional<Value> take(mtpRequestId requestId) {
+		auto &shard = shardFor(requestId);
+		WriteGuard guard(shard);
+		const auto i = shard.map.find(requestId);
+		if (i == end(shard.map)) {
+			return std::nullopt;
+		}
+		auto result = std::make_optional(std::move(i->second));
+		shard.map.erase(i);
+		return result;
+	}
+
+	// Calls method(Value&) under the shard lock, returns its result.
+	template <typename Method>
+	[[nodiscard]] auto modify(mtpRequestId requestId, Method &&method)
+	-> std::optional<decltype(method(std::declval<Value&>()))> {
+		auto &shard = shardFor(requestId);
+		WriteGuard guard(shard);
+		const auto i = shard.map.find(requestId);
+		if (i == end(shard.map)) {
+			return std::nullopt;
+		}
+		return method(i->second);
+	}
+
+	[[nodiscard]] std::optional<Value> find(mtpRequestId requestId) const {
+		const auto &shard = shardFor(requestId);
+		ReadGuard guard(shard);
+		const auto i = shard.map.find(requestId);
+		if (i == end(shard.map)) {
+			return std::nullopt;
+		}
+		return i->second;
+	}
+	[[nodiscard]] bool contains(mtpRequestId requestId) const {
+		const auto &shard = shardFor(requestId);
+		ReadGuard guard(shard);
+		return shard.map.find(requestId) != end(shard.map);
+	}
+
+	[[nodiscard]] RequestRegistryStats stats() const {
+		auto result = RequestRegistryStats();
+		for (const auto &shard : _shards) {
+			result += RequestRegistryStats{
+				shard.locks.load(std::memory_order_relaxed),
+				shard.contended.load(std::memory_order_relaxed),
+			};
+		}
+		return result;
+	}
+
+private:
+	// The counters are kept in each shard, so that operations on
+	// different shards don't write to a shared cache line.
+	struct alignas(64) Shard {
+		mutable QReadWriteLock lock;
+		mutable std::atomic<uint64> locks = 0;
+		mutable std::atomic<uint64> contended = 0;
+		std::map<mtpRequestId, Value> map;
+
+		void countLock(bool uncontended) const {
+			locks.fetch_add(1, std::memory_order_relaxed);
+			if (!uncontended) {
+				contended.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+	};
+
+	class ReadGuard final {
+	public:
+		explicit ReadGuard(const Shard &shard) : _lock(shard.lock) {
+			shard.countLock(_lock.tryLockForRead()
+				|| (_lock.lockForRead(), false));
+		}
+		~ReadGuard() {
+			_lock.unlock();
+		}
+
+	private:
+		QReadWriteLock &_lock;
+
+	};
+
+	class WriteGuard final {
+	public:
+		explicit WriteGuard(const Shard &shard) : _lock(shard.lock) {
+			shard.countLock(_lock.tryLockForWrite()
+				|| (_lock.lockForWrite(), false));
+		}
+		~WriteGuard() {
+			_lock.unlock();
+		}
+
+	private:
+		QReadWriteLock &_lock;
+
+	};
+
+	[[nodiscard]] Shard &shardFor(mtpRequestId requestId) {
+		return _shards[uint32(requestId) % kShardsCount];
+	}
+	[[nodiscard]] const Shard &shardFor(mtpRequestId requestId) const {
+		return _shards[uint32(requestId) % kShardsCount];
+	}
+
+	std::array<Shard, kShardsCount> _shards;
+
+};
+
+} // namespace MTP::details
@@ -9,6 +9,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "mtproto/details/mtproto_dcenter.h"
 #include "mtproto/details/mtproto_rsa_public_key.h"
+#include "mtproto/details/mtproto_request_registry.h"
 #include "mtproto/special_config_request.h"
 #include "mtproto/session.h"
 #include "mtproto/mtproto_config.h"
@@ -66,6 +67,7 @@ public:
 	[[nodiscard]] DcOptions &dcOptions() const;
 	[[nodiscard]] Environment environment() const;
 	[[nodiscard]] bool isTestMode() const;
+	[[nodiscard]] RequestRegistryStats requestRegistryStats() const;
 
 	void resolveProxyDomain(const QString &host);
 	void setGoodProxyDomain(const QString &host, const QString &ip);
@@ -256,17 +258,13 @@ private:
 	rpl::event_stream<> _allKeysDestroyed;
 
 	// holds dcWithShift for request to this dc or -dc for request to main dc
-	std::map<mtpRequestId, ShiftedDcId> _requestsByDc;
-	mutable QMutex _requestByDcLock;
+	RequestRegistry<ShiftedDcId> _requestsByDc;
 
 	// holds target dcWithShift for auth export request
 	std::map<mtpRequestId, ShiftedDcId> _authExportRequests;
 
-	std::map<mtpRequestId, ResponseHandler> _parserMap;
-	mutable QMutex _parserMapLock;
-
-	std::map<mtpRequestId, SerializedRequest> _requestMap;
-	QReadWriteLock _requestMapLock;
+	RequestRegistry<ResponseHandler> _parserMap;
+	RequestRegistry<SerializedRequest> _requestMap;
 
 	std::deque<std::pair<mtpRequestId, crl::time>> _delayedRequests;
 	base::flat_map<mtpRequestId, mtpRequestId> _dependentRequests;
@@ -647,13 +645,8 @@ void Instance::Private::cancel(mtpRequestId requestId) {
 	DEBUG_LOG(("MTP Info: Cancel request %1.").arg(requestId));
 	const auto shiftedDcId = queryRequestByDc(requestId);
 	auto msgId = mtpMsgId(0);
-	{
-		QWriteLocker locker(&_requestMapLock);
-		auto it = _requestMap.find(requestId);
-		if (it != _requestMap.end()) {
-			msgId = *(mtpMsgId*)(it->second->constData() + 4);
-			_requestMap.erase(it);
-		}
+	if (const auto request = _requestMap.take(requestId)) {
+		msgId = *(mtpMsgId*)((*request)->constData() + 4);
 	}
 	unregisterRequest(requestId);
 	if (shiftedDcId) {
@@ -661,8 +654,7 @@ void Instance::Private::cancel(mtpRequestId requestId) {
 		session->cancel(requestId, msgId);
 	}
 
-	QMutexLocker locker(&_parserMapLock);
-	_parserMap.erase(requestId);
+	_parserMap.remove(requestId);
 }
 
 // result < 0 means waiting for such count of ms.
@@ -886,6 +878,13 @@ bool Instance::Private::isTestMode() const {
 	return _config->isTestMode();
 }
 
+RequestRegistryStats Instance::Private::requestRegistryStats() const {
+	auto result = _requestsByDc.stats();
+	result += _parserMap.stats();
+	result += _requestMap.stats();
+	return result;
+}
+
 QString Instance::Private::deviceModel() const {
 	QMutexLocker lock(&_deviceModelMutex);
 	return _customDeviceModel.isEmpty()
@@ -936,28 +935,18 @@ bool Instance::Private::configLoadFail(const Error &error) {
 
 std::optional<ShiftedDcId> Instance::Private::queryRequestByDc(
 		mtpRequestId requestId) const {
-	QMutexLocker locker(&_requestByDcLock);
-	auto it = _requestsByDc.find(requestId);
-	if (it != _requestsByDc.cend()) {
-		return it->second;
-	}
-	return std::nullopt;
+	return _requestsByDc.find(requestId);
 }
 
 std::optional<ShiftedDcId> Instance::Private::changeRequestByDc(
 		mtpRequestId requestId,
 		DcId newdc) {
-	QMutexLocker locker(&_requestByDcLock);
-	auto it = _requestsByDc.find(requestId);
-	if (it != _requestsByDc.cend()) {
-		if (it->second < 0) {
-			it->second = -newdc;
-		} else {
-			it->second = ShiftDcId(newdc, GetDcIdShift(it->second));
-		}
-		return it->second;
-	}
-	return std::nullopt;
+	return _requestsByDc.modify(requestId, [&](ShiftedDcId &shiftedDcId) {
+		shiftedDcId = (shiftedDcId < 0)
+			? -newdc
+			: ShiftDcId(newdc, GetDcIdShift(shiftedDcId));
+		return shiftedDcId;
+	});
 }
 
 void Instance::Private::checkDelayedRequests() {
@@ -974,18 +963,13 @@ void Instance::Private::checkDelayedRequests() {
 			continue;
 		}
 
-		auto request = SerializedRequest();
-		{
-			QReadLocker locker(&_requestMapLock);
-			auto it = _requestMap.find(requestId);
-			if (it == _requestMap.cend()) {
-				DEBUG_LOG(("MTP Error: could not find request %1").arg(requestId));
-				continue;
-			}
-			request = it->second;
+		const auto request = _requestMap.find(requestId);
+		if (!request) {
+			DEBUG_LOG(("MTP Error: could not find request %1").arg(requestId));
+			continue;
 		}
 		const auto session = getSession(qAbs(dcWithShift));
-		session->sendPrepared(request);
+		session->sendPrepared(*request);
 	}
 
 	if (!_delayedRequests.empty()) {
@@ -1023,8 +1007,7 @@ void Instance::Private::sendRequest(
 void Instance::Private::registerRequest(
 		mtpRequestId requestId,
 		ShiftedDcId shiftedDcId) {
-	QMutexLocker locker(&_requestByDcLock);
-	_requestsByDc[requestId] = shiftedDcId;
+	_requestsByDc.set(requestId, shiftedDcId);
 }
 
 void Instance::Private::unregisterRequest(mtpRequestId requestId) {
@@ -1032,14 +1015,8 @@ void Instance::Private::unregisterRequest(mtpRequestId requestId) {
 
 	_requestsDelays.erase(requestId);
 
-	{
-		QWriteLocker locker(&_requestMapLock);
-		_requestMap.erase(requestId);
-	}
-	{
-		QMutexLocker locker(&_requestByDcLock);
-		_requestsByDc.erase(requestId);
-	}
+	_requestMap.remove(requestId);
+	_requestsByDc.remove(requestId);
 	{
 		auto toRemove = base::flat_set<mtpRequestId>();
 		auto toResend = base::flat_set<mtpRequestId>();
@@ -1066,17 +1043,12 @@ void Instance::Private::unregisterRequest(mtpRequestId requestId) {
 
 		for (const auto resendingId : toResend) {
 			if (const auto shiftedDcId = queryRequestByDc(resendingId)) {
-				SerializedRequest request;
-				{
-					QReadLocker locker(&_requestMapLock);
-					auto it = _requestMap.find(resendingId);
-					if (it == _requestMap.cend()) {
-						LOG(("MTP Error: could not find dependent request %1").arg(resendingId));
-						return;
-					}
-					request = it->second;
+				const auto request = _requestMap.find(resendingId);
+				if (!request) {
+					LOG(("MTP Error: could not find dependent request %1").arg(resendingId));
+					return;
 				}
-				getSession(qAbs(*shiftedDcId))->sendPrepared(request);
+				getSession(qAbs(*shiftedDcId))->sendPrepared(*request);
 			}
 		}
 	}
@@ -1087,45 +1059,26 @@ void Instance::Private::storeRequest(
 		const SerializedRequest &request,
 		ResponseHandler &&callbacks) {
 	if (callbacks.done || callbacks.fail) {
-		QMutexLocker locker(&_parserMapLock);
 		_parserMap.emplace(requestId, std::move(callbacks));
 	}
-	{
-		QWriteLocker locker(&_requestMapLock);
-		_requestMap.emplace(requestId, request);
-	}
+	_requestMap.emplace(requestId, SerializedRequest(request));
 }
 
 SerializedRequest Instance::Private::getRequest(mtpRequestId requestId) {
-	auto result = SerializedRequest();
-	{
-		QReadLocker locker(&_requestMapLock);
-		auto it = _requestMap.find(requestId);
-		if (it != _requestMap.cend()) {
-			result = it->second;
-		}
-	}
-	return result;
+	return _requestMap.find(requestId).value_or(SerializedRequest());
 }
 
 bool Instance::Private::hasCallback(mtpRequestId requestId) const {
-	QMutexLocker locker(&_parserMapLock);
-	auto it = _parserMap.find(requestId);
-	return (it != _parserMap.cend());
+	return _parserMap.contains(requestId);
 }
 
 void Instance::Private::processCallback(const Response &response) {
 	const auto requestId = response.requestId;
 	ResponseHandler handler;
-	{
-		QMutexLocker locker(&_parserMapLock);
-		auto it = _parserMap.find(requestId);
-		if (it != _parserMap.cend()) {
-			handler = std::move(it->second);
-			_parserMap.erase(it);
+	if (auto found = _parserMap.take(requestId)) {
+		handler = std::move(*found);
 
-			DEBUG_LOG(("RPC Info: found parser for request %1, trying to parse response...").arg(requestId));
-		}
+		DEBUG_LOG(("RPC Info: found parser for request %1, trying to parse response...").arg(requestId));
 	}
 	if (handler.done || handler.fail) {
 		const auto handleError = [&](const Error &error) {
@@ -1137,7 +1090,6 @@ void Instance::Private::processCallback(const Response &response) {
 			if (rpcErrorOccured(response, handler, error)) {
 				unregisterRequest(requestId);
 			} else {
-				QMutexLocker locker(&_parserMapLock);
 				_parserMap.emplace(requestId, std::move(handler));
 			}
 		};
@@ -1239,10 +1191,9 @@ void Instance::Private::importDone(
 
 	auto &waiters = _authWaiters[newdc];
 	if (waiters.size()) {
-		QReadLocker locker(&_requestMapLock);
 		for (auto waitedRequestId : waiters) {
-			auto it = _requestMap.find(waitedRequestId);
-			if (it == _requestMap.cend()) {
+			const auto request = _requestMap.find(waitedRequestId);
+			if (!request) {
 				LOG(("MTP Error: could not find request %1 for resending").arg(waitedRequestId));
 				continue;
 			}
@@ -1255,7 +1206,7 @@ void Instance::Private::importDone(
 			}
 			DEBUG_LOG(("MTP Info: resending request %1 to dc %2 after import auth").arg(waitedRequestId).arg(*shiftedDcId));
 			const auto session = getSession(*shiftedDcId);
-			session->sendPrepared(it->second);
+			session->sendPrepared(*request);
 		}
 		waiters.clear();
 	}
@@ -1390,15 +1341,11 @@ bool Instance::Private::onErrorDefault(
 			newdcWithShift = ShiftDcId(newdcWithShift, GetDcIdShift(dcWithShift));
 		}
 
-		auto request = SerializedRequest();
-		{
-			QReadLocker locker(&_requestMapLock);
-			auto it = _requestMap.find(requestId);
-			if (it == _requestMap.cend()) {
-				LOG(("MTP Error: could not find request %1").arg(requestId));
-				return false;
-			}
-			request = it->second;
+		auto request = _requestMap.find(requestId).value_or(
+			SerializedRequest());
+		if (!request) {
+			LOG(("MTP Error: could not find request %1").arg(requestId));
+			return false;
 		}
 		const auto session = getSession(newdcWithShift);
 		registerRequest(
@@ -1407,15 +1354,11 @@ bool Instance::Private::onErrorDefault(
 		session->sendPrepared(request);
 		return true;
 	} else if (type == qstr("MSG_WAIT_TIMEOUT") || type == qstr("MSG_WAIT_FAILED")) {
-		SerializedRequest request;
-		{
-			QReadLocker locker(&_requestMapLock);
-			auto it = _requestMap.find(requestId);
-			if (it == _requestMap.cend()) {
-				LOG(("MTP Error: could not find MSG_WAIT_* request %1").arg(requestId));
-				return false;
-			}
-			request = it->second;
+		auto request = _requestMap.find(requestId).value_or(
+			SerializedRequest());
+		if (!request) {
+			LOG(("MTP Error: could not find MSG_WAIT_* request %1").arg(requestId));
+			return false;
 		}
 		if (!request->after) {
 			LOG(("MTP Error: MSG_WAIT_* for not dependent request %1").arg(requestId));
@@ -1517,15 +1460,11 @@ bool Instance::Private::onErrorDefault(
 		return true;
 	} else if (type == qstr("CONNECTION_NOT_INITED")
 		|| type == qstr("CONNECTION_LAYER_INVALID")) {
-		SerializedRequest request;
-		{
-			QReadLocker locker(&_requestMapLock);
-			auto it = _requestMap.find(requestId);
-			if (it == _requestMap.cend()) {
-				LOG(("MTP Error: could not find request %1").arg(requestId));
-				return false;
-			}
-			request = it->second;
+		auto request = _requestMap.find(requestId).value_or(
+			SerializedRequest());
+		if (!request) {
+			LOG(("MTP Error: could not find request %1").arg(requestId));
+			return false;
 		}
 		auto dcWithShift = ShiftedDcId(0);
 		if (const auto shiftedDcId = queryRequestByDc(requestId)) {
@@ -1765,6 +1704,11 @@ void Instance::Private::prepareToDestroy() {
 	// It accesses Instance in destructor, so it should be destroyed first.
 	_configLoader.reset();
 
+	const auto stats = requestRegistryStats();
+	DEBUG_LOG(("MTP Info: request registry locks %1, contended %2."
+		).arg(stats.locks
+		).arg(stats.contended));
+
 	requestCancellingDiscard();
 
 	for (const auto &[shiftedDcId, session] : base::take(_sessions)) {
@@ -1954,6 +1898,10 @@ Environment Instance::environment() const {
 	return _private->environment();
 }
 
+details::RequestRegistryStats Instance::requestRegistryStats() const {
+	return _private->requestRegistryStats();
+}
+
 bool Instance::isTestMode() const {
 	return _private->isTestMode();
 }
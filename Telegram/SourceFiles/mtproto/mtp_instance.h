@@ -15,6 +15,7 @@ namespace details {
 
 class Dcenter;
 class Session;
+struct RequestRegistryStats;
 
 [[nodiscard]] int GetNextRequestId();
 
@@ -78,6 +79,7 @@ public:
 	[[nodiscard]] const ConfigFields &configValues() const;
 	[[nodiscard]] DcOptions &dcOptions() const;
 	[[nodiscard]] Environment environment() const;
+	[[nodiscard]] details::RequestRegistryStats requestRegistryStats() const;
 	[[nodiscard]] bool isTestMode() const;
 	[[nodiscard]] QString deviceModel() const;
 	[[nodiscard]] QString systemVersion() const;
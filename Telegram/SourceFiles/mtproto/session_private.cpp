@@ -51,6 +51,10 @@ constexpr auto kRequestConfigTimeout = 8 * crl::time(1000);
 // Don't try to handle messages larger than this size.
 constexpr auto kMaxMessageLength = 16 * 1024 * 1024;
 
+// Inflated buffers are kept for the next gzip_packed in the connection.
+constexpr auto kUngzipBuffersPoolSize = 2;
+constexpr auto kMaxPooledUngzipBuffer = 1024 * 1024 / kIntSize;
+
 // How much time passed from send till we resend request or check its state.
 constexpr auto kCheckSentRequestTimeout = 10 * crl::time(1000);
 
@@ -65,6 +69,44 @@ auto SyncTimeRequestDuration = kFastRequestDuration;
 
 using namespace details;
 
+// Reads the bytes of a serialized string in place, without a copy.
+[[nodiscard]] bytes::const_span ReadPackedBytes(
+		const mtpPrime *from,
+		const mtpPrime *end) {
+	const auto available = int(end - from) * kIntSize;
+	if (available < kIntSize) {
+		return {};
+	}
+	const auto data = reinterpret_cast<const uchar*>(from);
+	const auto full = (data[0] == 254);
+	const auto offset = full ? 4 : 1;
+	const auto length = full
+		? (int(data[1]) | (int(data[2]) << 8) | (int(data[3]) << 16))
+		: int(data[0]);
+	if (data[0] == 255 || offset + length > available) {
+		return {};
+	}
+	return bytes::make_span(data + offset, length);
+}
+
+// The gzip trailer ends with the unpacked size modulo 2^32.
+[[nodiscard]] int UnpackedSizeHint(bytes::const_span packed) {
+	const auto size = int(packed.size());
+	const auto minimal = size * 2;
+	if (size < 4) {
+		return minimal;
+	}
+	const auto data = reinterpret_cast<const uchar*>(packed.data());
+	const auto hint = uint32(data[size - 4])
+		| (uint32(data[size - 3]) << 8)
+		| (uint32(data[size - 2]) << 16)
+		| (uint32(data[size - 1]) << 24);
+	return std::clamp(
+		int(std::min(hint, uint32(kMaxMessageLength))),
+		std::min(minimal, kMaxMessageLength),
+		kMaxMessageLength);
+}
+
 [[nodiscard]] QString LogIdsVector(const QVector<MTPlong> &ids) {
 	if (!ids.size()) return "[]";
 	auto idsStr = QString("[%1").arg(ids.cbegin()->v);
@@ -1427,11 +1469,17 @@ SessionPrivate::HandleResult SessionPrivate::handleOneReceived(
 
 	case mtpc_gzip_packed: {
 		DEBUG_LOG(("Message Info: gzip container"));
-		mtpBuffer response = ungzip(++from, end);
-		if (response.empty()) {
+		auto response = takeUngzipBuffer();
+		if (!ungzip(++from, end, response)) {
 			return HandleResult::RestartConnection;
 		}
-		return handleOneReceived(response.data(), response.data() + response.size(), msgId, info);
+		const auto result = handleOneReceived(
+			response.data(),
+			response.data() + response.size(),
+			msgId,
+			info);
+		releaseUngzipBuffer(std::move(response));
+		return result;
 	}
 
 	case mtpc_msg_container: {
@@ -1797,8 +1845,8 @@ SessionPrivate::HandleResult SessionPrivate::handleOneReceived(
 		mtpTypeId typeId = from[0];
 		if (typeId == mtpc_gzip_packed) {
 			DEBUG_LOG(("RPC Info: gzip container"));
-			response = ungzip(++from, end);
-			if (response.empty()) {
+			response = takeUngzipBuffer();
+			if (!ungzip(++from, end, response)) {
 				return HandleResult::RestartConnection;
 			}
 			typeId = response[0];
@@ -1971,16 +2019,35 @@ SessionPrivate::HandleResult SessionPrivate::handleBindResponse(
 	Unexpected("Result of BoundKeyCreator::handleBindResponse.");
 }
 
-mtpBuffer SessionPrivate::ungzip(const mtpPrime *from, const mtpPrime *end) const {
-	mtpBuffer result; // * 4 because of mtpPrime type
+mtpBuffer SessionPrivate::takeUngzipBuffer() {
+	if (_ungzipBuffers.empty()) {
+		return mtpBuffer();
+	}
+	auto result = std::move(_ungzipBuffers.back());
+	_ungzipBuffers.pop_back();
+	return result;
+}
+
+void SessionPrivate::releaseUngzipBuffer(mtpBuffer &&buffer) {
+	if (int(_ungzipBuffers.size()) < kUngzipBuffersPoolSize
+		&& buffer.capacity() <= kMaxPooledUngzipBuffer) {
+		buffer.resize(0);
+		_ungzipBuffers.push_back(std::move(buffer));
+	}
+}
+
+bool SessionPrivate::ungzip(
+		const mtpPrime *from,
+		const mtpPrime *end,
+		mtpBuffer &result) const {
 	result.resize(0);
 
-	MTPstring packed;
-	if (!packed.read(from, end)) { // read packed string as serialized mtp string type
+	const auto packed = ReadPackedBytes(from, end);
+	if (packed.empty()) {
 		LOG(("RPC Error: could not read gziped bytes."));
-		return result;
+		return false;
 	}
-	uint32 packedLen = packed.v.size(), unpackedChunk = packedLen;
+	const auto packedLen = int(packed.size());
 
 	z_stream stream;
 	stream.zalloc = 0;
@@ -1991,36 +2058,45 @@ mtpBuffer SessionPrivate::ungzip(const mtpPrime *from, const mtpPrime *end) cons
 	int res = inflateInit2(&stream, 16 + MAX_WBITS);
 	if (res != Z_OK) {
 		LOG(("RPC Error: could not init zlib stream, code: %1").arg(res));
-		return result;
+		return false;
 	}
 	stream.avail_in = packedLen;
-	stream.next_in = reinterpret_cast<Bytef*>(packed.v.data());
-
-	stream.avail_out = 0;
-	while (!stream.avail_out) {
-		result.resize(result.size() + unpackedChunk);
-		stream.avail_out = unpackedChunk * sizeof(mtpPrime);
-		stream.next_out = (Bytef*)&result[result.size() - unpackedChunk];
-		int res = inflate(&stream, Z_NO_FLUSH);
+	stream.next_in = reinterpret_cast<Bytef*>(
+		const_cast<bytes::type*>(packed.data()));
+
+	// Leave a spare int so that the stream end fits in the first chunk.
+	const auto hint = UnpackedSizeHint(packed);
+	result.resize(hint / kIntSize + 1);
+	stream.avail_out = result.size() * kIntSize;
+	stream.next_out = reinterpret_cast<Bytef*>(result.data());
+	while (true) {
+		res = inflate(&stream, Z_NO_FLUSH);
 		if (res != Z_OK && res != Z_STREAM_END) {
 			inflateEnd(&stream);
 			LOG(("RPC Error: could not unpack gziped data, code: %1").arg(res));
-			DEBUG_LOG(("RPC Error: bad gzip: %1").arg(Logs::mb(packed.v.constData(), packedLen).str()));
-			return mtpBuffer();
+			DEBUG_LOG(("RPC Error: bad gzip: %1").arg(Logs::mb(packed.data(), packedLen).str()));
+			return false;
+		} else if (res == Z_STREAM_END || stream.avail_out) {
+			break;
 		}
+		const auto was = int(result.size());
+		result.resize(was + std::max(was / 2, packedLen / kIntSize + 1));
+		stream.avail_out = (result.size() - was) * kIntSize;
+		stream.next_out = reinterpret_cast<Bytef*>(result.data() + was);
 	}
+	inflateEnd(&stream);
 	if (stream.avail_out & 0x03) {
 		uint32 badSize = result.size() * sizeof(mtpPrime) - stream.avail_out;
 		LOG(("RPC Error: bad length of unpacked data %1").arg(badSize));
 		DEBUG_LOG(("RPC Error: bad unpacked data %1").arg(Logs::mb(result.data(), badSize).str()));
-		return mtpBuffer();
+		return false;
 	}
 	result.resize(result.size() - (stream.avail_out >> 2));
-	inflateEnd(&stream);
 	if (!result.size()) {
 		LOG(("RPC Error: bad length of unpacked data 0"));
+		return false;
 	}
-	return result;
+	return true;
 }
 
 bool SessionPrivate::requestsFixTimeSalt(const QVector<MTPlong> &ids, const OuterInfo &info) {
@@ -133,7 +133,12 @@ private:
 	[[nodiscard]] HandleResult handleBindResponse(
 		mtpMsgId requestMsgId,
 		const mtpBuffer &response);
-	mtpBuffer ungzip(const mtpPrime *from, const mtpPrime *end) const;
+	[[nodiscard]] bool ungzip(
+		const mtpPrime *from,
+		const mtpPrime *end,
+		mtpBuffer &result) const;
+	[[nodiscard]] mtpBuffer takeUngzipBuffer();
+	void releaseUngzipBuffer(mtpBuffer &&buffer);
 	void handleMsgsStates(const QVector<MTPlong> &ids, const QByteArray &states);
 
 	// _sessionDataMutex must be locked for read.
@@ -233,6 +238,7 @@ private:
 	base::flat_map<mtpMsgId, mtpRequestId> _ackedIds;
 	base::flat_map<mtpMsgId, SerializedRequest> _stateAndResendRequests;
 	base::flat_map<mtpMsgId, SentContainer> _sentContainers;
+	std::vector<mtpBuffer> _ungzipBuffers;
 
 	std::unique_ptr<BoundKeyCreator> _keyCreator;
 	mtpMsgId _bindMsgId = 0;
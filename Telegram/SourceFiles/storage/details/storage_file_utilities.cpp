@@ -25,13 +25,93 @@ constexpr auto TdfMagicLen = int(sizeof(TdfMagic));
 
 constexpr auto kStrongIterationsCount = 100'000;
 
+// Chunks are serialized and encrypted on the writing thread.
 struct WriteEntry {
 	QString basePath;
 	QString base;
+	std::vector<WriteChunk> chunks;
 	QByteArray data;
 	QByteArray md5;
+	quint64 journalGeneration = 0;
+	bool resetJournal = false;
+	bool appendToJournal = false;
 };
 
+[[nodiscard]] QByteArray PrepareEncryptedData(
+		QByteArray toEncrypt,
+		const MTP::AuthKeyPtr &key) {
+	// prepare for encryption
+	uint32 size = toEncrypt.size(), fullSize = size;
+	if (fullSize & 0x0F) {
+		fullSize += 0x10 - (fullSize & 0x0F);
+		toEncrypt.resize(fullSize);
+		base::RandomFill(toEncrypt.data() + size, fullSize - size);
+	}
+	*(uint32*)toEncrypt.data() = size;
+	QByteArray encrypted(0x10 + fullSize, Qt::Uninitialized); // 128bit of sha1 - key128, sizeof(data), data
+	hashSha1(toEncrypt.constData(), toEncrypt.size(), encrypted.data());
+	MTP::aesEncryptLocal(toEncrypt.constData(), encrypted.data() + 0x10, fullSize, key, encrypted.constData());
+
+	return encrypted;
+}
+
+// The journal file is opened for reading and positioned after its header.
+[[nodiscard]] std::optional<quint64> ReadJournalHeader(QFile &file) {
+	char magic[TdfMagicLen];
+	qint32 version = 0;
+	quint64 generation = 0;
+	if (file.read(magic, TdfMagicLen) != TdfMagicLen
+		|| memcmp(magic, TdfMagic, TdfMagicLen)
+		|| file.read((char*)&version, sizeof(version)) != sizeof(version)
+		|| version > AppVersion
+		|| file.read((char*)&generation, sizeof(generation))
+			!= sizeof(generation)) {
+		return std::nullopt;
+	}
+	return generation;
+}
+
+[[nodiscard]] QByteArray PrepareChunk(const WriteChunk &chunk) {
+	return chunk.key
+		? PrepareEncryptedData(chunk.data, chunk.key)
+		: chunk.data;
+}
+
+void PrepareEntry(WriteEntry &entry) {
+	auto chunks = base::take(entry.chunks);
+	if (entry.appendToJournal) {
+		Assert(chunks.size() == 1);
+		entry.data = PrepareChunk(chunks.front());
+		return;
+	}
+
+	QBuffer buffer(&entry.data);
+	const auto opened = buffer.open(QIODevice::WriteOnly);
+	Assert(opened);
+	QDataStream stream(&buffer);
+	auto md5 = HashMd5();
+	auto fullSize = 0;
+	for (const auto &chunk : chunks) {
+		const auto data = PrepareChunk(chunk);
+		stream << data;
+		quint32 len = data.isNull() ? 0xffffffff : data.size();
+		if (QSysInfo::ByteOrder != QSysInfo::BigEndian) {
+			len = qbswap(len);
+		}
+		md5.feed(&len, sizeof(len));
+		md5.feed(data.constData(), data.size());
+		fullSize += sizeof(len) + data.size();
+	}
+	stream.setDevice(nullptr);
+	buffer.close();
+
+	md5.feed(&fullSize, sizeof(fullSize));
+	qint32 version = AppVersion;
+	md5.feed(&version, sizeof(version));
+	md5.feed(TdfMagic, TdfMagicLen);
+	entry.md5 = QByteArray((const char*)md5.result(), 0x10);
+}
+
 class WriteManager final {
 public:
 	explicit WriteManager(crl::weak_on_thread<WriteManager> weak);
@@ -45,6 +125,10 @@ private:
 	void writeScheduled();
 	bool writeOneScheduledNow();
 	void writeNow(WriteEntry &&entry);
+	void dropScheduled(const QString &base);
+	bool writeSnapshotNow(const WriteEntry &entry);
+	void appendToJournalNow(const WriteEntry &entry);
+	bool resetJournalNow(const WriteEntry &entry);
 
 	template <typename File>
 	[[nodiscard]] bool open(File &file, const WriteEntry &entry, char postfix);
@@ -77,24 +161,71 @@ WriteManager::WriteManager(crl::weak_on_thread<WriteManager> weak)
 }
 
 void WriteManager::write(WriteEntry &&entry) {
-	const auto i = ranges::find(_scheduled, entry.base, &WriteEntry::base);
-	if (i == end(_scheduled)) {
-		_scheduled.push_back(std::move(entry));
-	} else {
-		*i = std::move(entry);
+	if (!entry.appendToJournal) {
+		dropScheduled(entry.base);
 	}
+	_scheduled.push_back(std::move(entry));
 	scheduleWrite();
 }
 
 void WriteManager::writeSync(WriteEntry &&entry) {
-	const auto i = ranges::find(_scheduled, entry.base, &WriteEntry::base);
-	if (i != end(_scheduled)) {
-		_scheduled.erase(i);
-	}
+	dropScheduled(entry.base);
 	writeNow(std::move(entry));
 }
 
+void WriteManager::dropScheduled(const QString &base) {
+	// A snapshot includes everything scheduled for its file before it,
+	// the journal records after it are appended after its reset.
+	_scheduled.erase(
+		ranges::remove(_scheduled, base, &WriteEntry::base),
+		end(_scheduled));
+}
+
 void WriteManager::writeNow(WriteEntry &&entry) {
+	PrepareEntry(entry);
+	if (entry.appendToJournal) {
+		appendToJournalNow(entry);
+	} else if (writeSnapshotNow(entry) && entry.resetJournal) {
+		resetJournalNow(entry);
+	}
+}
+
+bool WriteManager::resetJournalNow(const WriteEntry &entry) {
+	auto file = QFile(path(entry, 'j'));
+	if (!writeHeader(entry.basePath, file)) {
+		LOG(("Storage Error: Could not reset '%1'.").arg(file.fileName()));
+		return false;
+	}
+	const auto generation = entry.journalGeneration;
+	file.write((const char*)&generation, sizeof(generation));
+	base::Platform::FlushFileData(file);
+	return true;
+}
+
+void WriteManager::appendToJournalNow(const WriteEntry &entry) {
+	auto file = QFile(path(entry, 'j'));
+	const auto generation = file.open(QIODevice::ReadOnly)
+		? ReadJournalHeader(file)
+		: std::nullopt;
+	file.close();
+	if (generation && *generation > entry.journalGeneration) {
+		// A newer snapshot already includes this record.
+		return;
+	} else if (generation != entry.journalGeneration
+		&& !resetJournalNow(entry)) {
+		return;
+	} else if (!file.open(QIODevice::Append)) {
+		LOG(("Storage Error: Could not open '%1' for appending."
+			).arg(file.fileName()));
+		return;
+	}
+	const auto size = quint32(entry.data.size());
+	file.write((const char*)&size, sizeof(size));
+	file.write(entry.data);
+	base::Platform::FlushFileData(file);
+}
+
+bool WriteManager::writeSnapshotNow(const WriteEntry &entry) {
 	const auto path = [&](char postfix) {
 		return this->path(entry, postfix);
 	};
@@ -114,7 +245,7 @@ void WriteManager::writeNow(WriteEntry &&entry) {
 		if (save.commit()) {
 			QFile::remove(simple);
 			QFile::remove(backup);
-			return;
+			return true;
 		}
 		LOG(("Storage Error: Could not commit '%1'.").arg(safe));
 	}
@@ -126,13 +257,14 @@ void WriteManager::writeNow(WriteEntry &&entry) {
 
 		QFile::remove(backup);
 		if (base::Platform::RenameWithOverwrite(simple, safe)) {
-			return;
+			return true;
 		}
 		QFile::remove(safe);
 		LOG(("Storage Error: Could not rename '%1' to '%2', removing.").arg(
 			simple,
 			safe));
 	}
+	return false;
 }
 
 void WriteManager::writeSyncAll() {
@@ -288,6 +420,8 @@ void ClearKey(const FileKey &key, const QString &basePath) {
 	QFile::remove(name);
 	name[name.size() - 1] = 's';
 	QFile::remove(name);
+	name[name.size() - 1] = 'j';
+	QFile::remove(name);
 }
 
 bool CheckStreamStatus(QDataStream &stream) {
@@ -398,50 +532,42 @@ FileWriteDescriptor::~FileWriteDescriptor() {
 
 void FileWriteDescriptor::init(const QString &name) {
 	_base = _basePath + name;
-	_buffer.setBuffer(&_safeData);
-	const auto opened = _buffer.open(QIODevice::WriteOnly);
-	Assert(opened);
-	_stream.setDevice(&_buffer);
 }
 
 void FileWriteDescriptor::writeData(const QByteArray &data) {
-	if (!_stream.device()) {
+	if (_finished) {
 		return;
 	}
-	_stream << data;
-	quint32 len = data.isNull() ? 0xffffffff : data.size();
-	if (QSysInfo::ByteOrder != QSysInfo::BigEndian) {
-		len = qbswap(len);
-	}
-	_md5.feed(&len, sizeof(len));
-	_md5.feed(data.constData(), data.size());
-	_fullSize += sizeof(len) + data.size();
+	_chunks.push_back({ .data = data });
 }
 
 void FileWriteDescriptor::writeEncrypted(
 	EncryptedDescriptor &data,
 	const MTP::AuthKeyPtr &key) {
-	writeData(PrepareEncrypted(data, key));
+	if (_finished) {
+		return;
+	}
+	data.finish();
+	_chunks.push_back({ .data = data.data, .key = key });
+}
+
+void FileWriteDescriptor::resetJournal(quint64 generation) {
+	_resetJournal = true;
+	_journalGeneration = generation;
 }
 
 void FileWriteDescriptor::finish() {
-	if (!_stream.device()) {
+	if (_finished) {
 		return;
 	}
-
-	_stream.setDevice(nullptr);
-	_md5.feed(&_fullSize, sizeof(_fullSize));
-	qint32 version = AppVersion;
-	_md5.feed(&version, sizeof(version));
-	_md5.feed(TdfMagic, TdfMagicLen);
-
-	_buffer.close();
+	_finished = true;
 
 	auto entry = WriteEntry{
 		.basePath = _basePath,
 		.base = _base,
-		.data = _safeData,
-		.md5 = QByteArray((const char*)_md5.result(), 0x10)
+		.chunks = base::take(_chunks),
+		.journalGeneration = _journalGeneration,
+		.resetJournal = _resetJournal,
 	};
 	if (_sync) {
 		Manager.writeSync(std::move(entry));
@@ -454,21 +580,7 @@ void FileWriteDescriptor::finish() {
 		EncryptedDescriptor &data,
 		const MTP::AuthKeyPtr &key) {
 	data.finish();
-	QByteArray &toEncrypt(data.data);
-
-	// prepare for encryption
-	uint32 size = toEncrypt.size(), fullSize = size;
-	if (fullSize & 0x0F) {
-		fullSize += 0x10 - (fullSize & 0x0F);
-		toEncrypt.resize(fullSize);
-		base::RandomFill(toEncrypt.data() + size, fullSize - size);
-	}
-	*(uint32*)toEncrypt.data() = size;
-	QByteArray encrypted(0x10 + fullSize, Qt::Uninitialized); // 128bit of sha1 - key128, sizeof(data), data
-	hashSha1(toEncrypt.constData(), toEncrypt.size(), encrypted.data());
-	MTP::aesEncryptLocal(toEncrypt.constData(), encrypted.data() + 0x10, fullSize, key, encrypted.constData());
-
-	return encrypted;
+	return PrepareEncryptedData(base::take(data.data), key);
 }
 
 bool ReadFile(
@@ -665,6 +777,67 @@ bool ReadEncryptedFile(
 	return ReadEncryptedFile(result, ToFilePart(fkey), basePath, key);
 }
 
+void AppendToJournal(
+		const FileKey &fkey,
+		const QString &basePath,
+		quint64 generation,
+		EncryptedDescriptor &data,
+		const MTP::AuthKeyPtr &key) {
+	data.finish();
+	Manager.write({
+		.basePath = basePath,
+		.base = basePath + ToFilePart(fkey),
+		.chunks = { { .data = data.data, .key = key } },
+		.journalGeneration = generation,
+		.appendToJournal = true,
+	});
+}
+
+int ReadJournal(
+		const FileKey &fkey,
+		const QString &basePath,
+		quint64 generation,
+		const MTP::AuthKeyPtr &key,
+		Fn<void(QDataStream &stream)> record) {
+	const auto name = basePath + ToFilePart(fkey) + 'j';
+	QFile f(name);
+	if (!f.open(QIODevice::ReadOnly)) {
+		return 0;
+	}
+	const auto written = ReadJournalHeader(f);
+	if (!written) {
+		DEBUG_LOG(("App Info: bad journal header in '%1'").arg(name));
+		return 0;
+	} else if (*written != generation) {
+		// The snapshot was written, but the journal wasn't reset after it.
+		return 0;
+	}
+	auto result = 0;
+	while (!f.atEnd()) {
+		quint32 size = 0;
+		if (f.read((char*)&size, sizeof(size)) != sizeof(size)
+			|| size > f.size() - f.pos()) {
+			break;
+		}
+		auto data = EncryptedDescriptor();
+		if (!DecryptLocal(data, f.read(size), key)) {
+			break;
+		}
+		record(data.stream);
+		++result;
+	}
+	return result;
+}
+
+quint64 ReadJournalGeneration(
+		const FileKey &fkey,
+		const QString &basePath) {
+	QFile f(basePath + ToFilePart(fkey) + 'j');
+	return f.open(QIODevice::ReadOnly)
+		? ReadJournalHeader(f).value_or(0)
+		: 0;
+}
+
 void Sync() {
 	Manager.sync();
 }
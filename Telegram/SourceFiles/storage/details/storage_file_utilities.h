@@ -52,6 +52,13 @@ struct EncryptedDescriptor final {
 	EncryptedDescriptor &data,
 	const MTP::AuthKeyPtr &key);
 
+struct WriteChunk {
+	QByteArray data;
+	MTP::AuthKeyPtr key; // If not null the data is encrypted with it.
+};
+
+// Written data is encrypted and hashed on the storage writing thread,
+// in the order of the writes, and Finish() waits for all of it.
 class FileWriteDescriptor final {
 public:
 	FileWriteDescriptor(
@@ -69,17 +76,19 @@ public:
 		EncryptedDescriptor &data,
 		const MTP::AuthKeyPtr &key);
 
+	// After this file is written its journal is started anew.
+	void resetJournal(quint64 generation);
+
 private:
 	void init(const QString &name);
 	void finish();
 
 	const QString _basePath;
-	QBuffer _buffer;
-	QDataStream _stream;
-	QByteArray _safeData;
 	QString _base;
-	HashMd5 _md5;
-	int _fullSize = 0;
+	std::vector<WriteChunk> _chunks;
+	quint64 _journalGeneration = 0;
+	bool _resetJournal = false;
+	bool _finished = false;
 	bool _sync = false;
 
 };
@@ -106,6 +115,26 @@ bool ReadEncryptedFile(
 	const QString &basePath,
 	const MTP::AuthKeyPtr &key);
 
+// Small changes are appended to a journal of encrypted records next to
+// the file, they're applied only over the snapshot of the same generation.
+void AppendToJournal(
+	const FileKey &fkey,
+	const QString &basePath,
+	quint64 generation,
+	EncryptedDescriptor &data,
+	const MTP::AuthKeyPtr &key);
+int ReadJournal(
+	const FileKey &fkey,
+	const QString &basePath,
+	quint64 generation,
+	const MTP::AuthKeyPtr &key,
+	Fn<void(QDataStream &stream)> record);
+
+// Snapshots without a generation should continue after the journal's one.
+[[nodiscard]] quint64 ReadJournalGeneration(
+	const FileKey &fkey,
+	const QString &basePath);
+
 void Sync();
 void Finish();
 
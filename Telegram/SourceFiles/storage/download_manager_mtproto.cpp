@@ -19,7 +19,10 @@ namespace {
 
 constexpr auto kKillSessionTimeout = 15 * crl::time(1000);
 constexpr auto kStartWaitedInSession = 4 * kDownloadPartSize;
-constexpr auto kMaxWaitedInSession = 16 * kDownloadPartSize;
+constexpr auto kMinWaitedInSession = 4 * kDownloadPartSize;
+constexpr auto kMaxWaitedInSession = 8 * kDownloadPartSizeMax;
+constexpr auto kWaitedBandwidthDelayMultiplier = 2;
+constexpr auto kBytesPerSecondSmoothing = 0.25;
 constexpr auto kStartSessionsCount = 1;
 constexpr auto kMaxSessionsCount = 8;
 constexpr auto kMaxTrackedSessionRemoves = 64;
@@ -38,6 +41,16 @@ constexpr auto kBadRequestDurationThreshold = 8 * crl::time(1000);
 
 } // namespace
 
+int ChooseDownloadPartSize(int size) {
+	// Limit should divide 1MB and a request can't cross a 1MB boundary,
+	// so all the offsets in the file are multiples of the part size.
+	return (size >= 64 * 1024 * 1024)
+		? kDownloadPartSizeMax
+		: (size >= 8 * 1024 * 1024)
+		? (kDownloadPartSizeMax / 2)
+		: kDownloadPartSize;
+}
+
 void DownloadManagerMtproto::Queue::enqueue(
 		not_null<Task*> task,
 		int priority) {
@@ -177,6 +190,11 @@ void DownloadManagerMtproto::checkSendNextAfterSuccess(MTP::DcId dcId) {
 
 bool DownloadManagerMtproto::trySendNextPart(MTP::DcId dcId, Queue &queue) {
 	auto &balanceData = _balanceData[dcId];
+	const auto onlyHighestPriority = (balanceData.totalRequested > 0);
+	const auto task = queue.nextTask(onlyHighestPriority);
+	if (!task) {
+		return false;
+	}
 	const auto &sessions = balanceData.sessions;
 	const auto bestIndex = [&] {
 		const auto proj = [](const DcSessionBalanceData &data) {
@@ -185,19 +203,16 @@ bool DownloadManagerMtproto::trySendNextPart(MTP::DcId dcId, Queue &queue) {
 				: kMaxWaitedInSession;
 		};
 		const auto j = ranges::min_element(sessions, ranges::less(), proj);
-		return (j->requested + kDownloadPartSize <= j->maxWaitedAmount)
+		return (!j->requested
+			|| j->requested + task->partSize() <= j->maxWaitedAmount)
 			? (j - begin(sessions))
 			: -1;
 	}();
 	if (bestIndex < 0) {
 		return false;
 	}
-	const auto onlyHighestPriority = (balanceData.totalRequested > 0);
-	if (const auto task = queue.nextTask(onlyHighestPriority)) {
-		task->loadPart(bestIndex);
-		return true;
-	}
-	return false;
+	task->loadPart(bestIndex);
+	return true;
 }
 
 int DownloadManagerMtproto::changeRequestedAmount(
@@ -227,6 +242,7 @@ int DownloadManagerMtproto::changeRequestedAmount(
 void DownloadManagerMtproto::requestSucceeded(
 		MTP::DcId dcId,
 		int index,
+		int partSize,
 		int amountAtRequestStart,
 		crl::time timeAtRequestStart) {
 	using namespace rpl::mappers;
@@ -236,15 +252,16 @@ void DownloadManagerMtproto::requestSucceeded(
 	auto &dc = i->second;
 	Assert(index < dc.sessions.size());
 	auto &data = dc.sessions[index];
+	// A single request in the session is always sent, even if the part
+	// is larger than the max waited amount, it doesn't overload it.
 	const auto overloaded = (timeAtRequestStart <= dc.lastSessionRemove)
-		|| (amountAtRequestStart > data.maxWaitedAmount);
-	const auto parts = amountAtRequestStart / kDownloadPartSize;
+		|| (amountAtRequestStart > std::max(data.maxWaitedAmount, partSize));
 	const auto duration = (crl::now() - timeAtRequestStart);
-	DEBUG_LOG(("Download (%1,%2) request done, duration: %3, parts: %4%5"
+	DEBUG_LOG(("Download (%1,%2) request done, duration: %3, amount: %4%5"
 		).arg(dcId
 		).arg(index
 		).arg(duration
-		).arg(parts
+		).arg(amountAtRequestStart
 		).arg(overloaded ? " (overloaded)" : ""));
 	if (overloaded) {
 		return;
@@ -257,16 +274,12 @@ void DownloadManagerMtproto::requestSucceeded(
 		});
 		return;
 	}
-	if (amountAtRequestStart == data.maxWaitedAmount
-		&& data.maxWaitedAmount < kMaxWaitedInSession) {
-		data.maxWaitedAmount = std::min(
-			data.maxWaitedAmount + kDownloadPartSize,
-			kMaxWaitedInSession);
-		DEBUG_LOG(("Download (%1,%2) increased max waited amount %3."
-			).arg(dcId
-			).arg(index
-			).arg(data.maxWaitedAmount));
-	}
+	updateMaxWaitedAmount(
+		dcId,
+		index,
+		data,
+		amountAtRequestStart,
+		duration);
 	data.successes = std::min(data.successes + 1, kMaxTrackedSuccesses);
 	const auto notEnough = ranges::any_of(
 		dc.sessions,
@@ -296,6 +309,41 @@ void DownloadManagerMtproto::requestSucceeded(
 		).arg(dc.sessions.size()));
 }
 
+void DownloadManagerMtproto::updateMaxWaitedAmount(
+		MTP::DcId dcId,
+		int index,
+		DcSessionBalanceData &data,
+		int amountAtRequestStart,
+		crl::time duration) {
+	// All that was requested before this request is received in duration,
+	// while the shortest duration approximates the round trip time.
+	duration = std::max(duration, crl::time(1));
+	const auto sample = amountAtRequestStart * 1000. / duration;
+	data.bytesPerSecond = data.bytesPerSecond
+		? (data.bytesPerSecond * (1. - kBytesPerSecondSmoothing)
+			+ sample * kBytesPerSecondSmoothing)
+		: sample;
+	data.minDuration = data.minDuration
+		? std::min(data.minDuration, duration)
+		: duration;
+
+	const auto bandwidthDelay = data.bytesPerSecond * data.minDuration / 1000.;
+	const auto wanted = std::clamp(
+		int(bandwidthDelay * kWaitedBandwidthDelayMultiplier),
+		kMinWaitedInSession,
+		kMaxWaitedInSession);
+
+	// Don't grow more than twice for a single request.
+	const auto updated = std::min(wanted, data.maxWaitedAmount * 2);
+	if (updated != data.maxWaitedAmount) {
+		data.maxWaitedAmount = updated;
+		DEBUG_LOG(("Download (%1,%2) changed max waited amount %3."
+			).arg(dcId
+			).arg(index
+			).arg(data.maxWaitedAmount));
+	}
+}
+
 int DownloadManagerMtproto::chooseSessionIndex(MTP::DcId dcId) const {
 	const auto i = _balanceData.find(dcId);
 	Assert(i != end(_balanceData));
@@ -319,6 +367,7 @@ void DownloadManagerMtproto::sessionTimedOut(MTP::DcId dcId, int index) {
 	DEBUG_LOG(("Download (%1,%2) session timed-out.").arg(dcId).arg(index));
 	for (auto &session : dc.sessions) {
 		session.successes = 0;
+		session.minDuration = 0;
 	}
 	if (dc.sessions.size() == kStartSessionsCount
 		|| ++dc.timeouts < kRemoveSessionAfterTimeouts) {
@@ -452,6 +501,18 @@ const DownloadMtprotoTask::Location &DownloadMtprotoTask::location() const {
 	return _location;
 }
 
+int DownloadMtprotoTask::partSize() const {
+	return _partSize;
+}
+
+void DownloadMtprotoTask::setPartSize(int size) {
+	Expects(_sentRequests.empty());
+	Expects(size >= kDownloadPartSize && size <= kDownloadPartSizeMax);
+	Expects(!(size % kDownloadPartSize) && !(kDownloadPartSizeMax % size));
+
+	_partSize = size;
+}
+
 void DownloadMtprotoTask::refreshFileReferenceFrom(
 		const Data::UpdatedFileReferences &updates,
 		int requestId,
@@ -510,7 +571,7 @@ void DownloadMtprotoTask::removeSession(int sessionIndex) {
 mtpRequestId DownloadMtprotoTask::sendRequest(
 		const RequestData &requestData) {
 	const auto offset = requestData.offset;
-	const auto limit = Storage::kDownloadPartSize;
+	const auto limit = _partSize;
 	const auto shiftedDcId = MTP::downloadDcId(
 		_cdnDcId ? _cdnDcId : dcId(),
 		requestData.sessionIndex);
@@ -589,9 +650,10 @@ void DownloadMtprotoTask::requestMoreCdnFileHashes() {
 	const auto shiftedDcId = MTP::downloadDcId(
 		dcId(),
 		requestData.sessionIndex);
+	_cdnHashesRequestOffset = firstMissingCdnHashOffset(requestData.offset);
 	_cdnHashesRequestId = api().request(MTPupload_GetCdnFileHashes(
 		MTP_bytes(_cdnToken),
-		MTP_int(requestData.offset)
+		MTP_int(_cdnHashesRequestOffset)
 	)).done([=](const MTPVector<MTPFileHash> &result, mtpRequestId id) {
 		getCdnFileHashesDone(result, id);
 	}).fail([=](const MTP::Error &error, mtpRequestId id) {
@@ -706,18 +768,41 @@ void DownloadMtprotoTask::cdnPartLoaded(const MTPupload_CdnFile &result, mtpRequ
 DownloadMtprotoTask::CheckCdnHashResult DownloadMtprotoTask::checkCdnFileHash(
 		int offset,
 		bytes::const_span buffer) {
-	const auto cdnFileHashIt = _cdnFileHashes.find(offset);
-	if (cdnFileHashIt == _cdnFileHashes.cend()) {
-		return CheckCdnHashResult::NoHash;
-	}
-	const auto realHash = openssl::Sha256(buffer);
-	const auto receivedHash = bytes::make_span(cdnFileHashIt->second.hash);
-	if (bytes::compare(realHash, receivedHash)) {
-		return CheckCdnHashResult::Invalid;
-	}
+	// A part may span several hashed ranges, each of them is checked.
+	auto checked = 0;
+	do {
+		const auto cdnFileHashIt = _cdnFileHashes.find(offset + checked);
+		if (cdnFileHashIt == _cdnFileHashes.cend()) {
+			return CheckCdnHashResult::NoHash;
+		} else if (cdnFileHashIt->second.limit <= 0) {
+			return CheckCdnHashResult::Invalid;
+		}
+		const auto limit = std::min(
+			cdnFileHashIt->second.limit,
+			int(buffer.size()) - checked);
+		const auto realHash = openssl::Sha256(buffer.subspan(checked, limit));
+		const auto receivedHash = bytes::make_span(
+			cdnFileHashIt->second.hash);
+		if (bytes::compare(realHash, receivedHash)) {
+			return CheckCdnHashResult::Invalid;
+		}
+		checked += limit;
+	} while (checked < buffer.size());
 	return CheckCdnHashResult::Good;
 }
 
+int DownloadMtprotoTask::firstMissingCdnHashOffset(int offset) const {
+	const auto till = offset + _partSize;
+	for (auto checked = offset; checked < till;) {
+		const auto i = _cdnFileHashes.find(checked);
+		if (i == _cdnFileHashes.cend() || i->second.limit <= 0) {
+			return checked;
+		}
+		checked += i->second.limit;
+	}
+	return offset;
+}
+
 void DownloadMtprotoTask::reuploadDone(
 		const MTPVector<MTPFileHash> &result,
 		mtpRequestId requestId) {
@@ -733,7 +818,7 @@ void DownloadMtprotoTask::getCdnFileHashesDone(
 		mtpRequestId requestId) {
 	Expects(_cdnHashesRequestId == requestId);
 
-	const auto requestData = finishSentRequest(
+	[[maybe_unused]] const auto requestData = finishSentRequest(
 		requestId,
 		FinishRequestReason::Redirect);
 	addCdnHashes(result.v);
@@ -768,11 +853,12 @@ void DownloadMtprotoTask::getCdnFileHashesDone(
 		default: Unexpected("Result of checkCdnFileHash()");
 		}
 	}
-	if (!someMoreChecked) {
+	if (!someMoreChecked
+		&& !_cdnFileHashes.contains(_cdnHashesRequestOffset)) {
 		LOG(("API Error: "
 			"Could not find cdnFileHash for offset %1 "
 			"after getCdnFileHashes request."
-			).arg(requestData.offset));
+			).arg(_cdnHashesRequestOffset));
 		cancelOnFail();
 		return;
 	}
@@ -785,7 +871,7 @@ void DownloadMtprotoTask::placeSentRequest(
 	const auto amount = _owner->changeRequestedAmount(
 		dcId(),
 		requestData.sessionIndex,
-		Storage::kDownloadPartSize);
+		_partSize);
 	const auto [i, ok1] = _sentRequests.emplace(requestId, requestData);
 	const auto [j, ok2] = _requestByOffset.emplace(
 		requestData.offset,
@@ -811,7 +897,7 @@ auto DownloadMtprotoTask::finishSentRequest(
 	_owner->changeRequestedAmount(
 		dcId(),
 		result.sessionIndex,
-		-Storage::kDownloadPartSize);
+		-_partSize);
 	_sentRequests.erase(it);
 	const auto ok = _requestByOffset.remove(result.offset);
 
@@ -819,6 +905,7 @@ auto DownloadMtprotoTask::finishSentRequest(
 		_owner->requestSucceeded(
 			dcId(),
 			result.sessionIndex,
+			_partSize,
 			result.requestedInSession,
 			result.sent);
 	}
@@ -19,11 +19,12 @@ class Error;
 
 namespace Storage {
 
-// Different part sizes are not supported for now :(
-// Because we start downloading with some part size
-// and then we get a CDN-redirect where we support only
-// fixed part size download for hash checking.
+// CDN file hashes are received for ranges of this size, bigger parts
+// are checked range by range, so any multiple of it can be requested.
 constexpr auto kDownloadPartSize = 128 * 1024;
+constexpr auto kDownloadPartSizeMax = 1024 * 1024;
+
+[[nodiscard]] int ChooseDownloadPartSize(int size);
 
 class DownloadMtprotoTask;
 
@@ -52,6 +53,7 @@ public:
 	void requestSucceeded(
 		MTP::DcId dcId,
 		int index,
+		int partSize,
 		int amountAtRequestStart,
 		crl::time timeAtRequestStart);
 	void checkSendNextAfterSuccess(MTP::DcId dcId);
@@ -81,6 +83,10 @@ private:
 		int requested = 0;
 		int successes = 0; // Since last timeout in this dc in any session.
 		int maxWaitedAmount = 0;
+
+		// Bandwidth-delay product estimation for the maxWaitedAmount.
+		crl::time minDuration = 0;
+		float64 bytesPerSecond = 0.;
 	};
 	struct DcBalanceData {
 		DcBalanceData();
@@ -96,6 +102,12 @@ private:
 	void checkSendNext();
 	void checkSendNext(MTP::DcId dcId, Queue &queue);
 	bool trySendNextPart(MTP::DcId dcId, Queue &queue);
+	void updateMaxWaitedAmount(
+		MTP::DcId dcId,
+		int index,
+		DcSessionBalanceData &data,
+		int amountAtRequestStart,
+		crl::time duration);
 
 	void killSessionsSchedule(MTP::DcId dcId);
 	void killSessionsCancel(MTP::DcId dcId);
@@ -144,6 +156,7 @@ public:
 	[[nodiscard]] Data::FileOrigin fileOrigin() const;
 	[[nodiscard]] uint64 objectId() const;
 	[[nodiscard]] const Location &location() const;
+	[[nodiscard]] int partSize() const;
 
 	[[nodiscard]] virtual bool readyToRequest() const = 0;
 	void loadPart(int sessionIndex);
@@ -160,6 +173,9 @@ protected:
 	void cancelAllRequests();
 	void cancelRequestForOffset(int offset);
 
+	// Only before any request was sent.
+	void setPartSize(int size);
+
 	void addToQueue(int priority = 0);
 	void removeFromQueue();
 
@@ -251,6 +267,7 @@ private:
 	[[nodiscard]] CheckCdnHashResult checkCdnFileHash(
 		int offset,
 		bytes::const_span buffer);
+	[[nodiscard]] int firstMissingCdnHashOffset(int offset) const;
 
 	const not_null<DownloadManagerMtproto*> _owner;
 	const MTP::DcId _dcId = 0;
@@ -259,6 +276,8 @@ private:
 	Location _location;
 	const Data::FileOrigin _origin;
 
+	int _partSize = kDownloadPartSize;
+
 	base::flat_map<mtpRequestId, RequestData> _sentRequests;
 	base::flat_map<int, mtpRequestId> _requestByOffset;
 
@@ -269,6 +288,7 @@ private:
 	base::flat_map<int, CdnFileHash> _cdnFileHashes;
 	base::flat_map<RequestData, QByteArray> _cdnUncheckedParts;
 	mtpRequestId _cdnHashesRequestId = 0;
+	int _cdnHashesRequestOffset = 0;
 
 };
 
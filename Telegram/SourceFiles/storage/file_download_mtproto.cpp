@@ -39,6 +39,9 @@ mtpFileLoader::mtpFileLoader(
 	autoLoading,
 	cacheTag)
 , DownloadMtprotoTask(&session->downloader(), location, origin) {
+	if (loadSize == fullSize) {
+		setPartSize(Storage::ChooseDownloadPartSize(fullSize));
+	}
 }
 
 mtpFileLoader::mtpFileLoader(
@@ -114,7 +117,7 @@ int mtpFileLoader::takeNextRequestOffset() {
 	Expects(readyToRequest());
 
 	const auto result = _nextRequestOffset;
-	_nextRequestOffset += Storage::kDownloadPartSize;
+	_nextRequestOffset += partSize();
 	return result;
 }
 
@@ -164,8 +167,8 @@ void mtpFileLoader::startLoadingWithPartial(const QByteArray &data) {
 	Expects(data.startsWith("partial:"));
 
 	constexpr auto kPrefix = 8;
-	const auto parts = (data.size() - kPrefix) / Storage::kDownloadPartSize;
-	const auto use = parts * Storage::kDownloadPartSize;
+	const auto parts = (data.size() - kPrefix) / partSize();
+	const auto use = parts * partSize();
 	if (use > 0) {
 		_nextRequestOffset = use;
 		feedPart(0, QByteArray::fromRawData(data.data() + kPrefix, use));
@@ -12,6 +12,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "api/api_send_progress.h"
 #include "storage/localimageloader.h"
 #include "storage/file_download.h"
+#include "storage/file_upload_reader.h"
 #include "data/data_document.h"
 #include "data/data_document_media.h"
 #include "data/data_photo.h"
@@ -23,15 +24,18 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/mime_type.h"
 #include "main/main_session.h"
 #include "apiwrap.h"
+#include "base/random.h"
 
 namespace Storage {
 namespace {
 
-// max 512kb uploaded at the same time in each session
-constexpr auto kMaxUploadFileParallelSize = MTP::kUploadSessionsCount * 512 * 1024;
-
 constexpr auto kDocumentMaxPartsCount = 4000;
 
+// If the recorded file doesn't come to upload() in this time after the
+// last streamed part, for example its FileLoadTask failed or was dropped,
+// the streamed parts are forgotten so that the sessions could be stopped.
+constexpr auto kStreamedUploadTimeout = 5 * 60 * crl::time(1000);
+
 // 32kb for tiny document ( < 1mb )
 constexpr auto kDocumentUploadPartSize0 = 32 * 1024;
 
@@ -62,6 +66,16 @@ int UploadSessionsCount() {
 	return count;
 }
 
+// max 512kb uploaded at the same time in each session
+int UploadParallelSize() {
+	return UploadSessionsCount() * 512 * 1024;
+}
+
+// How many files share the upload sessions at the same time.
+int UploadParallelFiles() {
+	return UploadSessionsCount();
+}
+
 int UploadSessionsInterval() {
 	static const auto interval = 500 - (100 * ::Kotato::JsonSettings::GetInt("net_speed_boost"));
 	return interval;
@@ -86,9 +100,21 @@ struct Uploader::File {
 	uint64 thumbId() const;
 	const QString &filename() const;
 
+	UploadFileParts &parts();
+	uint64 partsOfId() const;
+	QByteArray &content();
+	bool hasPartsToSend();
+	bool readyToSend(Fn<void()> partReady);
+
+	int requestsInFlight = 0;
+	int docRequestsInFlight = 0;
+	int32 bytesInFlight = 0;
+	int64 bytesUploaded = 0;
+	crl::time started = 0;
+
 	HashMd5 md5Hash;
 
-	std::unique_ptr<QFile> docFile;
+	std::unique_ptr<UploadPartsReader> docReader;
 	int32 docSentParts = 0;
 	int32 docSize = 0;
 	int32 docPartSize = 0;
@@ -163,10 +189,51 @@ const QString &Uploader::File::filename() const {
 	return file ? file->filename : media.filename;
 }
 
+UploadFileParts &Uploader::File::parts() {
+	return file
+		? ((type() == SendMediaType::Photo
+			|| type() == SendMediaType::Secure)
+			? file->fileparts
+			: file->thumbparts)
+		: media.parts;
+}
+
+uint64 Uploader::File::partsOfId() const {
+	return file
+		? ((type() == SendMediaType::Photo
+			|| type() == SendMediaType::Secure)
+			? file->id
+			: file->thumbId)
+		: media.thumbId;
+}
+
+QByteArray &Uploader::File::content() {
+	return file ? file->content : media.data;
+}
+
+bool Uploader::File::hasPartsToSend() {
+	return !parts().isEmpty() || (docSentParts < docPartsCount);
+}
+
+bool Uploader::File::readyToSend(Fn<void()> partReady) {
+	if (!parts().isEmpty() || !content().isEmpty()) {
+		return true;
+	} else if (!docReader) {
+		docReader = std::make_unique<UploadPartsReader>(
+			file ? file->filepath : media.file,
+			docPartSize,
+			docPartsCount,
+			(docSize <= kUseBigFilesFrom),
+			std::move(partReady));
+	}
+	return docReader->hasPart() || docReader->failed();
+}
+
 Uploader::Uploader(not_null<ApiWrap*> api)
 : _api(api)
 , _nextTimer([=] { sendNext(); })
-, _stopSessionsTimer([=] { stopSessions(); }) {
+, _stopSessionsTimer([=] { stopSessions(); })
+, _staleStreamedTimer([=] { dropStaleStreamed(); }) {
 	const auto session = &_api->session();
 	photoReady(
 	) | rpl::start_with_next([=](UploadedMedia &&data) {
@@ -362,29 +429,143 @@ void Uploader::upload(
 			document->checkWallPaperProperties();
 		}
 	}
-	queue.emplace(msgId, File(file));
+	const auto i = queue.emplace(msgId, File(file)).first;
+	adoptStreamed(msgId, i->second);
 	sendNext();
 }
 
-void Uploader::currentFailed() {
-	auto j = queue.find(uploadingId);
-	if (j != queue.end()) {
-		const auto [msgId, file] = std::move(*j);
-		queue.erase(j);
-		notifyFailed(msgId, file);
+uint64 Uploader::startStreamed() {
+	const auto fileId = base::RandomValue<uint64>();
+	_streamed.emplace(fileId, Streamed{ .updated = crl::now() });
+	if (!_staleStreamedTimer.isActive()) {
+		_staleStreamedTimer.callOnce(kStreamedUploadTimeout);
 	}
+	return fileId;
+}
 
-	cancelRequests();
-	dcMap.clear();
-	uploadingId = FullMsgId();
-	sentSize = 0;
-	for (int i = 0; i < UploadSessionsCount(); ++i) {
-		sentSizes[i] = 0;
+void Uploader::appendStreamed(uint64 fileId, const QByteArray &part) {
+	Expects(part.size() == kStreamedUploadPartSize);
+
+	const auto i = _streamed.find(fileId);
+	if (i == end(_streamed) || i->second.failed) {
+		return;
 	}
+	auto &streamed = i->second;
+	streamed.md5Hash.feed(part.constData(), part.size());
+	streamed.updated = crl::now();
+
+	const auto todc = chooseDc();
+	const auto requestId = _api->request(MTPupload_SaveFilePart(
+		MTP_long(fileId),
+		MTP_int(streamed.partsSent),
+		MTP_bytes(part)
+	)).done([=](const MTPBool &result, mtpRequestId requestId) {
+		partLoaded(result, requestId);
+	}).fail([=](const MTP::Error &error, mtpRequestId requestId) {
+		partFailed(error, requestId);
+	}).toDC(MTP::uploadDcId(todc)).send();
+	++streamed.partsSent;
+
+	const auto size = int32(part.size());
+	_requests.emplace(requestId, Request{
+		.size = size,
+		.dc = todc,
+		.docPart = true,
+		.streamedId = fileId,
+	});
+	sentSize += size;
+	sentSizes[todc] += size;
+	_stopSessionsTimer.cancel();
+}
 
+void Uploader::cancelStreamed(uint64 fileId) {
+	const auto i = _streamed.find(fileId);
+	if (i == end(_streamed)) {
+		return;
+	}
+	_streamed.erase(i);
+	cancelStreamedRequests(fileId);
 	sendNext();
 }
 
+void Uploader::adoptStreamed(FullMsgId itemId, File &uploadingData) {
+	const auto fileId = uploadingData.id();
+	const auto i = _streamed.find(fileId);
+	if (i == end(_streamed)) {
+		return;
+	}
+	const auto streamed = i->second;
+	_streamed.erase(i);
+
+	const auto streamedSize = streamed.partsSent * kStreamedUploadPartSize;
+	if (streamed.failed
+		|| uploadingData.type() != SendMediaType::Audio
+		|| uploadingData.content().size() < streamedSize
+		|| uploadingData.docSize > kUseBigFilesFrom
+		|| !uploadingData.setPartSize(kStreamedUploadPartSize)) {
+		// Upload the whole file from the beginning in the usual way.
+		cancelStreamedRequests(fileId);
+		uploadingData.setDocSize(uploadingData.docSize);
+		return;
+	}
+	uploadingData.md5Hash = streamed.md5Hash;
+	uploadingData.docSentParts = streamed.partsSent;
+	uploadingData.started = crl::now();
+	for (auto &[requestId, request] : _requests) {
+		if (request.streamedId != fileId) {
+			continue;
+		}
+		request.streamedId = 0;
+		request.itemId = itemId;
+		++uploadingData.requestsInFlight;
+		++uploadingData.docRequestsInFlight;
+		uploadingData.bytesInFlight += request.size;
+	}
+	DEBUG_LOG(("Uploader: file %1 streamed %2 of %3 parts while recording."
+		).arg(fileId
+		).arg(streamed.partsSent
+		).arg(uploadingData.docPartsCount));
+}
+
+void Uploader::dropStaleStreamed() {
+	const auto now = crl::now();
+	auto next = crl::time(0);
+	auto dropped = false;
+	for (auto i = _streamed.begin(); i != _streamed.end();) {
+		const auto till = i->second.updated + kStreamedUploadTimeout;
+		if (till > now) {
+			next = next ? std::min(next, till) : till;
+			++i;
+			continue;
+		}
+		LOG(("Uploader: streamed file %1 wasn't sent, dropping."
+			).arg(i->first));
+		cancelStreamedRequests(i->first);
+		i = _streamed.erase(i);
+		dropped = true;
+	}
+	if (next) {
+		_staleStreamedTimer.callOnce(next - now);
+	}
+	if (dropped) {
+		sendNext();
+	}
+}
+
+FullMsgId Uploader::currentUploadId() const {
+	return queue.empty() ? FullMsgId() : queue.begin()->first;
+}
+
+void Uploader::failed(const FullMsgId &itemId) {
+	auto j = queue.find(itemId);
+	if (j != queue.end()) {
+		const auto [msgId, file] = std::move(*j);
+		queue.erase(j);
+		notifyFailed(msgId, file);
+	}
+	cancelRequests(itemId);
+}
+
 void Uploader::notifyFailed(FullMsgId id, const File &file) {
 	const auto type = file.type();
 	if (type == SendMediaType::Photo) {
@@ -400,7 +581,7 @@ void Uploader::notifyFailed(FullMsgId id, const File &file) {
 	} else if (type == SendMediaType::Secure) {
 		_secureFailed.fire_copy(id);
 	} else {
-		Unexpected("Type in Uploader::currentFailed.");
+		Unexpected("Type in Uploader::notifyFailed.");
 	}
 }
 
@@ -411,12 +592,35 @@ void Uploader::stopSessions() {
 }
 
 void Uploader::sendNext() {
-	if (sentSize >= (UploadSessionsCount() * 512 * 1024) || _pausedId.msg) {
+	if (sentSize >= UploadParallelSize() || _pausedId.msg) {
 		return;
 	}
 
+	// Parts of several files are sent in parallel, but the files are
+	// reported ready in the queue order, so the messages are sent in
+	// the same order. A finished file waits for all the previous ones.
+	while (!queue.empty()) {
+		const auto i = queue.begin();
+		auto &file = i->second;
+		if (file.requestsInFlight || file.hasPartsToSend()) {
+			break;
+		}
+		auto [itemId, finished] = std::move(*i);
+		queue.erase(i);
+		finish(itemId, finished);
+	}
+
 	const auto stopping = _stopSessionsTimer.isActive();
-	if (queue.empty()) {
+	if (queue.empty() && !_streamed.empty()) {
+		return;
+	} else if (queue.empty()) {
+		if (_activeSince) {
+			const auto duration = crl::now() - base::take(_activeSince);
+			DEBUG_LOG(("Uploader: %1 files, %2 bytes in %3 ms."
+				).arg(base::take(_filesUploaded)
+				).arg(base::take(_bytesUploaded)
+				).arg(duration));
+		}
 		if (!stopping) {
 			_stopSessionsTimer.callOnce(kKillSessionTimeout);
 		}
@@ -426,144 +630,69 @@ void Uploader::sendNext() {
 	if (stopping) {
 		_stopSessionsTimer.cancel();
 	}
-	auto i = uploadingId.msg ? queue.find(uploadingId) : queue.begin();
-	if (!uploadingId.msg) {
-		uploadingId = i->first;
-	} else if (i == queue.end()) {
-		i = queue.begin();
-		uploadingId = i->first;
+	if (!_activeSince) {
+		_activeSince = crl::now();
+	}
+	while (sentSize < UploadParallelSize()) {
+		const auto i = chooseNextFile();
+		if (i == queue.end()) {
+			break;
+		}
+		sendPart(i->first, i->second);
 	}
-	auto &uploadingData = i->second;
+	_nextTimer.callOnce(crl::time(UploadSessionsInterval()));
+}
 
-	auto todc = 0;
+std::map<FullMsgId, Uploader::File>::iterator Uploader::chooseNextFile() {
+	// Share the sessions between several first files in the queue,
+	// giving the next part to the one with the least bytes in flight.
+	auto result = queue.end();
+	auto left = UploadParallelFiles();
+	for (auto i = queue.begin(); i != queue.end() && left > 0; ++i) {
+		auto &file = i->second;
+		if (!file.hasPartsToSend()) {
+			continue;
+		}
+		--left;
+		if (!file.readyToSend([=] { sendNext(); })) {
+			continue;
+		} else if (result == queue.end()
+			|| file.bytesInFlight < result->second.bytesInFlight) {
+			result = i;
+		}
+	}
+	return result;
+}
+
+int Uploader::chooseDc() const {
+	auto result = 0;
 	for (auto dc = 1; dc != UploadSessionsCount(); ++dc) {
-		if (sentSizes[dc] < sentSizes[todc]) {
-			todc = dc;
-		}
-	}
-
-	auto &parts = uploadingData.file
-		? ((uploadingData.type() == SendMediaType::Photo
-			|| uploadingData.type() == SendMediaType::Secure)
-			? uploadingData.file->fileparts
-			: uploadingData.file->thumbparts)
-		: uploadingData.media.parts;
-	const auto partsOfId = uploadingData.file
-		? ((uploadingData.type() == SendMediaType::Photo
-			|| uploadingData.type() == SendMediaType::Secure)
-			? uploadingData.file->id
-			: uploadingData.file->thumbId)
-		: uploadingData.media.thumbId;
-	if (parts.isEmpty()) {
-		if (uploadingData.docSentParts >= uploadingData.docPartsCount) {
-			if (requestsSent.empty() && docRequestsSent.empty()) {
-				const auto options = uploadingData.file
-					? uploadingData.file->to.options
-					: Api::SendOptions();
-				const auto edit = uploadingData.file &&
-					uploadingData.file->to.replaceMediaOf;
-				const auto attachedStickers = uploadingData.file
-					? uploadingData.file->attachedStickers
-					: std::vector<MTPInputDocument>();
-				if (uploadingData.type() == SendMediaType::Photo) {
-					auto photoFilename = uploadingData.filename();
-					if (!photoFilename.endsWith(qstr(".jpg"), Qt::CaseInsensitive)) {
-						// Server has some extensions checking for inputMediaUploadedPhoto,
-						// so force the extension to be .jpg anyway. It doesn't matter,
-						// because the filename from inputFile is not used anywhere.
-						photoFilename += qstr(".jpg");
-					}
-					const auto md5 = uploadingData.file
-						? uploadingData.file->filemd5
-						: uploadingData.media.jpeg_md5;
-					const auto file = MTP_inputFile(
-						MTP_long(uploadingData.id()),
-						MTP_int(uploadingData.partsCount),
-						MTP_string(photoFilename),
-						MTP_bytes(md5));
-					_photoReady.fire({
-						.fullId = uploadingId,
-						.info = {
-							.file = file,
-							.attachedStickers = attachedStickers,
-						},
-						.options = options,
-						.edit = edit,
-					});
-				} else if (uploadingData.type() == SendMediaType::File
-					|| uploadingData.type() == SendMediaType::ThemeFile
-					|| uploadingData.type() == SendMediaType::Audio) {
-					QByteArray docMd5(32, Qt::Uninitialized);
-					hashMd5Hex(uploadingData.md5Hash.result(), docMd5.data());
-
-					const auto file = (uploadingData.docSize > kUseBigFilesFrom)
-						? MTP_inputFileBig(
-							MTP_long(uploadingData.id()),
-							MTP_int(uploadingData.docPartsCount),
-							MTP_string(uploadingData.filename()))
-						: MTP_inputFile(
-							MTP_long(uploadingData.id()),
-							MTP_int(uploadingData.docPartsCount),
-							MTP_string(uploadingData.filename()),
-							MTP_bytes(docMd5));
-					const auto thumb = [&]() -> std::optional<MTPInputFile> {
-						if (!uploadingData.partsCount) {
-							return std::nullopt;
-						}
-						const auto thumbFilename = uploadingData.file
-							? uploadingData.file->thumbname
-							: (qsl("thumb.") + uploadingData.media.thumbExt);
-						const auto thumbMd5 = uploadingData.file
-							? uploadingData.file->thumbmd5
-							: uploadingData.media.jpeg_md5;
-						return MTP_inputFile(
-							MTP_long(uploadingData.thumbId()),
-							MTP_int(uploadingData.partsCount),
-							MTP_string(thumbFilename),
-							MTP_bytes(thumbMd5));
-					}();
-					_documentReady.fire({
-						.fullId = uploadingId,
-						.info = {
-							.file = file,
-							.thumb = thumb,
-							.attachedStickers = attachedStickers,
-						},
-						.options = options,
-						.edit = edit,
-					});
-				} else if (uploadingData.type() == SendMediaType::Secure) {
-					_secureReady.fire({
-						uploadingId,
-						uploadingData.id(),
-						uploadingData.partsCount });
-				}
-				queue.erase(uploadingId);
-				uploadingId = FullMsgId();
-				sendNext();
-			}
-			return;
+		if (sentSizes[dc] < sentSizes[result]) {
+			result = dc;
 		}
+	}
+	return result;
+}
+
+void Uploader::sendPart(FullMsgId itemId, File &uploadingData) {
+	const auto todc = chooseDc();
+	if (!uploadingData.started) {
+		uploadingData.started = crl::now();
+	}
 
-		auto &content = uploadingData.file
-			? uploadingData.file->content
-			: uploadingData.media.data;
+	auto &parts = uploadingData.parts();
+	auto request = Request{ .itemId = itemId, .dc = todc };
+	auto requestId = mtpRequestId();
+	if (parts.isEmpty()) {
+		auto &content = uploadingData.content();
 		QByteArray toSend;
 		if (content.isEmpty()) {
-			if (!uploadingData.docFile) {
-				const auto filepath = uploadingData.file
-					? uploadingData.file->filepath
-					: uploadingData.media.file;
-				uploadingData.docFile = std::make_unique<QFile>(filepath);
-				if (!uploadingData.docFile->open(QIODevice::ReadOnly)) {
-					currentFailed();
-					return;
-				}
-			}
-			toSend = uploadingData.docFile->read(uploadingData.docPartSize);
-			if (uploadingData.docSize <= kUseBigFilesFrom) {
-				uploadingData.md5Hash.feed(toSend.constData(), toSend.size());
+			Assert(uploadingData.docReader != nullptr);
+			if (uploadingData.docReader->failed()) {
+				failed(itemId);
+				return;
 			}
+			toSend = uploadingData.docReader->takePart();
 		} else {
 			const auto offset = uploadingData.docSentParts
 				* uploadingData.docPartSize;
@@ -578,10 +707,9 @@ void Uploader::sendNext() {
 		if ((toSend.size() > uploadingData.docPartSize)
 			|| ((toSend.size() < uploadingData.docPartSize
 				&& uploadingData.docSentParts + 1 != uploadingData.docPartsCount))) {
-			currentFailed();
+			failed(itemId);
 			return;
 		}
-		mtpRequestId requestId;
 		if (uploadingData.docSize > kUseBigFilesFrom) {
 			requestId = _api->request(MTPupload_SaveBigFilePart(
 				MTP_long(uploadingData.id()),
@@ -604,17 +732,15 @@ void Uploader::sendNext() {
 				partFailed(error, requestId);
 			}).toDC(MTP::uploadDcId(todc)).send();
 		}
-		docRequestsSent.emplace(requestId, uploadingData.docSentParts);
-		dcMap.emplace(requestId, todc);
-		sentSize += uploadingData.docPartSize;
-		sentSizes[todc] += uploadingData.docPartSize;
-
+		request.size = uploadingData.docPartSize;
+		request.docPart = true;
+		++uploadingData.docRequestsInFlight;
 		uploadingData.docSentParts++;
 	} else {
 		auto part = parts.begin();
 
-		const auto requestId = _api->request(MTPupload_SaveFilePart(
-			MTP_long(partsOfId),
+		requestId = _api->request(MTPupload_SaveFilePart(
+			MTP_long(uploadingData.partsOfId()),
 			MTP_int(part.key()),
 			MTP_bytes(part.value())
 		)).done([=](const MTPBool &result, mtpRequestId requestId) {
@@ -622,33 +748,130 @@ void Uploader::sendNext() {
 		}).fail([=](const MTP::Error &error, mtpRequestId requestId) {
 			partFailed(error, requestId);
 		}).toDC(MTP::uploadDcId(todc)).send();
-		requestsSent.emplace(requestId, part.value());
-		dcMap.emplace(requestId, todc);
-		sentSize += part.value().size();
-		sentSizes[todc] += part.value().size();
+		request.size = part.value().size();
 
 		parts.erase(part);
 	}
-	_nextTimer.callOnce(crl::time(UploadSessionsInterval()));
+	_requests.emplace(requestId, request);
+	++uploadingData.requestsInFlight;
+	uploadingData.bytesInFlight += request.size;
+	sentSize += request.size;
+	sentSizes[todc] += request.size;
+}
+
+void Uploader::finish(FullMsgId itemId, File &uploadingData) {
+	const auto duration = crl::now() - uploadingData.started;
+	DEBUG_LOG(("Uploader: file %1 done, %2 bytes in %3 ms."
+		).arg(uploadingData.id()
+		).arg(uploadingData.bytesUploaded
+		).arg(duration));
+	++_filesUploaded;
+
+	const auto options = uploadingData.file
+		? uploadingData.file->to.options
+		: Api::SendOptions();
+	const auto edit = uploadingData.file &&
+		uploadingData.file->to.replaceMediaOf;
+	const auto attachedStickers = uploadingData.file
+		? uploadingData.file->attachedStickers
+		: std::vector<MTPInputDocument>();
+	if (uploadingData.type() == SendMediaType::Photo) {
+		auto photoFilename = uploadingData.filename();
+		if (!photoFilename.endsWith(qstr(".jpg"), Qt::CaseInsensitive)) {
+			// Server has some extensions checking for inputMediaUploadedPhoto,
+			// so force the extension to be .jpg anyway. It doesn't matter,
+			// because the filename from inputFile is not used anywhere.
+			photoFilename += qstr(".jpg");
+		}
+		const auto md5 = uploadingData.file
+			? uploadingData.file->filemd5
+			: uploadingData.media.jpeg_md5;
+		const auto file = MTP_inputFile(
+			MTP_long(uploadingData.id()),
+			MTP_int(uploadingData.partsCount),
+			MTP_string(photoFilename),
+			MTP_bytes(md5));
+		_photoReady.fire({
+			.fullId = itemId,
+			.info = {
+				.file = file,
+				.attachedStickers = attachedStickers,
+			},
+			.options = options,
+			.edit = edit,
+		});
+	} else if (uploadingData.type() == SendMediaType::File
+		|| uploadingData.type() == SendMediaType::ThemeFile
+		|| uploadingData.type() == SendMediaType::Audio) {
+		auto docMd5 = QByteArray();
+		if (uploadingData.docReader) {
+			docMd5 = uploadingData.docReader->md5();
+		} else {
+			docMd5 = QByteArray(32, Qt::Uninitialized);
+			hashMd5Hex(uploadingData.md5Hash.result(), docMd5.data());
+		}
+
+		const auto file = (uploadingData.docSize > kUseBigFilesFrom)
+			? MTP_inputFileBig(
+				MTP_long(uploadingData.id()),
+				MTP_int(uploadingData.docPartsCount),
+				MTP_string(uploadingData.filename()))
+			: MTP_inputFile(
+				MTP_long(uploadingData.id()),
+				MTP_int(uploadingData.docPartsCount),
+				MTP_string(uploadingData.filename()),
+				MTP_bytes(docMd5));
+		const auto thumb = [&]() -> std::optional<MTPInputFile> {
+			if (!uploadingData.partsCount) {
+				return std::nullopt;
+			}
+			const auto thumbFilename = uploadingData.file
+				? uploadingData.file->thumbname
+				: (qsl("thumb.") + uploadingData.media.thumbExt);
+			const auto thumbMd5 = uploadingData.file
+				? uploadingData.file->thumbmd5
+				: uploadingData.media.jpeg_md5;
+			return MTP_inputFile(
+				MTP_long(uploadingData.thumbId()),
+				MTP_int(uploadingData.partsCount),
+				MTP_string(thumbFilename),
+				MTP_bytes(thumbMd5));
+		}();
+		_documentReady.fire({
+			.fullId = itemId,
+			.info = {
+				.file = file,
+				.thumb = thumb,
+				.attachedStickers = attachedStickers,
+			},
+			.options = options,
+			.edit = edit,
+		});
+	} else if (uploadingData.type() == SendMediaType::Secure) {
+		_secureReady.fire({
+			itemId,
+			uploadingData.id(),
+			uploadingData.partsCount });
+	}
 }
 
 void Uploader::cancel(const FullMsgId &msgId) {
-	if (uploadingId == msgId) {
-		currentFailed();
+	const auto i = queue.find(msgId);
+	if (i == queue.end()) {
+		return;
+	} else if (i->second.started) {
+		failed(msgId);
 	} else {
-		queue.erase(msgId);
+		queue.erase(i);
 	}
+	sendNext();
 }
 
 void Uploader::cancelAll() {
-	const auto single = queue.empty() ? uploadingId : queue.begin()->first;
-	if (!single) {
+	if (queue.empty()) {
 		return;
 	}
-	_pausedId = single;
-	if (uploadingId) {
-		currentFailed();
-	}
+	_pausedId = queue.begin()->first;
 	while (!queue.empty()) {
 		const auto [msgId, file] = std::move(*queue.begin());
 		queue.erase(queue.begin());
@@ -670,99 +893,136 @@ void Uploader::unpause() {
 void Uploader::confirm(const FullMsgId &msgId) {
 }
 
+void Uploader::cancelRequests(const FullMsgId &itemId) {
+	for (auto i = _requests.begin(); i != _requests.end();) {
+		const auto &request = i->second;
+		if (request.itemId != itemId) {
+			++i;
+			continue;
+		}
+		_api->request(i->first).cancel();
+		sentSize -= request.size;
+		sentSizes[request.dc] -= request.size;
+		i = _requests.erase(i);
+	}
+}
+
+void Uploader::cancelStreamedRequests(uint64 fileId) {
+	for (auto i = _requests.begin(); i != _requests.end();) {
+		const auto &request = i->second;
+		if (request.streamedId != fileId) {
+			++i;
+			continue;
+		}
+		_api->request(i->first).cancel();
+		sentSize -= request.size;
+		sentSizes[request.dc] -= request.size;
+		i = _requests.erase(i);
+	}
+}
+
 void Uploader::cancelRequests() {
-	for (const auto &requestData : requestsSent) {
+	for (const auto &requestData : _requests) {
 		_api->request(requestData.first).cancel();
 	}
-	requestsSent.clear();
-	for (const auto &requestData : docRequestsSent) {
-		_api->request(requestData.first).cancel();
+	_requests.clear();
+	sentSize = 0;
+	for (int i = 0; i < UploadSessionsCount(); ++i) {
+		sentSizes[i] = 0;
 	}
-	docRequestsSent.clear();
 }
 
 void Uploader::clear() {
 	queue.clear();
+	_streamed.clear();
+	_staleStreamedTimer.cancel();
 	cancelRequests();
-	dcMap.clear();
-	sentSize = 0;
 	for (int i = 0; i < UploadSessionsCount(); ++i) {
 		_api->instance().stopSession(MTP::uploadDcId(i));
-		sentSizes[i] = 0;
 	}
 	_stopSessionsTimer.cancel();
 }
 
 void Uploader::partLoaded(const MTPBool &result, mtpRequestId requestId) {
-	auto j = docRequestsSent.end();
-	auto i = requestsSent.find(requestId);
-	if (i == requestsSent.cend()) {
-		j = docRequestsSent.find(requestId);
-	}
-	if (i != requestsSent.cend() || j != docRequestsSent.cend()) {
-		if (mtpIsFalse(result)) { // failed to upload current file
-			currentFailed();
-			return;
-		} else {
-			auto dcIt = dcMap.find(requestId);
-			if (dcIt == dcMap.cend()) { // must not happen
-				currentFailed();
-				return;
-			}
-			auto dc = dcIt->second;
-			dcMap.erase(dcIt);
-
-			int32 sentPartSize = 0;
-			auto k = queue.find(uploadingId);
-			Assert(k != queue.cend());
-			auto &[fullId, file] = *k;
-			if (i != requestsSent.cend()) {
-				sentPartSize = i->second.size();
-				requestsSent.erase(i);
-			} else {
-				sentPartSize = file.docPartSize;
-				docRequestsSent.erase(j);
-			}
-			sentSize -= sentPartSize;
-			sentSizes[dc] -= sentPartSize;
-			if (file.type() == SendMediaType::Photo) {
-				file.fileSentSize += sentPartSize;
-				const auto photo = session().data().photo(file.id());
-				if (photo->uploading() && file.file) {
-					photo->uploadingData->size = file.file->partssize;
-					photo->uploadingData->offset = file.fileSentSize;
-				}
-				_photoProgress.fire_copy(fullId);
-			} else if (file.type() == SendMediaType::File
-				|| file.type() == SendMediaType::ThemeFile
-				|| file.type() == SendMediaType::Audio) {
-				const auto document = session().data().document(file.id());
-				if (document->uploading()) {
-					const auto doneParts = file.docSentParts
-						- int(docRequestsSent.size());
-					document->uploadingData->offset = std::min(
-						document->uploadingData->size,
-						doneParts * file.docPartSize);
-				}
-				_documentProgress.fire_copy(fullId);
-			} else if (file.type() == SendMediaType::Secure) {
-				file.fileSentSize += sentPartSize;
-				_secureProgress.fire_copy({
-					fullId,
-					file.fileSentSize,
-					file.file->partssize });
-			}
+	const auto i = _requests.find(requestId);
+	if (i == _requests.end()) {
+		sendNext();
+		return;
+	}
+	const auto request = i->second;
+	_requests.erase(i);
+	sentSize -= request.size;
+	sentSizes[request.dc] -= request.size;
+
+	if (request.streamedId) {
+		const auto j = _streamed.find(request.streamedId);
+		if (j != end(_streamed) && mtpIsFalse(result)) {
+			j->second.failed = true;
 		}
+		sendNext();
+		return;
+	}
+
+	auto k = queue.find(request.itemId);
+	Assert(k != queue.cend());
+	auto &[fullId, file] = *k;
+	--file.requestsInFlight;
+	file.bytesInFlight -= request.size;
+	if (request.docPart) {
+		--file.docRequestsInFlight;
+	}
+	if (mtpIsFalse(result)) { // failed to upload this file
+		failed(request.itemId);
+		sendNext();
+		return;
+	}
+	file.bytesUploaded += request.size;
+	_bytesUploaded += request.size;
+
+	if (file.type() == SendMediaType::Photo) {
+		file.fileSentSize += request.size;
+		const auto photo = session().data().photo(file.id());
+		if (photo->uploading() && file.file) {
+			photo->uploadingData->size = file.file->partssize;
+			photo->uploadingData->offset = file.fileSentSize;
+		}
+		_photoProgress.fire_copy(fullId);
+	} else if (file.type() == SendMediaType::File
+		|| file.type() == SendMediaType::ThemeFile
+		|| file.type() == SendMediaType::Audio) {
+		const auto document = session().data().document(file.id());
+		if (document->uploading()) {
+			const auto doneParts = file.docSentParts
+				- file.docRequestsInFlight;
+			document->uploadingData->offset = std::min(
+				document->uploadingData->size,
+				doneParts * file.docPartSize);
+		}
+		_documentProgress.fire_copy(fullId);
+	} else if (file.type() == SendMediaType::Secure) {
+		file.fileSentSize += request.size;
+		_secureProgress.fire_copy({
+			fullId,
+			file.fileSentSize,
+			file.file->partssize });
 	}
 
 	sendNext();
 }
 
 void Uploader::partFailed(const MTP::Error &error, mtpRequestId requestId) {
-	// failed to upload current file
-	if ((requestsSent.find(requestId) != requestsSent.cend())
-		|| (docRequestsSent.find(requestId) != docRequestsSent.cend())) {
-		currentFailed();
+	// failed to upload this file
+	const auto i = _requests.find(requestId);
+	if (i == _requests.end()) {
+	} else if (const auto fileId = i->second.streamedId) {
+		// The file will be uploaded from the beginning when sent.
+		const auto j = _streamed.find(fileId);
+		if (j != end(_streamed)) {
+			j->second.failed = true;
+		}
+		cancelStreamedRequests(fileId);
+	} else {
+		failed(i->second.itemId);
 	}
 	sendNext();
 }
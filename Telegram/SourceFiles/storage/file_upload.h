@@ -28,6 +28,9 @@ namespace Storage {
 // MTP big files methods used for files greater than 10mb.
 constexpr auto kUseBigFilesFrom = 10 * 1024 * 1024;
 
+// Part size of the files uploaded while they're still being written.
+constexpr auto kStreamedUploadPartSize = 32 * 1024;
+
 struct UploadedMedia {
 	FullMsgId fullId;
 	Api::RemoteFileInfo info;
@@ -54,15 +57,20 @@ public:
 
 	[[nodiscard]] Main::Session &session() const;
 
-	[[nodiscard]] FullMsgId currentUploadId() const {
-		return uploadingId;
-	}
+	[[nodiscard]] FullMsgId currentUploadId() const;
 
 	void uploadMedia(const FullMsgId &msgId, const SendMediaReady &image);
 	void upload(
 		const FullMsgId &msgId,
 		const std::shared_ptr<FileLoadResult> &file);
 
+	// Voice messages are uploaded by parts while being recorded.
+	// The file id of a streamed upload should be used in the
+	// FileLoadResult passed to upload(), then only the tail is sent.
+	[[nodiscard]] uint64 startStreamed();
+	void appendStreamed(uint64 fileId, const QByteArray &part);
+	void cancelStreamed(uint64 fileId);
+
 	void cancel(const FullMsgId &msgId);
 	void pause(const FullMsgId &msgId);
 	void confirm(const FullMsgId &msgId);
@@ -104,6 +112,26 @@ public:
 
 private:
 	struct File;
+	struct Streamed {
+		HashMd5 md5Hash;
+		int32 partsSent = 0;
+		crl::time updated = 0;
+		bool failed = false;
+	};
+	struct Request {
+		FullMsgId itemId;
+		int32 size = 0;
+		int dc = 0;
+		bool docPart = false;
+		uint64 streamedId = 0;
+	};
+
+	[[nodiscard]] std::map<FullMsgId, File>::iterator chooseNextFile();
+	[[nodiscard]] int chooseDc() const;
+	void sendPart(FullMsgId itemId, File &uploadingData);
+	void finish(FullMsgId itemId, File &uploadingData);
+	void adoptStreamed(FullMsgId itemId, File &uploadingData);
+	void dropStaleStreamed();
 
 	void partLoaded(const MTPBool &result, mtpRequestId requestId);
 	void partFailed(const MTP::Error &error, mtpRequestId requestId);
@@ -114,7 +142,9 @@ private:
 	void processDocumentFailed(const FullMsgId &msgId);
 
 	void notifyFailed(FullMsgId id, const File &file);
-	void currentFailed();
+	void failed(const FullMsgId &itemId);
+	void cancelRequests(const FullMsgId &itemId);
+	void cancelStreamedRequests(uint64 fileId);
 	void cancelRequests();
 
 	void sendProgressUpdate(
@@ -123,16 +153,19 @@ private:
 		int progress = 0);
 
 	const not_null<ApiWrap*> _api;
-	base::flat_map<mtpRequestId, QByteArray> requestsSent;
-	base::flat_map<mtpRequestId, int32> docRequestsSent;
-	base::flat_map<mtpRequestId, int32> dcMap;
+	base::flat_map<mtpRequestId, Request> _requests;
 	uint32 sentSize = 0;
 	uint32 sentSizes[MTP::kUploadSessionsCountMax] = { 0 };
 
-	FullMsgId uploadingId;
 	FullMsgId _pausedId;
 	std::map<FullMsgId, File> queue;
-	base::Timer _nextTimer, _stopSessionsTimer;
+	base::flat_map<uint64, Streamed> _streamed;
+	base::Timer _nextTimer, _stopSessionsTimer, _staleStreamedTimer;
+
+	// Throughput counters, logged when the queue becomes empty.
+	crl::time _activeSince = 0;
+	int64 _bytesUploaded = 0;
+	int _filesUploaded = 0;
 
 	rpl::event_stream<UploadedMedia> _photoReady;
 	rpl::event_stream<UploadedMedia> _documentReady;
@@ -0,0 +1,164 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "storage/file_upload_reader.h"
+
+#include "core/utils.h"
+
+#include <QtCore/QFile>
+
+namespace Storage {
+namespace {
+
+// How many parts are read ahead of the ones already sent.
+constexpr auto kReadAheadParts = 4;
+
+} // namespace
+
+class UploadPartsReader::Worker final {
+public:
+	Worker(
+		crl::weak_on_queue<Worker> weak,
+		base::weak_ptr<UploadPartsReader> owner,
+		const QString &path,
+		int partSize,
+		int partsCount,
+		bool computeMd5);
+
+	void readMore(int count);
+
+private:
+	void fail();
+
+	const crl::weak_on_queue<Worker> _weak;
+	const base::weak_ptr<UploadPartsReader> _owner;
+	QFile _file;
+	const int _partSize = 0;
+	const int _partsCount = 0;
+	const bool _computeMd5 = false;
+	HashMd5 _md5;
+	int _partsRead = 0;
+	bool _failed = false;
+
+};
+
+UploadPartsReader::Worker::Worker(
+	crl::weak_on_queue<Worker> weak,
+	base::weak_ptr<UploadPartsReader> owner,
+	const QString &path,
+	int partSize,
+	int partsCount,
+	bool computeMd5)
+: _weak(std::move(weak))
+, _owner(std::move(owner))
+, _file(path)
+, _partSize(partSize)
+, _partsCount(partsCount)
+, _computeMd5(computeMd5) {
+	if (!_file.open(QIODevice::ReadOnly)) {
+		fail();
+	} else {
+		readMore(kReadAheadParts);
+	}
+}
+
+void UploadPartsReader::Worker::readMore(int count) {
+	while (!_failed && count-- > 0 && _partsRead < _partsCount) {
+		auto part = _file.read(_partSize);
+		const auto last = (++_partsRead == _partsCount);
+		if ((part.size() > _partSize)
+			|| (part.size() < _partSize && !last)) {
+			fail();
+			return;
+		}
+		if (_computeMd5) {
+			_md5.feed(part.constData(), part.size());
+		}
+		auto md5 = QByteArray();
+		if (last) {
+			_file.close();
+			if (_computeMd5) {
+				md5 = QByteArray(32, Qt::Uninitialized);
+				hashMd5Hex(_md5.result(), md5.data());
+			}
+		}
+		crl::on_main(_owner, [
+			owner = _owner,
+			part = std::move(part),
+			md5 = std::move(md5)
+		]() mutable {
+			if (const auto strong = owner.get()) {
+				strong->partRead(std::move(part), std::move(md5));
+			}
+		});
+	}
+}
+
+void UploadPartsReader::Worker::fail() {
+	_failed = true;
+	_file.close();
+	crl::on_main(_owner, [owner = _owner] {
+		if (const auto strong = owner.get()) {
+			strong->readFailed();
+		}
+	});
+}
+
+UploadPartsReader::UploadPartsReader(
+	const QString &path,
+	int partSize,
+	int partsCount,
+	bool computeMd5,
+	Fn<void()> partReady)
+: _partReady(std::move(partReady))
+, _worker(
+	base::make_weak(this),
+	path,
+	partSize,
+	partsCount,
+	computeMd5) {
+}
+
+UploadPartsReader::~UploadPartsReader() = default;
+
+bool UploadPartsReader::hasPart() const {
+	return !_parts.empty();
+}
+
+bool UploadPartsReader::failed() const {
+	return _failed;
+}
+
+QByteArray UploadPartsReader::takePart() {
+	Expects(!_parts.empty());
+
+	auto result = std::move(_parts.front());
+	_parts.pop_front();
+	_worker.with([](Worker &worker) {
+		worker.readMore(1);
+	});
+	return result;
+}
+
+QByteArray UploadPartsReader::md5() const {
+	return _md5;
+}
+
+void UploadPartsReader::partRead(QByteArray &&part, QByteArray &&md5) {
+	_parts.push_back(std::move(part));
+	if (!md5.isEmpty()) {
+		_md5 = std::move(md5);
+	}
+	_partReady();
+}
+
+void UploadPartsReader::readFailed() {
+	_failed = true;
+	_partReady();
+}
+
+} // namespace Storage
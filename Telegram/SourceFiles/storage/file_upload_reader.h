@@ -0,0 +1,51 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "base/weak_ptr.h"
+
+#include <crl/crl_object_on_queue.h>
+
+namespace Storage {
+
+// Reads the parts of a file being uploaded on a background queue and
+// computes its MD5 there, keeping only a few parts in memory at once.
+class UploadPartsReader final : public base::has_weak_ptr {
+public:
+	UploadPartsReader(
+		const QString &path,
+		int partSize,
+		int partsCount,
+		bool computeMd5,
+		Fn<void()> partReady);
+	~UploadPartsReader();
+
+	[[nodiscard]] bool hasPart() const;
+	[[nodiscard]] bool failed() const;
+	[[nodiscard]] QByteArray takePart();
+
+	// Hex MD5 of the whole file, available after the last part was read.
+	[[nodiscard]] QByteArray md5() const;
+
+private:
+	class Worker;
+	friend class Worker;
+
+	void partRead(QByteArray &&part, QByteArray &&md5);
+	void readFailed();
+
+	const Fn<void()> _partReady;
+	std::deque<QByteArray> _parts;
+	QByteArray _md5;
+	bool _failed = false;
+
+	crl::object_on_queue<Worker> _worker;
+
+};
+
+} // namespace Storage
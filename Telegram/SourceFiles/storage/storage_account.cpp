@@ -40,6 +40,12 @@ using namespace details;
 using Database = Cache::Database;
 
 constexpr auto kDelayedWriteTimeout = crl::time(1000);
+constexpr auto kLocationsJournalMinRecords = 256;
+constexpr auto kLocationsJournalRecordsPerLocation = 8;
+
+constexpr auto kMessagesCacheTotalSizeLimit = int64(64 * 1024 * 1024);
+constexpr auto kMessagesCacheTotalTimeLimit = int32(30 * 24 * 60 * 60);
+constexpr auto kMessagesCacheMaxDataSize = 1024 * 1024;
 
 constexpr auto kStickersVersionTag = quint32(-1);
 constexpr auto kStickersSerializeVersion = 2;
@@ -598,6 +604,8 @@ void Account::reset() {
 	_fileLocations.clear();
 	_fileLocationPairs.clear();
 	_fileLocationAliases.clear();
+	_locationsChangedKeys.clear();
+	_locationsJournalRecords = 0;
 	_cacheTotalSizeLimit = Database::Settings().totalSizeLimit;
 	_cacheTotalTimeLimit = Database::Settings().totalTimeLimit;
 	_cacheBigFileTotalSizeLimit = Database::Settings().totalSizeLimit;
@@ -628,6 +636,7 @@ void Account::writeLocations() {
 		return;
 	}
 	_locationsChanged = false;
+	auto changed = base::take(_locationsChangedKeys);
 
 	if (_fileLocations.isEmpty()) {
 		if (_locationsKey) {
@@ -635,6 +644,13 @@ void Account::writeLocations() {
 			_locationsKey = 0;
 			writeMapDelayed();
 		}
+	} else if (_locationsKey
+		&& _locationsJournalGeneration
+		&& !changed.empty()
+		&& _locationsJournalRecords < std::max(
+			kLocationsJournalMinRecords,
+			int(_fileLocations.size()) / kLocationsJournalRecordsPerLocation)) {
+		writeLocationsJournal(changed);
 	} else {
 		if (!_locationsKey) {
 			_locationsKey = GenerateKey(_basePath);
@@ -665,6 +681,9 @@ void Account::writeLocations() {
 			size += sizeof(quint64) * 2 + sizeof(quint64) * 2;
 		}
 
+		// web locations count + journal generation
+		size += sizeof(quint32) + sizeof(quint64);
+
 		EncryptedDescriptor data(size);
 		auto legacyTypeField = 0;
 		for (auto i = _fileLocations.cbegin(); i != _fileLocations.cend(); ++i) {
@@ -686,20 +705,75 @@ void Account::writeLocations() {
 			data.stream << quint64(i.key().first) << quint64(i.key().second) << quint64(i.value().first) << quint64(i.value().second);
 		}
 
+		if (!_locationsJournalGeneration) {
+			_locationsJournalGeneration = ReadJournalGeneration(
+				_locationsKey,
+				_basePath);
+		}
+		data.stream << quint32(0) << quint64(++_locationsJournalGeneration);
+		_locationsJournalRecords = 0;
+
 		FileWriteDescriptor file(_locationsKey, _basePath);
 		file.writeEncrypted(data, _localKey);
+		file.resetJournal(_locationsJournalGeneration);
+	}
+}
+
+void Account::writeLocationsJournal(
+		const base::flat_set<MediaKey> &changed) {
+	// For each changed key: all its locations and its alias.
+	auto size = quint32(sizeof(quint32));
+	for (const auto &key : changed) {
+		size += sizeof(quint64) * 2 + sizeof(quint32);
+		for (auto i = _fileLocations.constFind(key); (i != _fileLocations.cend()) && (i.key() == key); ++i) {
+			size += Serialize::stringSize(i.value().name())
+				+ Serialize::bytearraySize(i.value().bookmark())
+				+ Serialize::dateTimeSize()
+				+ sizeof(quint32);
+		}
+		size += sizeof(quint32) + sizeof(quint64) * 2;
+	}
+	EncryptedDescriptor data(size);
+	data.stream << quint32(changed.size());
+	for (const auto &key : changed) {
+		data.stream
+			<< quint64(key.first)
+			<< quint64(key.second)
+			<< quint32(_fileLocations.count(key));
+		for (auto i = _fileLocations.constFind(key); (i != _fileLocations.cend()) && (i.key() == key); ++i) {
+			data.stream
+				<< i.value().name()
+				<< i.value().bookmark()
+				<< i.value().modified
+				<< quint32(i.value().size);
+		}
+		const auto alias = _fileLocationAliases.constFind(key);
+		const auto hasAlias = (alias != _fileLocationAliases.cend());
+		data.stream
+			<< quint32(hasAlias ? 1 : 0)
+			<< quint64(hasAlias ? alias.value().first : 0)
+			<< quint64(hasAlias ? alias.value().second : 0);
 	}
+	AppendToJournal(
+		_locationsKey,
+		_basePath,
+		_locationsJournalGeneration,
+		data,
+		_localKey);
+	++_locationsJournalRecords;
 }
 
-void Account::writeLocationsQueued() {
+void Account::writeLocationsQueued(MediaKey changed) {
 	_locationsChanged = true;
+	_locationsChangedKeys.emplace(changed);
 	crl::on_main(_owner, [=] {
 		writeLocations();
 	});
 }
 
-void Account::writeLocationsDelayed() {
+void Account::writeLocationsDelayed(MediaKey changed) {
 	_locationsChanged = true;
+	_locationsChangedKeys.emplace(changed);
 	_writeLocationsTimer.callOnce(kDelayedWriteTimeout);
 }
 
@@ -733,9 +807,6 @@ void Account::readLocations() {
 		MediaKey key(first, second);
 
 		_fileLocations.insert(key, loc);
-		if (!loc.inMediaCache()) {
-			_fileLocationPairs.insert(loc.fname, { key, loc });
-		}
 	}
 
 	if (endMarkFound) {
@@ -758,6 +829,49 @@ void Account::readLocations() {
 				ClearKey(key, _basePath);
 			}
 		}
+
+		if (!locations.stream.atEnd()) {
+			locations.stream >> _locationsJournalGeneration;
+			_locationsJournalRecords = ReadJournal(
+				_locationsKey,
+				_basePath,
+				_locationsJournalGeneration,
+				_localKey,
+				[=](QDataStream &stream) { readLocationsJournal(stream); });
+		}
+	}
+
+	for (auto i = _fileLocations.cbegin(); i != _fileLocations.cend(); ++i) {
+		if (!i.value().inMediaCache()) {
+			_fileLocationPairs.insert(i.value().fname, { i.key(), i.value() });
+		}
+	}
+}
+
+void Account::readLocationsJournal(QDataStream &stream) {
+	quint32 count = 0;
+	stream >> count;
+	for (quint32 i = 0; i != count && !stream.atEnd(); ++i) {
+		quint64 first = 0, second = 0;
+		quint32 locationsCount = 0;
+		stream >> first >> second >> locationsCount;
+		const auto key = MediaKey(first, second);
+		_fileLocations.remove(key);
+		for (quint32 j = 0; j != locationsCount; ++j) {
+			QByteArray bookmark;
+			Core::FileLocation loc;
+			stream >> loc.fname >> bookmark >> loc.modified >> loc.size;
+			loc.setBookmark(bookmark);
+			_fileLocations.insert(key, loc);
+		}
+		quint32 hasAlias = 0;
+		quint64 aliasFirst = 0, aliasSecond = 0;
+		stream >> hasAlias >> aliasFirst >> aliasSecond;
+		if (hasAlias) {
+			_fileLocationAliases.insert(key, MediaKey(aliasFirst, aliasSecond));
+		} else {
+			_fileLocationAliases.remove(key);
+		}
 	}
 }
 
@@ -1447,7 +1561,7 @@ void Account::writeFileLocation(MediaKey location, const Core::FileLocation &loc
 			if (i.value().second == local) {
 				if (i.value().first != location) {
 					_fileLocationAliases.insert(location, i.value().first);
-					writeLocationsQueued();
+					writeLocationsQueued(location);
 				}
 				return;
 			}
@@ -1455,6 +1569,7 @@ void Account::writeFileLocation(MediaKey location, const Core::FileLocation &loc
 				for (auto j = _fileLocations.find(i.value().first), e = _fileLocations.end(); (j != e) && (j.key() == i.value().first); ++j) {
 					if (j.value() == i.value().second) {
 						_fileLocations.erase(j);
+						_locationsChangedKeys.emplace(i.value().first);
 						break;
 					}
 				}
@@ -1471,7 +1586,7 @@ void Account::writeFileLocation(MediaKey location, const Core::FileLocation &loc
 		}
 	}
 	_fileLocations.insert(location, local);
-	writeLocationsQueued();
+	writeLocationsQueued(location);
 }
 
 void Account::removeFileLocation(MediaKey location) {
@@ -1482,7 +1597,7 @@ void Account::removeFileLocation(MediaKey location) {
 	while (i != _fileLocations.end() && (i.key() == location)) {
 		i = _fileLocations.erase(i);
 	}
-	writeLocationsQueued();
+	writeLocationsQueued(location);
 }
 
 Core::FileLocation Account::readFileLocation(MediaKey location) {
@@ -1495,7 +1610,7 @@ Core::FileLocation Account::readFileLocation(MediaKey location) {
 		if (!i.value().inMediaCache() && !i.value().check()) {
 			_fileLocationPairs.remove(i.value().fname);
 			i = _fileLocations.erase(i);
-			writeLocationsDelayed();
+			writeLocationsDelayed(location);
 			continue;
 		}
 		return i.value();
@@ -1564,6 +1679,25 @@ Cache::Database::Settings Account::cacheBigFileSettings() const {
 	return result;
 }
 
+EncryptionKey Account::messagesCacheKey() const {
+	return cacheKey();
+}
+
+QString Account::messagesCachePath() const {
+	Expects(!_databasePath.isEmpty());
+
+	return _databasePath + "messages_cache";
+}
+
+Cache::Database::Settings Account::messagesCacheSettings() const {
+	auto result = Cache::Database::Settings();
+	result.clearOnWrongKey = true;
+	result.totalSizeLimit = kMessagesCacheTotalSizeLimit;
+	result.totalTimeLimit = kMessagesCacheTotalTimeLimit;
+	result.maxDataSize = kMessagesCacheMaxDataSize;
+	return result;
+}
+
 void Account::writeStickerSet(
 		QDataStream &stream,
 		const Data::StickersSet &set) {
@@ -2499,6 +2633,7 @@ void Account::writeExportSettings(const Export::Settings &settings) {
 		&& settings.path == check.path
 		&& settings.format == check.format
 		&& settings.availableAt == check.availableAt
+		&& settings.incremental == check.incremental
 		&& !settings.onlySinglePeer()) {
 		if (_exportSettingsKey) {
 			ClearKey(_exportSettingsKey, _basePath);
@@ -2513,7 +2648,7 @@ void Account::writeExportSettings(const Export::Settings &settings) {
 	}
 	quint32 size = sizeof(quint32) * 6
 		+ Serialize::stringSize(settings.path)
-		+ sizeof(qint32) * 2 + sizeof(quint64);
+		+ sizeof(qint32) * 3 + sizeof(quint64);
 	EncryptedDescriptor data(size);
 	data.stream
 		<< quint32(settings.types)
@@ -2546,6 +2681,7 @@ void Account::writeExportSettings(const Export::Settings &settings) {
 	});
 	data.stream << qint32(settings.singlePeerFrom);
 	data.stream << qint32(settings.singlePeerTill);
+	data.stream << qint32(settings.incremental ? 1 : 0);
 
 	FileWriteDescriptor file(_exportSettingsKey, _basePath);
 	file.writeEncrypted(data, _localKey);
@@ -2568,6 +2704,7 @@ Export::Settings Account::readExportSettings() {
 	quint64 singlePeerBareId = 0;
 	quint64 singlePeerAccessHash = 0;
 	qint32 singlePeerFrom = 0, singlePeerTill = 0;
+	qint32 incremental = 0;
 	file.stream
 		>> types
 		>> fullChats
@@ -2598,6 +2735,9 @@ Export::Settings Account::readExportSettings() {
 	if (!file.stream.atEnd()) {
 		file.stream >> singlePeerFrom >> singlePeerTill;
 	}
+	if (!file.stream.atEnd()) {
+		file.stream >> incremental;
+	}
 	auto result = Export::Settings();
 	result.types = Export::Settings::Types::from_raw(types);
 	result.fullChats = Export::Settings::Types::from_raw(fullChats);
@@ -2638,6 +2778,7 @@ Export::Settings Account::readExportSettings() {
 	}();
 	result.singlePeerFrom = singlePeerFrom;
 	result.singlePeerTill = singlePeerTill;
+	result.incremental = (incremental == 1);
 	return (file.stream.status() == QDataStream::Ok && result.validate())
 		? result
 		: Export::Settings();
@@ -112,6 +112,10 @@ public:
 	[[nodiscard]] QString cacheBigFilePath() const;
 	[[nodiscard]] Cache::Database::Settings cacheBigFileSettings() const;
 
+	[[nodiscard]] EncryptionKey messagesCacheKey() const;
+	[[nodiscard]] QString messagesCachePath() const;
+	[[nodiscard]] Cache::Database::Settings messagesCacheSettings() const;
+
 	void writeInstalledStickers();
 	void writeFeaturedStickers();
 	void writeRecentStickers();
@@ -191,9 +195,11 @@ private:
 	void writeMap();
 
 	void readLocations();
+	void readLocationsJournal(QDataStream &stream);
 	void writeLocations();
-	void writeLocationsQueued();
-	void writeLocationsDelayed();
+	void writeLocationsJournal(const base::flat_set<MediaKey> &changed);
+	void writeLocationsQueued(MediaKey changed);
+	void writeLocationsDelayed(MediaKey changed);
 
 	std::unique_ptr<Main::SessionSettings> readSessionSettings();
 	void writeSessionSettings(Main::SessionSettings *stored);
@@ -255,6 +261,9 @@ private:
 	QMultiMap<MediaKey, Core::FileLocation> _fileLocations;
 	QMap<QString, QPair<MediaKey, Core::FileLocation>> _fileLocationPairs;
 	QMap<MediaKey, MediaKey> _fileLocationAliases;
+	base::flat_set<MediaKey> _locationsChangedKeys;
+	quint64 _locationsJournalGeneration = 0;
+	int _locationsJournalRecords = 0;
 
 	FileKey _locationsKey = 0;
 	FileKey _trustedBotsKey = 0;
@@ -14,7 +14,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/ui_utility.h"
 
 ImageRoundRadius KotatoImageRoundRadius() {
-	switch (::Kotato::JsonSettings::GetInt("userpic_corner_type")) {
+	switch (::Kotato::JsonSettings::GetInt(::Kotato::JsonSettings::Key::UserpicCornerType)) {
 		case 0: return ImageRoundRadius::None;
 		case 1: return ImageRoundRadius::Small;
 		case 2: return ImageRoundRadius::Large;
@@ -23,7 +23,7 @@ ImageRoundRadius KotatoImageRoundRadius() {
 }
 
 Images::Option KotatoImageRoundOption() {
-	switch (::Kotato::JsonSettings::GetInt("userpic_corner_type")) {
+	switch (::Kotato::JsonSettings::GetInt(::Kotato::JsonSettings::Key::UserpicCornerType)) {
 		case 0: return Images::Option::None;
 		case 1: return Images::Option::RoundSmall;
 		case 2: return Images::Option::RoundLarge;
@@ -58,8 +58,35 @@ namespace {
 	return SinglePixKey(OptionsByArgs(args));
 }
 
+struct PixmapCache {
+	std::unordered_set<const Image*> images;
+	uint64 usageCounter = 0;
+	bool trimScheduled = false;
+	PixmapCacheStats stats;
+};
+
+[[nodiscard]] PixmapCache &Cache() {
+	// Not destroyed, so that static Image instances can use it on exit.
+	static const auto result = new PixmapCache();
+	return *result;
+}
+
+[[nodiscard]] int64 PixmapBytes(const QPixmap &pixmap) {
+	return int64(pixmap.width()) * pixmap.height() * 4;
+}
+
+[[nodiscard]] int64 PixmapCacheLimit() {
+	constexpr auto kMegabyte = int64(1024 * 1024);
+	return ::Kotato::JsonSettings::GetInt(
+		::Kotato::JsonSettings::Key::PixmapCacheSize) * kMegabyte;
+}
+
 } // namespace
 
+PixmapCacheStats GetPixmapCacheStats() {
+	return Cache().stats;
+}
+
 QByteArray ExpandInlineBytes(const QByteArray &bytes) {
 	if (bytes.size() < 3 || bytes[0] != '\x01') {
 		return QByteArray();
@@ -329,6 +356,17 @@ Image::Image(QImage &&data)
 	Expects(!_data.isNull());
 }
 
+Image::~Image() {
+	if (_cache.empty()) {
+		return;
+	}
+	auto &cache = Cache();
+	for (const auto &[key, entry] : _cache) {
+		cache.stats.bytes -= PixmapBytes(entry.pixmap);
+	}
+	cache.images.erase(this);
+}
+
 not_null<Image*> Image::Empty() {
 	static auto result = Image([] {
 		const auto factor = cIntRetinaFactor();
@@ -379,10 +417,71 @@ const QPixmap &Image::cached(
 	const auto outer = args.outer;
 	const auto size = outer.isEmpty() ? QSize(w, h) : outer * ratio;
 	const auto k = single ? SinglePixKey(args) : PixKey(w, h, args);
+	auto &cache = Cache();
 	const auto i = _cache.find(k);
-	return (i != _cache.cend() && i->second.size() == size)
-		? i->second
-		: _cache.emplace_or_assign(k, prepare(w, h, args)).first->second;
+	if (i != _cache.cend() && i->second.pixmap.size() == size) {
+		++cache.stats.hits;
+		i->second.usedAt = ++cache.usageCounter;
+		return i->second.pixmap;
+	}
+	++cache.stats.misses;
+	if (i != _cache.cend()) {
+		cache.stats.bytes -= PixmapBytes(i->second.pixmap);
+	} else if (_cache.empty()) {
+		cache.images.emplace(this);
+	}
+	auto &entry = _cache[k];
+	entry.pixmap = prepare(w, h, args);
+	entry.usedAt = ++cache.usageCounter;
+	cache.stats.bytes += PixmapBytes(entry.pixmap);
+	if (!cache.trimScheduled && cache.stats.bytes > PixmapCacheLimit()) {
+		// Pixmaps returned by reference must live till the end of paint.
+		cache.trimScheduled = true;
+		crl::on_main([] { TrimCache(); });
+	}
+	return entry.pixmap;
+}
+
+void Image::TrimCache() {
+	auto &cache = Cache();
+	cache.trimScheduled = false;
+	const auto limit = PixmapCacheLimit();
+	if (cache.stats.bytes <= limit) {
+		return;
+	}
+	struct Usage {
+		uint64 usedAt = 0;
+		not_null<const Image*> image;
+		uint64 key = 0;
+	};
+	auto usages = std::vector<Usage>();
+	for (const auto image : cache.images) {
+		for (const auto &[key, entry] : image->_cache) {
+			usages.push_back({ entry.usedAt, image, key });
+		}
+	}
+	ranges::sort(usages, ranges::less(), &Usage::usedAt);
+
+	// Free some more, so that the next trim doesn't come right away.
+	const auto target = limit * 3 / 4;
+	const auto was = cache.stats.evictedBytes;
+	for (const auto &usage : usages) {
+		if (cache.stats.bytes <= target) {
+			break;
+		}
+		auto &map = usage.image->_cache;
+		const auto i = map.find(usage.key);
+		const auto bytes = PixmapBytes(i->second.pixmap);
+		cache.stats.bytes -= bytes;
+		cache.stats.evictedBytes += bytes;
+		map.erase(i);
+		if (map.empty()) {
+			cache.images.erase(usage.image);
+		}
+	}
+	DEBUG_LOG(("Image Info: Pixmap cache trimmed by %1 bytes, %2 left."
+		).arg(cache.stats.evictedBytes - was
+		).arg(cache.stats.bytes));
 }
 
 QPixmap Image::prepare(int w, int h, const Images::PrepareArgs &args) const {
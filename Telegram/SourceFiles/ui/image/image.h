@@ -20,6 +20,16 @@ namespace Images {
 [[nodiscard]] QImage FromInlineBytes(const QByteArray &bytes);
 [[nodiscard]] QPainterPath PathFromInlineBytes(const QByteArray &bytes);
 
+struct PixmapCacheStats {
+	int64 bytes = 0;
+	int64 hits = 0;
+	int64 misses = 0;
+	int64 evictedBytes = 0;
+};
+
+// Scaled pixmaps of all the Image instances share one byte budget.
+[[nodiscard]] PixmapCacheStats GetPixmapCacheStats();
+
 } // namespace Images
 
 class Image final {
@@ -27,6 +37,9 @@ public:
 	explicit Image(const QString &path);
 	explicit Image(const QByteArray &content);
 	explicit Image(QImage &&data);
+	Image(const Image &other) = delete;
+	Image &operator=(const Image &other) = delete;
+	~Image();
 
 	[[nodiscard]] static not_null<Image*> Empty(); // 1x1 transparent
 	[[nodiscard]] static not_null<Image*> BlankMedia(); // 1x1 black
@@ -99,6 +112,13 @@ public:
 	}
 
 private:
+	struct CachedPixmap {
+		QPixmap pixmap;
+		uint64 usedAt = 0;
+	};
+
+	static void TrimCache();
+
 	[[nodiscard]] QPixmap prepare(
 		int w,
 		int h,
@@ -110,6 +130,6 @@ private:
 		bool single) const;
 
 	const QImage _data;
-	mutable base::flat_map<uint64, QPixmap> _cache;
+	mutable base::flat_map<uint64, CachedPixmap> _cache;
 
 };
@@ -264,7 +264,7 @@ void Generator::addAudioBubble(QVector<int> waveform, int waveactive, QString wa
 	const auto &st = st::msgFileLayout;
 	auto tleft = st.padding.left() + st.thumbSize + st.padding.right();
 	accumulate_max(width, tleft + st::normalFont->width(wavestatus) + skipBlock.width() + st::msgPadding.right());
-	if (!::Kotato::JsonSettings::GetBool("adaptive_bubbles")) {
+	if (!::Kotato::JsonSettings::GetBool(::Kotato::JsonSettings::Key::AdaptiveBubbles)) {
 		accumulate_min(width, st::msgMaxWidth);
 	}
 
@@ -299,7 +299,7 @@ void Generator::addTextBubble(QString text, QString date, Status status) {
 
 	auto width = _history.width() - st::msgMargin.left() - st::msgMargin.right();
 	accumulate_min(width, st::msgPadding.left() + bubble.text.maxWidth() + st::msgPadding.right());
-	if (!::Kotato::JsonSettings::GetBool("adaptive_bubbles")) {
+	if (!::Kotato::JsonSettings::GetBool(::Kotato::JsonSettings::Key::AdaptiveBubbles)) {
 		accumulate_min(width, st::msgMaxWidth);
 	}
 
@@ -330,7 +330,7 @@ void Generator::addPhotoBubble(QString image, QString caption, QString date, Sta
 
 	auto width = _history.width() - st::msgMargin.left() - st::msgMargin.right();
 	accumulate_min(width, bubble.photoWidth);
-	if (!::Kotato::JsonSettings::GetBool("adaptive_bubbles")) {
+	if (!::Kotato::JsonSettings::GetBool(::Kotato::JsonSettings::Key::AdaptiveBubbles)) {
 		accumulate_min(width, st::msgMaxWidth);
 	}
 
@@ -842,7 +842,7 @@ void Filler::fillArchiveActions() {
 		return;
 	}
 	const auto controller = _controller;
-	if (::Kotato::JsonSettings::GetInt("chat_list_lines") != 1) {
+	if (::Kotato::JsonSettings::GetInt(::Kotato::JsonSettings::Key::ChatListLines) != 1) {
 		const auto hidden = controller->session().settings().archiveCollapsed();
 		const auto text = hidden
 			? tr::lng_context_archive_expand(tr::now)
@@ -1000,7 +1000,7 @@ void SessionController::floatPlayerAreaUpdated() {
 }
 
 int SessionController::dialogsSmallColumnWidth() const {
-	return st::dialogsPadding.x() + (::Kotato::JsonSettings::GetInt("chat_list_lines") == 1 ? st::dialogsUnreadHeight : st::dialogsPhotoSize) + st::dialogsPadding.x();
+	return st::dialogsPadding.x() + (::Kotato::JsonSettings::GetInt(::Kotato::JsonSettings::Key::ChatListLines) == 1 ? st::dialogsUnreadHeight : st::dialogsPhotoSize) + st::dialogsPadding.x();
 }
 
 int SessionController::minimalThreeColumnWidth() const {